@@ -1,14 +1,23 @@
+#include <vector>
+#include <new>
 
 #include "nx.h"
 #include "common/llist.h"
+#include "common/SlabPool.h"
 #include "ObjManager.h"
+#include "hitgrid.h"
+#include "profiler.h"
 #include "ObjManager.fdh"
 
-static Object ZERO_OBJECT;
-static Player ZERO_PLAYER;
+// the lists, their indexes and the pools all belong to the World
+#define objectpool		(world->fObjectPool)
+#define playerpool		(world->fPlayerPool)
+#define next_serial		(world->fNextSerial)
 
-Object *firstobject = NULL, *lastobject = NULL;
-Object *lowestobject = NULL, *highestobject = NULL;
+#define firsttype		(world->fFirstOfType)
+#define lasttype		(world->fLastOfType)
+#define firstid2		(world->fFirstWithID2)
+#define lastid2			(world->fLastWithID2)
 
 /*
 void c------------------------------() {}
@@ -19,20 +28,21 @@ Object *CreateObject(int x, int y, int type, int xinertia, int yinertia,
 {
 Object *o;
 
-	// create the structure
+	// create the structure. the pool hands it out already zero-filled,
+	// so all members start cleared.
 	if (type != OBJ_PLAYER)
-	{
 		o = new Object;
-		*o = ZERO_OBJECT;	// safely clears all members
-	}
 	else
-	{
-		Player *p = new Player;
-		*p = ZERO_PLAYER;
-		o = (Object *)p;
-	}
+		o = (Object *)new Player;
 	
 	// initialize
+	o->serial = next_serial++;
+	if (!next_serial) next_serial = 1;
+	
+	// type and id2 both start out as 0; SetType moves it to the right list
+	LL_ADD_END(o, prevtype, nexttype, firsttype[0], lasttype[0]);
+	LL_ADD_END(o, previd2, nextid2, firstid2[0], lastid2[0]);
+	
 	o->SetType(type);
 	o->flags = objprop[type].defaultflags;
 	o->DamageText = new FloatText(SPR_REDNUMBERS);
@@ -64,6 +74,27 @@ Object *CreateObject(int x, int y, int type)
 	return CreateObject(x, y, type, 0, 0, RIGHT, NULL, CF_DEFAULT);
 }
 
+// objects and the player are recycled through slab pools instead of the heap;
+// weapons and bosses can create and destroy hundreds of them a second.
+void *Object::operator new(size_t size)
+{
+	SlabPool *pool = (size <= sizeof(Object)) ? &objectpool : &playerpool;
+	ASSERT(size <= (size_t)pool->ItemSize());
+	
+	void *mem = pool->Alloc();
+	ASSERT(mem);
+	
+	return mem;
+}
+
+void Object::operator delete(void *ptr, size_t size)
+{
+	if (size <= sizeof(Object))
+		objectpool.Release(ptr);
+	else
+		playerpool.Release(ptr);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -157,15 +188,25 @@ void Objects::RunAI(void)
 {
 Object *o;
 
+	PROFILE_SCOPE("RunAI");
+	
 	// because we handle objects in order of their creation and have a separate list
 	// for display order, we can't ever run AI twice in a frame because of z-order
 	// rearrangement, and 2) objects created by other objects are added to the end of
 	// the list and given a chance to run their AI routine before being displayed.
+	HitGrid::BeginAI();
+	
 	FOREACH_OBJECT(o)
 	{
 		if (!o->deleted)
+		{
+			int type = o->type;
 			o->RunAI();
+			HitGrid::AfterAI(o, type);
+		}
 	}
+	
+	HitGrid::EndAI();
 }
 
 
@@ -175,6 +216,8 @@ void Objects::PhysicsSim(void)
 Object *o;
 int xinertia, yinertia;
 
+	PROFILE_SCOPE("PhysicsSim");
+	
 	FOREACH_OBJECT(o)
 	{
 		if (o != player && !o->deleted)		// player is moved in PDoPhysics
@@ -224,11 +267,8 @@ int Objects::CountType(int objtype)
 	int count = 0;
 	Object *o;
 	
-	FOREACH_OBJECT(o)
-	{
-		if (o->type == objtype)
-			count++;
-	}
+	FOREACH_OBJECT_OF_TYPE(o, objtype)
+		count++;
 	
 	return count;
 }
@@ -236,14 +276,188 @@ int Objects::CountType(int objtype)
 // returns the first object of type objtype or NULL
 Object *Objects::FindByType(int objtype)
 {
-	Object *o;
+	return firsttype[objtype];
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// every live object is also kept in a list of all objects of it's type and
+// a list of all objects with it's id2, so that lookups by either of them
+// don't have to scan every object. both lists are in creation order, same
+// as the main list, so anything iterating them sees objects in the same
+// order as FOREACH_OBJECT would.
+
+// links O into one of the index lists at the right place by serial. a new
+// object goes on the end, but one which changes type or id2 later in life
+// may have to go in ahead of newer objects already there.
+#define INDEX_INSERT(O, PREV, NEXT, FIRST, LAST)	\
+{	\
+	Object *after = LAST;	\
+	while(after && after->serial > O->serial)	\
+		after = after->PREV;	\
+	\
+	if (after)	\
+	{	\
+		LL_INSERT_AFTER(O, after, PREV, NEXT, FIRST, LAST);	\
+	}	\
+	else if (FIRST)	\
+	{	\
+		Object *before = FIRST;	\
+		LL_INSERT_BEFORE(O, before, PREV, NEXT, FIRST, LAST);	\
+	}	\
+	else	\
+	{	\
+		LL_ADD_END(O, PREV, NEXT, FIRST, LAST);	\
+	}	\
+}
+
+Object *Objects::FirstOfType(int type)
+{
+	return firsttype[type];
+}
+
+Object *Objects::FirstWithID2(int id2)
+{
+	return firstid2[id2];
+}
+
+// changes an object's type, moving it to the list for the new type.
+// objects which aren't part of the game world (such as those on the
+// pause screens) were never assigned a serial and aren't indexed.
+void Objects::SetIndexedType(Object *o, int type)
+{
+	if (o->serial && o->type != type)
+	{
+		LL_REMOVE(o, prevtype, nexttype, firsttype[o->type], lasttype[o->type]);
+		o->type = type;
+		INDEX_INSERT(o, prevtype, nexttype, firsttype[type], lasttype[type]);
+	}
+	else
+	{
+		o->type = type;
+	}
+}
+
+void Objects::SetIndexedID2(Object *o, int id2)
+{
+	if (o->serial && o->id2 != id2)
+	{
+		LL_REMOVE(o, previd2, nextid2, firstid2[o->id2], lastid2[o->id2]);
+		o->id2 = id2;
+		INDEX_INSERT(o, previd2, nextid2, firstid2[o->id2], lastid2[o->id2]);
+	}
+	else
+	{
+		o->id2 = id2;
+	}
+}
+
+// takes an object out of the index lists, before it is destroyed
+void Objects::Unindex(Object *o)
+{
+	if (o->serial)
+	{
+		LL_REMOVE(o, prevtype, nexttype, firsttype[o->type], lasttype[o->type]);
+		LL_REMOVE(o, previd2, nextid2, firstid2[o->id2], lastid2[o->id2]);
+	}
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// saves the members of every object along with the address it lives at.
+// see savestate.h.
+void Objects::SaveState(DBuffer *out)
+{
+Object *o;
+int count = 0;
+
+	FOREACH_OBJECT(o)
+		count++;
+	
+	SS_PUT(out, count);
+	FOREACH_OBJECT(o)
+	{
+		bool isplayer = (o == player);
+		
+		SS_PUT(out, o);
+		SS_PUT(out, isplayer);
+		SS_PUTDATA(out, static_cast<ObjectState *>(o), sizeof(ObjectState));
+		
+		if (isplayer)
+			SS_PUTDATA(out, static_cast<PlayerState *>(player), sizeof(PlayerState));
+	}
+	
+	SS_PUT(out, firstobject);
+	SS_PUT(out, lastobject);
+	SS_PUT(out, lowestobject);
+	SS_PUT(out, highestobject);
+	SS_PUT(out, next_serial);
+}
+
+// replaces all objects with the ones from a save state, putting them back at
+// their old addresses. whatever objects exist now simply cease to be; their
+// destructors aren't run, as they'd unlink things that are being overwritten.
+// an instance of the right class is constructed at each address first, which
+// gives it a good vtable even if the slot had been freed, and the saved
+// members are then copied over it.
+void Objects::LoadState(const uint8_t **in)
+{
+std::vector<void *> objects, players;
+Object *o;
+int count, i;
+
+	// empty the index lists. only the heads belonging to live objects can
+	// be set, which saves clearing all of the (rather large) id2 table.
+	FOREACH_OBJECT(o)
+	{
+		firsttype[o->type] = lasttype[o->type] = NULL;
+		firstid2[o->id2] = lastid2[o->id2] = NULL;
+	}
+	
+	SS_GET(in, count);
+	for(i=0;i<count;i++)
+	{
+		bool isplayer;
+		SS_GET(in, o);
+		SS_GET(in, isplayer);
+		
+		if (isplayer)
+		{
+			Player *p = ::new((void *)o) Player;
+			SS_GETDATA(in, static_cast<ObjectState *>(p), sizeof(ObjectState));
+			SS_GETDATA(in, static_cast<PlayerState *>(p), sizeof(PlayerState));
+			players.push_back(p);
+		}
+		else
+		{
+			::new((void *)o) Object;
+			SS_GETDATA(in, static_cast<ObjectState *>(o), sizeof(ObjectState));
+			objects.push_back(o);
+		}
+	}
+	
+	objectpool.SetLive(objects.empty() ? NULL : &objects[0], objects.size());
+	playerpool.SetLive(players.empty() ? NULL : &players[0], players.size());
+	
+	SS_GET(in, firstobject);
+	SS_GET(in, lastobject);
+	SS_GET(in, lowestobject);
+	SS_GET(in, highestobject);
+	SS_GET(in, next_serial);
+	
+	// the index lists are rebuilt rather than saved; the main list is
+	// already in serial order, so appending gives the same result.
 	FOREACH_OBJECT(o)
 	{
-		if (o->type == objtype)
-			return o;
+		LL_ADD_END(o, prevtype, nexttype, firsttype[o->type], lasttype[o->type]);
+		LL_ADD_END(o, previd2, nextid2, firstid2[o->id2], lastid2[o->id2]);
 	}
 	
-	return NULL;
+	HitGrid::Invalidate();
 }
 
 /*
@@ -16,11 +16,22 @@ namespace Objects
 	void DestroyAll(bool delete_player);
 	
 	Object *FindByType(int type);
+	
+	Object *FirstOfType(int type);
+	Object *FirstWithID2(int id2);
+	void SetIndexedType(Object *o, int type);
+	void SetIndexedID2(Object *o, int id2);
+	void Unindex(Object *o);
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 };
 
 // synonyms
 #define CountObjectsOfType		Objects::CountType
 #define FOREACH_OBJECT(O)		for(O=firstobject; O; O=O->next)
+#define FOREACH_OBJECT_OF_TYPE(O, T)	for(O=Objects::FirstOfType(T); O; O=O->nexttype)
+#define FOREACH_OBJECT_WITH_ID2(O, I)	for(O=Objects::FirstWithID2(I); O; O=O->nextid2)
 
 // max expected objects to exist at once (for buffer allocation)
 #define MAX_OBJECTS				1024
@@ -36,6 +47,8 @@ Object *CreateObject(int x, int y, int type);
 Object *CreateObject(int x, int y, int type, int xinertia, int yinertia, \
 					int dir=0, Object *linkedobject=NULL, uint32_t createflags=CF_DEFAULT);
 
+bool hitdetect(Object *o1, Object *o2);
+
 
 // ObjProp definitions
 struct ObjProp
@@ -76,7 +89,5 @@ struct ObjProp
 
 
 extern ObjProp objprop[OBJ_LAST];
-extern Object *firstobject, *lastobject;
-extern Object *lowestobject, *highestobject;
 
 #endif
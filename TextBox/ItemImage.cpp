@@ -40,7 +40,7 @@ void TB_ItemImage::SetSprite(int sprite, int frame)
 void c------------------------------() {}
 */
 
-void TB_ItemImage::Draw(void)
+void TB_ItemImage::Run(void)
 {
 	if (!fVisible)
 		return;
@@ -48,6 +48,12 @@ void TB_ItemImage::Draw(void)
 	// animate moving item downwards into box
 	int desty = (ITEMBOX_H / 2) - (sprites[fSprite].h / 2);
 	if (++fYOffset > desty) fYOffset = desty;
+}
+
+void TB_ItemImage::Draw(void)
+{
+	if (!fVisible)
+		return;
 	
 	// draw the box frame
 	TextBox::DrawFrame(ITEMBOX_X, ITEMBOX_Y, ITEMBOX_W, ITEMBOX_H);
@@ -6,6 +6,7 @@ class TB_ItemImage
 {
 public:
 	void ResetState();
+	void Run();
 	void Draw();
 	
 	void SetVisible(bool enable);
@@ -343,13 +343,19 @@ int hx, len;
 
 
 
-void TB_SaveSelect::Draw(void)
+void TB_SaveSelect::Run(void)
 {
 	if (!fVisible)
 		return;
 	
 	// handle user input
 	Run_Input();
+}
+
+void TB_SaveSelect::Draw(void)
+{
+	if (!fVisible)
+		return;
 	
 	// draw frame
 	TextBox::DrawFrame(fCoords.x, fCoords.y, fCoords.w, fCoords.h);
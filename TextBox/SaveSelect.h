@@ -15,6 +15,7 @@ public:
 	void SetVisible(bool enable, bool saving=SS_LOADING);
 	
 	bool IsVisible();
+	void Run();
 	void Draw();
 	
 private:
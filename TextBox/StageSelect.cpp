@@ -77,7 +77,7 @@ bool TB_StageSelect::IsVisible()
 void c------------------------------() {}
 */
 
-void TB_StageSelect::Draw(void)
+void TB_StageSelect::Run(void)
 {
 	if (!fVisible)
 		return;
@@ -85,10 +85,21 @@ void TB_StageSelect::Draw(void)
 	// handle user input
 	HandleInput();
 	
-	// draw "- WARP -" text
+	// slide in the "- WARP -" text
 	fWarpY -= WARP_Y_SPEED;
 	if (fWarpY < WARP_Y) fWarpY = WARP_Y;
 	
+	// flash the selector
+	if (fSelectionIndex < CountActiveSlots())
+		fSelectionFrame ^= 1;
+}
+
+void TB_StageSelect::Draw(void)
+{
+	if (!fVisible)
+		return;
+	
+	// draw "- WARP -" text
 	draw_sprite(WARP_X, fWarpY, SPR_TEXT_WARP, 0);
 	
 	// draw teleporter locations
@@ -105,10 +116,7 @@ void TB_StageSelect::Draw(void)
 		draw_sprite(x, LOCS_Y, SPR_STAGEIMAGE, sprite);
 		
 		if (i == fSelectionIndex)
-		{
-			fSelectionFrame ^= 1;
 			draw_sprite(x, LOCS_Y, SPR_SELECTOR_ITEMS, fSelectionFrame);
-		}
 		
 		x += (sprites[SPR_STAGEIMAGE].w + LOCS_SPACING);
 	}
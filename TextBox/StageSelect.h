@@ -24,6 +24,7 @@ public:
 	int CountActiveSlots();
 	
 	bool IsVisible();
+	void Run();
 	void Draw();
 	
 private:
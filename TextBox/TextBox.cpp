@@ -179,6 +179,21 @@ bool TextBox::IsBusy(void)
 void c------------------------------() {}
 */
 
+// types out the text and handles input to the box and its prompts.
+// it's part of the simulation, as scripts wait on it.
+void TextBox::Run(void)
+{
+	if (fVisible)
+	{
+		RunTextBox();
+		
+		ItemImage.Run();
+		YesNoPrompt.Run();
+		StageSelect.Run();
+		SaveSelect.Run();
+	}
+}
+
 void TextBox::Draw(void)
 {
 	if (fVisible)
@@ -194,11 +209,8 @@ void TextBox::Draw(void)
 }
 
 
-void TextBox::DrawTextBox()
+void TextBox::RunTextBox()
 {
-	int text_top = (fCoords.y + 10);
-	int text_x = CONTENT_X;
-	
 	// allow player to speed up text by holding the button
 	if (buttondown())
 	{
@@ -242,6 +254,30 @@ void TextBox::DrawTextBox()
 		}
 	}
 	
+	// face slide-in animation
+	if (fFace != 0 && fFaceXOffset < 0)
+	{
+		fFaceXOffset += (sprites[SPR_FACES].w / 6);
+		if (fFaceXOffset > 0) fFaceXOffset = 0;
+	}
+	
+	// blink the cursor (it is visible when < 7)
+	if (!fCursorVisible || (fFlags & TB_CURSOR_NEVER_SHOWN))
+	{
+		fCursorTimer = 9999;
+	}
+	else
+	{
+		if (++fCursorTimer >= 20)
+			fCursorTimer = 0;
+	}
+}
+
+void TextBox::DrawTextBox()
+{
+	int text_top = (fCoords.y + 10);
+	int text_x = CONTENT_X;
+	
 	// draw the frame
 	if (!(fFlags & TB_NO_BORDER))
 	{
@@ -259,24 +295,6 @@ void TextBox::DrawTextBox()
 	{
 		draw_sprite(CONTENT_X+fFaceXOffset, fCoords.y+CONTENT_Y-3, SPR_FACES, fFace);
 		text_x += (FACE_W + 8);		// move text over by width of face
-		
-		// face slide-in animation
-		if (fFaceXOffset < 0)
-		{
-			fFaceXOffset += (sprites[SPR_FACES].w / 6);
-			if (fFaceXOffset > 0) fFaceXOffset = 0;
-		}
-	}
-	
-	// blink the cursor (it is visible when < 7)
-	if (!fCursorVisible || (fFlags & TB_CURSOR_NEVER_SHOWN))
-	{
-		fCursorTimer = 9999;
-	}
-	else
-	{
-		if (++fCursorTimer >= 20)
-			fCursorTimer = 0;
 	}
 	
 	// draw text lines (the 4th line is for the first char shown on the new line during scrolling)
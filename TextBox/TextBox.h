@@ -55,6 +55,7 @@ public:
 	bool IsVisible();
 	bool IsBusy();
 	
+	void Run();
 	void Draw();
 	static void DrawFrame(int x, int y, int w, int h);
 	
@@ -62,6 +63,7 @@ public:
 	void SetCanSpeedUp(bool newstate);
 	
 private:
+	void RunTextBox();
 	void DrawTextBox();
 	int GetMaxLineLen();
 	void AddNextChar();
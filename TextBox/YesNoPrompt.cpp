@@ -52,26 +52,14 @@ void TB_YNJPrompt::SetVisible(bool enable)
 void c------------------------------() {}
 */
 
-void TB_YNJPrompt::Draw()
+void TB_YNJPrompt::Run()
 {
 	if (!fVisible)
 		return;
 	
-	draw_sprite(YESNO_X, fCoords.y, SPR_YESNO, 0, 0);
-	
     RectI yes_rect = RectI(YESNO_X - 20,  fCoords.y - 20, 20 + 39, sprites[SPR_YESNO].h + 20 + 20);
     RectI no_rect  = RectI(YESNO_X + 39, fCoords.y - 20, 20 + 41, sprites[SPR_YESNO].h + 20 + 20);
     
-	// draw hand selector
-	if (fState == STATE_YES_SELECTED || \
-		fState == STATE_NO_SELECTED)
-	{
-		int xoff = (fState == STATE_YES_SELECTED) ? -4 : 37;
-		draw_sprite(YESNO_X+xoff, fCoords.y+12, SPR_YESNOHAND, 0, 0);
-        
-        //Graphics::DrawRect(YESNO_X + xoff + 4, fCoords.y, YESNO_X + xoff + 4 + 37, fCoords.y + sprites[SPR_YESNO].h, 255, 255, 255);
-	}
-    
 //    Graphics::DrawRect(yes_rect.x, yes_rect.y, yes_rect.x + yes_rect.w, yes_rect.y + yes_rect.h, 255, 255, 255);
 //    Graphics::DrawRect(no_rect.x, no_rect.y, no_rect.x + no_rect.w, no_rect.y + no_rect.h, 255, 255, 255);
 
@@ -151,6 +139,24 @@ void TB_YNJPrompt::Draw()
 	}
 }
 
+void TB_YNJPrompt::Draw()
+{
+	if (!fVisible)
+		return;
+	
+	draw_sprite(YESNO_X, fCoords.y, SPR_YESNO, 0, 0);
+	
+	// draw hand selector
+	if (fState == STATE_YES_SELECTED || \
+		fState == STATE_NO_SELECTED)
+	{
+		int xoff = (fState == STATE_YES_SELECTED) ? -4 : 37;
+		draw_sprite(YESNO_X+xoff, fCoords.y+12, SPR_YESNOHAND, 0, 0);
+        
+        //Graphics::DrawRect(YESNO_X + xoff + 4, fCoords.y, YESNO_X + xoff + 4 + 37, fCoords.y + sprites[SPR_YESNO].h, 255, 255, 255);
+	}
+}
+
 /*
 void c------------------------------() {}
 */
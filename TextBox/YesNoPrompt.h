@@ -14,6 +14,7 @@ public:
 	void SetVisible(bool enable);
 	void ResetState();
 	
+	void Run();
 	void Draw();
 	
 	bool IsVisible() { return fVisible; }
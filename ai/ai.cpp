@@ -96,33 +96,23 @@ Object *newObject;
 // creates a BoomFlash and smoke, but no bonuses.
 void KillObjectsOfType(int type)
 {
-	Object *o = firstobject;
-	while(o)
+	Object *o;
+	FOREACH_OBJECT_OF_TYPE(o, type)
 	{
-		if (o->type == type)
-		{
-			SmokeClouds(o, 1, 0, 0);
-			effect(o->CenterX(), o->CenterY(), EFFECT_BOOMFLASH);
-			
-			o->Delete();
-		}
+		SmokeClouds(o, 1, 0, 0);
+		effect(o->CenterX(), o->CenterY(), EFFECT_BOOMFLASH);
 		
-		o = o->next;
+		o->Delete();
 	}
 }
 
 // deletes all objects of type "otype" silently, without any smoke or other effects.
 void DeleteObjectsOfType(int type)
 {
-	Object *o = firstobject;
-	while(o)
+	Object *o;
+	FOREACH_OBJECT_OF_TYPE(o, type)
 	{
-		if (o->type == type)
-		{
-			o->Delete();
-		}
-		
-		o = o->next;
+		o->Delete();
 	}
 }
 
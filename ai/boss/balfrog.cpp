@@ -98,6 +98,18 @@ void BalfrogBoss::OnMapEntry(void)
 	objprop[OBJ_BALFROG].shaketime = 9;
 }
 
+void BalfrogBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, o);
+	SS_PUT(out, frog);
+}
+
+void BalfrogBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, o);
+	SS_GET(in, frog);
+}
+
 /*
 void c------------------------------() {}
 */
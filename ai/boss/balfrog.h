@@ -9,6 +9,9 @@ class BalfrogBoss : public StageBoss
 public:
 	void OnMapEntry();
 	void Run();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 	void place_bboxes();
 
@@ -3,8 +3,8 @@
 #include "ballos.h"
 #include "ballos.fdh"
 
-static int platform_speed;
-static int rotators_left;
+static NX_THREAD int platform_speed;
+static NX_THREAD int rotators_left;
 #define FLOOR_Y			0x26000						// Y coord of floor
 #define CRASH_Y			(FLOOR_Y - (40 << CSF))		// Y coord of main when body hits floor
 
@@ -56,7 +56,7 @@ void BallosBoss::OnMapEntry(void)
 	main = CreateObject(0, 0, OBJ_BALLOS_MAIN);
 	game.stageboss.object = main;
 	
-	main->id2 = 1000;	// defeated script (has a flagjump in it to handle each form)
+	Objects::SetIndexedID2(main, 1000);	// defeated script (has a flagjump in it to handle each form)
 	main->flags = (FLAG_SHOW_FLOATTEXT | FLAG_SCRIPTONDEATH | \
 				   FLAG_SOLID_BRICK | FLAG_IGNORE_SOLID);
 	
@@ -108,6 +108,26 @@ void BallosBoss::OnMapEntry(void)
 	stat("BallosBoss::OnMapEntry()");
 }
 
+void BallosBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, main);
+	SS_PUT(out, body);
+	SS_PUT(out, eye);
+	SS_PUT(out, shield);
+	SS_PUT(out, platform_speed);
+	SS_PUT(out, rotators_left);
+}
+
+void BallosBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, main);
+	SS_GET(in, body);
+	SS_GET(in, eye);
+	SS_GET(in, shield);
+	SS_GET(in, platform_speed);
+	SS_GET(in, rotators_left);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -680,7 +700,7 @@ void BallosBoss::RunDefeated(Object *o)
 				o->timer = 0;
 				o->state = 1002;
 				
-				starflash.Start(o->x, o->y);
+				world->fStarflash.Start(o->x, o->y);
 				sound(SND_EXPLOSION1);
 			}
 		}
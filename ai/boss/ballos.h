@@ -11,6 +11,9 @@ public:
 	void OnMapEntry();
 	void Run();
 	void RunAftermove();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 	void RunForm1(Object *o);
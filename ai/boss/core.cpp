@@ -72,7 +72,7 @@ void CoreBoss::OnMapEntry(void)
 	o->state = 10;
 	
 	o->flags = (FLAG_SHOW_FLOATTEXT | FLAG_IGNORE_SOLID | FLAG_SCRIPTONDEATH);
-	o->id2 = 1000;
+	Objects::SetIndexedID2(o, 1000);
 	
 	o->x = (1207 << CSF);
 	o->y = (212 << CSF);
@@ -130,6 +130,20 @@ void CoreBoss::OnMapExit()
 	o = NULL;
 }
 
+void CoreBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, o);
+	SS_PUT(out, pieces);
+	SS_PUT(out, hittimer);
+}
+
+void CoreBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, o);
+	SS_GET(in, pieces);
+	SS_GET(in, hittimer);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -8,6 +8,9 @@ public:
 	void OnMapEntry();
 	void OnMapExit();
 	void Run();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 	void RunOpenMouth();
@@ -34,7 +34,7 @@ void HeavyPress::OnMapEntry(void)
 	
 	o->damage = 10;
 	o->hp = 700;
-	o->id2 = 1000;	// defeated script
+	Objects::SetIndexedID2(o, 1000);	// defeated script
 	
 	// setup bboxes
 	center_bbox = sprites[o->sprite].frame[0].dir[0].pf_bbox;
@@ -43,6 +43,30 @@ void HeavyPress::OnMapEntry(void)
 	sprites[o->sprite].bbox = fullwidth_bbox;
 }
 
+void HeavyPress::SaveState(DBuffer *out)
+{
+	SS_PUT(out, o);
+	SS_PUT(out, shield_left);
+	SS_PUT(out, shield_right);
+	SS_PUT(out, uncover_left);
+	SS_PUT(out, uncover_right);
+	SS_PUT(out, uncover_y);
+	SS_PUT(out, fullwidth_bbox);
+	SS_PUT(out, center_bbox);
+}
+
+void HeavyPress::LoadState(const uint8_t **in)
+{
+	SS_GET(in, o);
+	SS_GET(in, shield_left);
+	SS_GET(in, shield_right);
+	SS_GET(in, uncover_left);
+	SS_GET(in, uncover_right);
+	SS_GET(in, uncover_y);
+	SS_GET(in, fullwidth_bbox);
+	SS_GET(in, center_bbox);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -8,6 +8,9 @@ class HeavyPress : public StageBoss
 public:
 	void OnMapEntry();
 	void Run();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 	void run_defeated();
@@ -49,6 +49,18 @@ void IronheadBoss::OnMapExit()
 	game.stageboss.object = NULL;
 }
 
+void IronheadBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, o);
+	SS_PUT(out, hittimer);
+}
+
+void IronheadBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, o);
+	SS_GET(in, hittimer);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -93,6 +93,18 @@ void OmegaBoss::OnMapExit(void)
 		game.stageboss.object->Delete();
 }
 
+void OmegaBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, pieces);
+	SS_PUT(out, omg);
+}
+
+void OmegaBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, pieces);
+	SS_GET(in, omg);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -373,7 +385,7 @@ void OmegaBoss::Run(void)
 			if (++omg.timer > 100)
 			{
 				omg.timer = 0;
-				starflash.Start(o->CenterX(), o->CenterY());
+				world->fStarflash.Start(o->CenterX(), o->CenterY());
 				o->state = OMG_EXPLODED;
 			}
 			else if (omg.timer==24)
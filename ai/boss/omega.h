@@ -10,6 +10,9 @@ public:
 	void OnMapExit();
 	
 	void Run();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 
@@ -93,7 +93,7 @@ int i;
 	main->timer2 = random(700, 1200);
 	main->hp = 500;
 	
-	main->id2 = 1000;
+	Objects::SetIndexedID2(main, 1000);
 	main->flags |= FLAG_SCRIPTONDEATH;
 	
 	game.stageboss.object = main;
@@ -105,6 +105,22 @@ void SistersBoss::OnMapExit()
 	game.stageboss.object = NULL;
 }
 
+void SistersBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, mainangle);
+	SS_PUT(out, main);
+	SS_PUT(out, head);
+	SS_PUT(out, body);
+}
+
+void SistersBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, mainangle);
+	SS_GET(in, main);
+	SS_GET(in, head);
+	SS_GET(in, body);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -257,7 +273,7 @@ int i;
 					hitdetect(head[0], body[1]) || \
 					hitdetect(head[1], body[0]))
 				{
-					starflash.Start(o->CenterX(), o->CenterY());
+					world->fStarflash.Start(o->CenterX(), o->CenterY());
 					sound(SND_EXPLOSION1);
 					
 					o->state = STATE_STARFLASH;
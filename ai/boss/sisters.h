@@ -13,6 +13,9 @@ public:
 	void OnMapEntry();
 	void OnMapExit();
 	void Run();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 	void run_head(int index);
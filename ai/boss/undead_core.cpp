@@ -96,7 +96,7 @@ Object *o;
 	o->hp = 700;
 	o->x = (592 << CSF);
 	o->y = (120 << CSF);
-	o->id2 = 1000;	// defeated script
+	Objects::SetIndexedID2(o, 1000);	// defeated script
 	o->flags = (FLAG_SHOW_FLOATTEXT | FLAG_IGNORE_SOLID | FLAG_SCRIPTONDEATH);
 	
 	// create rear rotators
@@ -134,6 +134,26 @@ void UDCoreBoss::OnMapExit()
 	game.stageboss.object = NULL;
 }
 
+void UDCoreBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, main);
+	SS_PUT(out, front);
+	SS_PUT(out, back);
+	SS_PUT(out, face);
+	SS_PUT(out, rotator);
+	SS_PUT(out, bbox);
+}
+
+void UDCoreBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, main);
+	SS_GET(in, front);
+	SS_GET(in, back);
+	SS_GET(in, face);
+	SS_GET(in, rotator);
+	SS_GET(in, bbox);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -489,7 +509,7 @@ bool UDCoreBoss::RunDefeated()
 			if (o->timer > 100)
 			{
 				sound(SND_EXPLOSION1);
-				starflash.Start(o->x, o->y);
+				world->fStarflash.Start(o->x, o->y);
 				
 				o->state++;
 				o->timer = 0;
@@ -21,6 +21,9 @@ public:
 	void OnMapExit();
 	void Run();
 	void RunAftermove();
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 private:
 	bool RunDefeated();
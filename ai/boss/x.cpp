@@ -70,6 +70,34 @@ void XBoss::OnMapExit()
 	game.stageboss.object = NULL;
 }
 
+void XBoss::SaveState(DBuffer *out)
+{
+	SS_PUT(out, mainobject);
+	SS_PUT(out, body);
+	SS_PUT(out, treads);
+	SS_PUT(out, internals);
+	SS_PUT(out, doors);
+	SS_PUT(out, targets);
+	SS_PUT(out, fishspawners);
+	SS_PUT(out, piecelist);
+	SS_PUT(out, npieces);
+	SS_PUT(out, X);
+}
+
+void XBoss::LoadState(const uint8_t **in)
+{
+	SS_GET(in, mainobject);
+	SS_GET(in, body);
+	SS_GET(in, treads);
+	SS_GET(in, internals);
+	SS_GET(in, doors);
+	SS_GET(in, targets);
+	SS_GET(in, fishspawners);
+	SS_GET(in, piecelist);
+	SS_GET(in, npieces);
+	SS_GET(in, X);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -308,7 +336,7 @@ int i;
 			
 			if (o->timer > 100)
 			{
-				starflash.Start(o->CenterX(), o->CenterY());
+				world->fStarflash.Start(o->CenterX(), o->CenterY());
 				sound(SND_EXPLOSION1);
 				o->timer = 0;
 				o->state++;
@@ -15,6 +15,9 @@ public:
 	void Run();
 	void RunAftermove();
 	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
+	
 private:
 	void run_tread(int index);
 	void run_body(int index);
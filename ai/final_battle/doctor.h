@@ -2,8 +2,8 @@
 #ifndef _DOCTOR_H
 #define _DOCTOR_H
 
-extern int crystal_xmark, crystal_ymark;
-extern bool crystal_tofront;
+extern NX_THREAD int crystal_xmark, crystal_ymark;
+extern NX_THREAD bool crystal_tofront;
 
 
 #endif
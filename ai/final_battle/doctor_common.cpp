@@ -2,8 +2,8 @@
 #include "../stdai.h"
 #include "doctor_common.fdh"
 
-int crystal_xmark, crystal_ymark;
-bool crystal_tofront;
+NX_THREAD int crystal_xmark, crystal_ymark;
+NX_THREAD bool crystal_tofront;
 
 
 Object *dr_create_red_crystal(int x, int y)
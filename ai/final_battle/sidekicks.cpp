@@ -23,8 +23,8 @@ INITFUNC(AIRoutines)
 	ONTICK(OBJ_MISERY_MISSILE, ai_misery_missile);
 }
 
-bool sue_being_hurt;
-bool sue_was_killed;
+NX_THREAD bool sue_being_hurt;
+NX_THREAD bool sue_was_killed;
 
 /*
 void c------------------------------() {}
@@ -448,7 +448,7 @@ static void run_lightning(Object *o)
 			o->timer++;
 			
 			if (o->timer == 40)
-				flashscreen.Start();
+				world->fFlashScreen.Start();
 			
 			if (o->timer > 50)
 			{
@@ -593,7 +593,7 @@ static void run_defeated(Object *o)
 			
 			if (o->y < 0)
 			{
-				flashscreen.Start();
+				world->fFlashScreen.Start();
 				sound(SND_TELEPORT);
 				
 				o->xinertia = 0;
@@ -640,7 +640,7 @@ void ai_mesa(Object *o)
 				
 				if (o->linkedobject)
 				{
-					Object *&block = o->linkedobject;
+					Object *block = o->linkedobject;
 					
 					block->y = (o->y - (4<<CSF));
 					block->xinertia = (o->dir == RIGHT) ? 0x400 : -0x400;
@@ -785,16 +785,16 @@ void ai_deleet(Object *o)
 						int x = (o->x >> CSF) / TILE_W;
 						int y = ((o->y >> CSF) - 8) / TILE_H;
 						
-						map.tiles[x][y] = 0;
-						map.tiles[x][y+1] = 0;
+						map_settile(x, y, 0);
+						map_settile(x, y+1, 0);
 					}
 					else
 					{
 						int x = ((o->x >> CSF) - 8) / TILE_W;
 						int y = (o->y >> CSF) / TILE_H;
 						
-						map.tiles[x][y] = 0;
-						map.tiles[x+1][y] = 0;
+						map_settile(x, y, 0);
+						map_settile(x+1, y, 0);
 					}
 					
 				}
@@ -829,7 +829,7 @@ void ai_rolling(Object *o)
 		int mx = (o->CenterX() >> CSF) / TILE_W;
 		int my = (o->CenterY() >> CSF) / TILE_H;
 		
-		if (map.tiles[mx][my])
+		if (map_tile(mx, my))
 			map_ChangeTileWithSmoke(mx, my, 0, 8);
 		
 		o->state = 1;
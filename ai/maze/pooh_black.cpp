@@ -7,7 +7,7 @@
 #define FRAME_LANDED		2
 #define FRAME_FLYING		3
 
-static int bubble_xmark = 0, bubble_ymark = 0;
+static NX_THREAD int bubble_xmark = 0, bubble_ymark = 0;
 
 
 INITFUNC(AIRoutines)
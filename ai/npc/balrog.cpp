@@ -217,7 +217,7 @@ bool fall = true;
 			{
 				int x = (o->CenterX() >> CSF) / TILE_W;
 				
-				if (map.tiles[x][y] != 0)
+				if (map_tile(x, y) != 0)
 				{
 					// smoke needs to go at the bottom of z-order or you can't
 					// see any of the characters through all the smoke.
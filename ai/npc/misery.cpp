@@ -231,7 +231,7 @@ void ai_misery_stand(Object *o)
 			if (++o->timer == 20)
 			{
 				sound(SND_LIGHTNING_STRIKE);
-				flashscreen.Start();
+				world->fFlashScreen.Start();
 				o->state = 27;
 				o->timer = 0;
 				o->frame = 4;
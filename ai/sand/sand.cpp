@@ -479,7 +479,7 @@ Object *skull;
 	o->animframe = random(0, 1);
 	o->animtimer = random(0, 4);
 	o->state = 101;
-	o->type = OBJ_CROW;
+	Objects::SetIndexedType(o, OBJ_CROW);
 	
 	// run the ai for the normal crow for this first frame
 	ai_crow(o);
@@ -542,7 +542,7 @@ void ai_skullhead_carried(Object *o)
 	// if our crow dies, change into a regular skullhead
 	if (!o->linkedobject)
 	{
-		o->type = OBJ_SKULLHEAD;
+		Objects::SetIndexedType(o, OBJ_SKULLHEAD);
 		o->state = 2;	// falling
 		o->speed = 0x200;
 		XMOVE(o->speed);
@@ -798,7 +798,7 @@ int i;
 	if (o->CheckAttribute(&sprites[o->sprite].block_d, TA_SOLID_NPC, &x, &y))
 	{
 		// if the tile above it is also solid, it can't be a floor, it's a wall!
-		if (tileattr[map.tiles[x][y-1]] & TA_SOLID_NPC)
+		if (tileattr[map_tile(x, y-1)] & TA_SOLID_NPC)
 		{
 			return;
 		}
@@ -806,15 +806,15 @@ int i;
 		{
 			// it's also a wall if the tile below is solid and neither of the tiles to
 			// the left or right are solid (top of a wall)
-			if (tileattr[map.tiles[x][y+1]] & TA_SOLID_NPC)
+			if (tileattr[map_tile(x, y+1)] & TA_SOLID_NPC)
 			{
 				// we have to check TWO tiles to the right and see if EITHER is nonsolid because
 				// of the two-tile wall on the right-lower "arena" slopey part--kind of a hack,
 				// i hate to have to put map-specific code in
-				if (!(tileattr[map.tiles[x+1][y]] & TA_SOLID_NPC) || \
-					!(tileattr[map.tiles[x+2][y]] & TA_SOLID_NPC))
+				if (!(tileattr[map_tile(x+1, y)] & TA_SOLID_NPC) || \
+					!(tileattr[map_tile(x+2, y)] & TA_SOLID_NPC))
 				{
-					if (!(tileattr[map.tiles[x-1][y]] & TA_SOLID_NPC))
+					if (!(tileattr[map_tile(x-1, y)] & TA_SOLID_NPC))
 					{
 						return;
 					}
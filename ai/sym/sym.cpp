@@ -168,7 +168,7 @@ int x, y, t;
 	{
 		for(y=tiley;y>=0;y--)
 		{
-			t = map.tiles[tilex][y];
+			t = map_tile(tilex, y);
 			if (tileattr[t] & TA_SOLID) { y++; break; }
 		}
 		
@@ -176,7 +176,7 @@ int x, y, t;
 		
 		for(y=tiley;y<map.ysize;y++)
 		{
-			t = map.tiles[tilex][y];
+			t = map_tile(tilex, y);
 			if (tileattr[t] & TA_SOLID) { y--; break; }
 		}
 		
@@ -186,7 +186,7 @@ int x, y, t;
 	{
 		for(x=tilex;x>=0;x--)
 		{
-			t = map.tiles[x][tiley];
+			t = map_tile(x, tiley);
 			if (tileattr[t] & TA_SOLID) { x++; break; }
 		}
 		
@@ -194,7 +194,7 @@ int x, y, t;
 		
 		for(x=tilex;x<map.xsize;x++)
 		{
-			t = map.tiles[x][tiley];
+			t = map_tile(x, tiley);
 			if (tileattr[t] & TA_SOLID) { x--; break; }
 		}
 		
@@ -562,7 +562,7 @@ void ai_lightning(Object *o)
 			o->state = 1;
 			
 			if (o->dir == RIGHT)
-				flashscreen.Start();
+				world->fFlashScreen.Start();
 		}
 		case 1:
 		{
@@ -1095,7 +1095,7 @@ void ai_scroll_controller(Object *o)
 				
 				if (o->linkedobject)
 				{
-					staterr("sctrl: successfully linked to object %08x", o->linkedobject);
+					staterr("sctrl: successfully linked to object %08x", (Object *)o->linkedobject);
 				}
 				else
 				{
@@ -1186,7 +1186,7 @@ void onspawn_spike_small(Object *o)
 	// extraneous and invisible because they are embedded
 	// in the wall, but due to slight engine differences
 	// you can still sometimes get hurt by them in our engine.
-	int tile = map.tiles[(o->CenterX() >> CSF) / TILE_W][(o->CenterY() >> CSF) / TILE_H];
+	int tile = map_tile((o->CenterX() >> CSF) / TILE_W, (o->CenterY() >> CSF) / TILE_H);
 	if (tileattr[tile] & TA_SOLID)
 	{
 		stat("onspawn_spike_small: spike %08x embedded in wall, deleting", o);
@@ -58,7 +58,7 @@ void ai_snake(Object *o)
 
 void ai_snake_23(Object *o)
 {
-static int wave_dir = 0;
+static NX_THREAD int wave_dir = 0;
 
 	if (o->state == 0)
 	{
@@ -1,5 +1,6 @@
 
 #include "weapons.h"
+#include "../../hitgrid.h"
 #include "weapons.fdh"
 
 /*
@@ -51,23 +52,14 @@ void c------------------------------() {}
 // certain flags set (such as if you don't want to try to hurt invulnerable enemies).
 Object *check_hit_enemy(Object *shot, uint32_t flags_to_exclude)
 {
-	Object *enemy;
-	FOREACH_OBJECT(enemy)
+	Object *enemy = NULL;
+	while((enemy = HitGrid::FindNext(shot, flags_to_exclude, enemy)))
 	{
-		if (enemy->flags & (FLAG_SHOOTABLE | FLAG_INVULNERABLE))
+		// can't hit an enemy by shooting up when standing on it
+		// (added for omega battle but good probably in other times too)
+		if (player->riding != enemy || shot->yinertia >= 0)
 		{
-			if ((enemy->flags & flags_to_exclude) == 0)
-			{
-				if (hitdetect(enemy, shot))
-				{
-					// can't hit an enemy by shooting up when standing on it
-					// (added for omega battle but good probably in other times too)
-					if (player->riding != enemy || shot->yinertia >= 0)
-					{
-						return enemy;
-					}
-				}
-			}
+			return enemy;
 		}
 	}
 	
@@ -106,31 +98,22 @@ Object *enemy;
 // not just the first one found. Returns the number of enemies hit.
 int damage_all_enemies_in_bb(Object *o, uint32_t flags_to_exclude)
 {
-Object *enemy;
+Object *enemy = NULL;
 int count = 0;
 
-	FOREACH_OBJECT(enemy)
+	while((enemy = HitGrid::FindNext(o, flags_to_exclude, enemy)))
 	{
-		if (enemy->flags & (FLAG_SHOOTABLE | FLAG_INVULNERABLE))
+		if (enemy->flags & FLAG_INVULNERABLE)
 		{
-			if ((enemy->flags & flags_to_exclude) == 0)
-			{
-				if (hitdetect(enemy, o))
-				{
-					if (enemy->flags & FLAG_INVULNERABLE)
-					{
-						shot_spawn_effect(o, EFFECT_STARSOLID);
-						sound(SND_TINK);
-					}
-					else
-					{
-						enemy->DealDamage(o->shot.damage, o);
-					}
-					
-					count++;
-				}
-			}
+			shot_spawn_effect(o, EFFECT_STARSOLID);
+			sound(SND_TINK);
 		}
+		else
+		{
+			enemy->DealDamage(o->shot.damage, o);
+		}
+		
+		count++;
 	}
 	
 	return count;
@@ -225,7 +208,7 @@ SIFPointList *plist;
 	// see if we've hit a destroyable block
 	if (o->CheckAttribute(plist, TA_DESTROYABLE, &x, &y))
 	{
-		map.tiles[x][y]--;
+		map_settile(x, y, map_tile(x, y) - 1);
 		SmokeCloudsSlow(((x * TILE_W) + (TILE_W / 2)) << CSF, \
 						((y * TILE_H) + (TILE_H / 2)) << CSF, 4);
 		
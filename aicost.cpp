@@ -0,0 +1,135 @@
+
+#include "nx.h"
+#include "aicost.h"
+
+extern const char *object_names[];	// from autogen'd objnames.cpp
+
+bool AICost::enabled = false;
+
+#define MAX_NESTING		32
+
+static uint32_t calls[OBJ_LAST][AIR_COUNT];
+static uint64_t counts[OBJ_LAST][AIR_COUNT];		// self time
+static uint64_t inclusive[OBJ_LAST][AIR_COUNT];	// with nested routines
+static double us_per_count = 0;
+
+// routines nest when one spawns or kills objects. for each level of
+// the calls in progress, the time its nested calls have taken so far.
+static uint64_t nested[MAX_NESTING];
+static int depth = 0;
+
+static const char *routine_names[] =
+{
+	"ontick", "aftermove", "onspawn", "ondeath"
+};
+
+void AICost::Call(Object *o, void (*routine)(Object *o), int which)
+{
+	int type = o->type;
+	
+	// only runaway recursion goes this deep; the time
+	// ends up in whichever call is accounted above it.
+	if (depth >= MAX_NESTING)
+	{
+		(*routine)(o);
+		return;
+	}
+	
+	int level = depth++;
+	nested[level] = 0;
+	uint64_t start = SDL_GetPerformanceCounter();
+	
+	(*routine)(o);
+	
+	uint64_t elapsed = (SDL_GetPerformanceCounter() - start);
+	depth--;
+	
+	counts[type][which] += (elapsed - nested[level]);
+	inclusive[type][which] += elapsed;
+	calls[type][which]++;
+	
+	if (level > 0)
+		nested[level - 1] += elapsed;
+}
+
+void AICost::SetEnabled(bool enable)
+{
+	if (enable && !enabled)
+	{
+		us_per_count = (1000000.0 / (double)SDL_GetPerformanceFrequency());
+		Reset();
+	}
+	
+	enabled = enable;
+}
+
+void AICost::Reset()
+{
+	memset(calls, 0, sizeof(calls));
+	memset(counts, 0, sizeof(counts));
+	memset(inclusive, 0, sizeof(inclusive));
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static int compare_entries(const void *a, const void *b)
+{
+	double ta = ((const AICostEntry *)a)->total_us;
+	double tb = ((const AICostEntry *)b)->total_us;
+	
+	if (ta > tb) return -1;
+	if (ta < tb) return 1;
+	return 0;
+}
+
+// fills out with up to max of the object types which have cost the most
+// time since accounting was turned on, most expensive first by self time.
+int AICost::GetTop(AICostEntry *out, int max)
+{
+AICostEntry *all;
+int i, j, count = 0;
+
+	all = (AICostEntry *)malloc(OBJ_LAST * sizeof(AICostEntry));
+	
+	for(i=0;i<OBJ_LAST;i++)
+	{
+		AICostEntry *e = &all[count];
+		e->type = i;
+		e->total_us = 0;
+		e->inclusive_us = 0;
+		
+		for(j=0;j<AIR_COUNT;j++)
+		{
+			e->calls[j] = calls[i][j];
+			e->us[j] = (double)counts[i][j] * us_per_count;
+			e->total_us += e->us[j];
+			e->inclusive_us += (double)inclusive[i][j] * us_per_count;
+		}
+		
+		if (e->total_us > 0)
+			count++;
+	}
+	
+	qsort(all, count, sizeof(AICostEntry), compare_entries);
+	
+	if (count > max) count = max;
+	memcpy(out, all, count * sizeof(AICostEntry));
+	
+	free(all);
+	return count;
+}
+
+const char *AICost::TypeName(int type)
+{
+	if (type >= 0 && type < OBJ_LAST && object_names[type])
+		return object_names[type];
+	
+	return stprintf("type %d", type);
+}
+
+const char *AICost::RoutineName(int which)
+{
+	return routine_names[which];
+}
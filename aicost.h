@@ -0,0 +1,45 @@
+#ifndef _AICOST_H
+#define _AICOST_H
+
+// optional accounting of the time spent in each object type's AI routines.
+// while it's on, Object::OnTick/OnAftermove/OnSpawn/OnDeath go through
+// AICost::Call, which adds up calls and time per type and per routine.
+// the time is charged to the type the object had when the routine was
+// called, even if the routine changes it. it's self time: when a routine
+// spawns or kills objects, their onspawn/ondeath run nested inside it and
+// are charged to their own types, not to it as well. inclusive_us has the
+// time with the nested routines counted in.
+enum AIRoutine
+{
+	AIR_ONTICK,
+	AIR_AFTERMOVE,
+	AIR_ONSPAWN,
+	AIR_ONDEATH,
+	
+	AIR_COUNT
+};
+
+struct AICostEntry
+{
+	int type;
+	uint32_t calls[AIR_COUNT];
+	double us[AIR_COUNT];
+	double total_us;
+	double inclusive_us;
+};
+
+namespace AICost
+{
+	extern bool enabled;
+	
+	void Call(Object *o, void (*routine)(Object *o), int which);
+	
+	void SetEnabled(bool enable);
+	void Reset();
+	
+	int GetTop(AICostEntry *out, int max);
+	const char *TypeName(int type);
+	const char *RoutineName(int which);
+};
+
+#endif
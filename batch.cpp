@@ -0,0 +1,302 @@
+#include <string.h>
+
+#include "nx.h"
+#include "batch.h"
+
+void SetLogFilename(const char *fname);
+bool run_stages(bool inhibit_loadfade);
+
+enum BatchStatus
+{
+	BS_NOTRUN,		// never started, or the worker running it failed
+	BS_OK,
+	BS_DESYNC
+};
+
+struct BatchResult
+{
+	int status;
+	int ticks;
+	uint32_t ms;
+};
+
+// a worker thread, and the world it plays its replays in
+struct BatchWorker
+{
+	SDL_Thread *thread;
+	World *world;
+	int index;
+};
+
+static StringList replays;
+static const char *outfile = "verify.json";
+static int njobs = 0;			// 0 = one per CPU
+static bool active = false;
+
+static BatchResult *results = NULL;		// one per replay
+static SDL_atomic_t nextjob;
+static BatchWorker *workers = NULL;		// NULL when running in-process
+static uint32_t starttime;
+
+// the job being run by the calling thread
+static NX_THREAD int curjob = -1;
+static NX_THREAD uint32_t jobstart;
+static NX_THREAD int jobticks;
+
+static int worker_main(void *data);
+static int take_job();
+static void finish_job();
+static bool write_report(int jobs, uint32_t ms);
+
+/*
+void c------------------------------() {}
+*/
+
+void Batch::AddReplay(const char *fname)
+{
+	replays.AddString(fname);
+	active = true;
+}
+
+void Batch::SetJobs(int jobs)
+{
+	njobs = (jobs > 0) ? jobs : 0;
+}
+
+void Batch::SetOutput(const char *fname)
+{
+	outfile = fname;
+}
+
+bool Batch::IsActive()
+{
+	return (active && curjob >= 0);
+}
+
+const char *Batch::CurrentReplay()
+{
+	if (!IsActive()) return NULL;
+	return replays.StringAt(curjob);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// called from main once everything is loaded. returns true if the replays
+// are being run on worker threads, in which case main should just call
+// Finish and exit; otherwise Batch is now active and the main loop should
+// start the first replay.
+bool Batch::Start()
+{
+int jobs, i;
+
+	if (!active)
+		return false;
+	
+	jobs = njobs ? njobs : SDL_GetCPUCount();
+	if (jobs > replays.CountItems()) jobs = replays.CountItems();
+	if (jobs < 1) jobs = 1;
+	
+	// -software draws every frame, and there is only the one screen
+	if (software_render)
+		jobs = 1;
+	
+	results = (BatchResult *)calloc(replays.CountItems(), sizeof(BatchResult));
+	SDL_AtomicSet(&nextjob, 0);
+	starttime = SDL_GetTicks();
+	stat("Batch::Start: verifying %d replays with %d jobs", replays.CountItems(), jobs);
+	
+	if (jobs > 1)
+	{
+		// the worlds are created here, as only the main thread may do that
+		workers = (BatchWorker *)calloc(jobs, sizeof(BatchWorker));
+		for(i=0;i<jobs;i++)
+		{
+			char name[32];
+			sprintf(name, "batch%d", i);
+			
+			workers[i].index = i;
+			workers[i].world = new World;
+			workers[i].thread = SDL_CreateThread(worker_main, name, &workers[i]);
+			if (!workers[i].thread)
+			{
+				staterr("Batch::Start: failed to start worker %d: %s", i, SDL_GetError());
+				delete workers[i].world;
+				break;
+			}
+		}
+		
+		if (i > 0)
+		{
+			njobs = i;
+			return true;
+		}
+		
+		free(workers);
+		workers = NULL;
+	}
+	
+	njobs = 1;
+	curjob = take_job();
+	return false;
+}
+
+// a worker thread: sets up a world of its own, and keeps playing replays in
+// it until there are none left.
+static int worker_main(void *data)
+{
+BatchWorker *w = (BatchWorker *)data;
+char logname[64];
+
+	sprintf(logname, "debug-worker%d.txt", w->index);
+	SetLogFilename(logname);
+	
+	world_enter(w->world);
+	if (world_init())
+	{
+		staterr("batch: worker %d: world_init failed", w->index);
+		world_close();
+		return 1;
+	}
+	
+	curjob = take_job();
+	if (curjob >= 0)
+	{
+		game.setmode(GM_NORMAL);
+		game.switchstage.mapno = START_REPLAY;
+		run_stages(false);
+	}
+	
+	world_close();
+	return 0;
+}
+
+// called by the main loop after every tick
+void Batch::OnTickDone()
+{
+	if (!IsActive())
+		return;
+	
+	if (jobticks++ == 0)
+		jobstart = SDL_GetTicks();
+	
+	if (Replay::IsPlaying())
+		return;
+	
+	finish_job();
+	
+	curjob = take_job();
+	if (curjob >= 0)
+		game.switchstage.mapno = START_REPLAY;
+	else
+		game.running = false;
+}
+
+// waits for the worker threads, if there are any, and writes the report.
+// returns nonzero if any replay desynced or wasn't run.
+bool Batch::Finish()
+{
+int i, failed = 0;
+
+	if (!active || !results)
+		return 0;
+	
+	if (workers)
+	{
+		for(i=0;i<njobs;i++)
+		{
+			int status;
+			SDL_WaitThread(workers[i].thread, &status);
+			if (status != 0)
+				staterr("Batch::Finish: worker %d failed", i);
+			
+			delete workers[i].world;
+		}
+		
+		free(workers);
+		workers = NULL;
+	}
+	
+	uint32_t ms = (SDL_GetTicks() - starttime);
+	
+	for(i=0;i<replays.CountItems();i++)
+	{
+		BatchResult *r = &results[i];
+		
+		if (r->status != BS_OK)
+		{
+			staterr("batch: '%s': %s", replays.StringAt(i), \
+				(r->status == BS_DESYNC) ? "DESYNC" : "not run");
+			failed++;
+		}
+	}
+	
+	write_report(njobs, ms);
+	stat("batch: %d of %d replays ok in %d ms with %d jobs", \
+		replays.CountItems() - failed, replays.CountItems(), ms, njobs);
+	
+	free(results);
+	results = NULL;
+	return (failed != 0);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static int take_job()
+{
+	int job = SDL_AtomicAdd(&nextjob, 1);
+	
+	jobticks = 0;
+	return (job < replays.CountItems()) ? job : -1;
+}
+
+static void finish_job()
+{
+	BatchResult *r = &results[curjob];
+	
+	r->ticks = jobticks;
+	r->ms = (SDL_GetTicks() - jobstart);
+	r->status = Replay::HasDesynced() ? BS_DESYNC : BS_OK;
+	
+	stat("batch: '%s': %d ticks in %d ms%s", replays.StringAt(curjob), \
+		r->ticks, r->ms, (r->status == BS_DESYNC) ? " -- DESYNC" : "");
+}
+
+static bool write_report(int jobs, uint32_t ms)
+{
+FILE *fp;
+int i;
+
+	fp = fileopenRW(outfile, "wb");
+	if (!fp)
+	{
+		staterr("batch: failed to open '%s' for writing", outfile);
+		return 1;
+	}
+	
+	static const char *status_names[] = { "notrun", "ok", "desync" };
+	
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"jobs\": %d,\n", jobs);
+	fprintf(fp, "\t\"ms\": %u,\n", ms);
+	fprintf(fp, "\t\"replays\": [\n");
+	
+	for(i=0;i<replays.CountItems();i++)
+	{
+		BatchResult *r = &results[i];
+		fprintf(fp, "\t\t{ \"file\": ");
+		fputjsonstring(replays.StringAt(i), fp);
+		fprintf(fp, ", \"status\": \"%s\", \"ticks\": %d, \"ms\": %u }%s\n", \
+			status_names[r->status], r->ticks, r->ms, \
+			(i + 1 < replays.CountItems()) ? "," : "");
+	}
+	
+	fprintf(fp, "\t]\n}\n");
+	fclose(fp);
+	
+	stat("batch: report written to '%s'", outfile);
+	return 0;
+}
@@ -0,0 +1,27 @@
+#ifndef _BATCH_H
+#define _BATCH_H
+
+// batch replay verification: plays back a list of replays headless, as fast
+// as possible, and reports which of them no longer match the world-state
+// checkpoints recorded in them.
+//
+// with more than one job, that many worker threads are started once all the
+// data is loaded. each has a World of its own to simulate in (see world.h)
+// and takes the next replay off a shared counter whenever it finishes one;
+// the main thread waits for them and writes the report. with one job the
+// replays simply run in the main world.
+namespace Batch
+{
+	void AddReplay(const char *fname);
+	void SetJobs(int jobs);
+	void SetOutput(const char *fname);
+	
+	bool IsActive();
+	const char *CurrentReplay();
+	
+	bool Start();
+	void OnTickDone();
+	bool Finish();
+};
+
+#endif
@@ -0,0 +1,303 @@
+
+#include <algorithm>
+#include <vector>
+#include <string.h>
+
+#include "nx.h"
+#include "bench.h"
+#include "aicost.h"
+
+#define BENCH_TICK			BP_COUNT		// series index for the whole tick
+#define BENCH_NSERIES		(BP_COUNT + 1)
+#define BENCH_AI_TYPES		10			// how many of the most expensive AI types to report
+
+static const char *phase_names[] =
+{
+	"other",
+	"HandlePlayer",
+	"RunAI",
+	"PhysicsSim",
+	"aftermove",
+	"CullDeleted",
+	"DrawScene",
+	"DrawStatusBar",
+	"textbox.Draw",
+	"tick"
+};
+
+struct BenchRun
+{
+	int ticks;
+	uint32_t ms;
+	bool desynced;		// playback didn't match the checkpoints in the replay
+};
+
+static StringList replays;
+static const char *outfile = "bench.json";
+static int curreplay = -1;
+static bool finished = false;
+
+static std::vector<BenchRun> runs;
+static BenchRun currun;
+static uint32_t runstart;
+
+// per-tick samples, in microseconds
+static std::vector<float> samples[BENCH_NSERIES];
+static double curphase[BENCH_NSERIES];
+
+static bool timing = false;
+static uint64_t ticklast;
+static uint64_t tickstart;
+static double us_per_count;
+
+static void finish_run();
+static bool write_report();
+static void write_ai_types(FILE *fp, bool csv);
+
+/*
+void c------------------------------() {}
+*/
+
+void Bench::AddReplay(const char *fname)
+{
+	replays.AddString(fname);
+	curreplay = 0;
+}
+
+void Bench::SetOutput(const char *fname)
+{
+	outfile = fname;
+}
+
+bool Bench::IsActive()
+{
+	return (curreplay >= 0 && !finished);
+}
+
+const char *Bench::CurrentReplay()
+{
+	if (!IsActive()) return NULL;
+	return replays.StringAt(curreplay);
+}
+
+// called by the main loop after every tick. when the current replay has
+// run out, moves on to the next one or writes the report and exits.
+void Bench::OnTickDone()
+{
+	if (!IsActive())
+		return;
+
+	if (currun.ticks++ == 0)
+		runstart = SDL_GetTicks();
+
+	if (Replay::IsPlaying())
+		return;
+
+	finish_run();
+
+	if (++curreplay < replays.CountItems())
+	{
+		game.switchstage.mapno = START_REPLAY;
+		return;
+	}
+
+	write_report();
+	finished = true;
+	game.running = false;
+}
+
+static void finish_run()
+{
+	currun.ms = (SDL_GetTicks() - runstart);
+	currun.desynced = Replay::HasDesynced();
+	stat("bench: '%s': %d ticks in %d ms", replays.StringAt(curreplay), currun.ticks, currun.ms);
+
+	runs.push_back(currun);
+	memset(&currun, 0, sizeof(currun));
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void Bench::TickBegin()
+{
+	timing = (IsActive() && Replay::IsPlaying());
+	if (!timing) return;
+
+	if (us_per_count == 0)
+		us_per_count = (1000000.0 / (double)SDL_GetPerformanceFrequency());
+
+	memset(curphase, 0, sizeof(curphase));
+	tickstart = ticklast = SDL_GetPerformanceCounter();
+}
+
+// attribute the time since the last mark to the given phase
+void Bench::Mark(int phase)
+{
+	if (!timing) return;
+
+	uint64_t now = SDL_GetPerformanceCounter();
+	curphase[phase] += (double)(now - ticklast) * us_per_count;
+	ticklast = now;
+}
+
+void Bench::TickEnd()
+{
+	if (!timing) return;
+
+	Mark(BP_OTHER);
+	curphase[BENCH_TICK] = (double)(ticklast - tickstart) * us_per_count;
+
+	for(int i=0;i<BENCH_NSERIES;i++)
+		samples[i].push_back((float)curphase[i]);
+
+	timing = false;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// nearest-rank percentile of an already-sorted list
+static float percentile(const std::vector<float> &sorted, int pct)
+{
+	if (sorted.empty()) return 0;
+
+	int rank = ((sorted.size() * pct) + 99) / 100;
+	if (rank < 1) rank = 1;
+
+	return sorted[rank - 1];
+}
+
+static bool write_report()
+{
+FILE *fp;
+int totalticks = 0;
+uint32_t totalms = 0;
+int i;
+
+	bool csv = false;
+	const char *ext = strrchr(outfile, '.');
+	if (ext && !strcasecmp(ext, ".csv")) csv = true;
+
+	fp = fileopenRW(outfile, "wb");
+	if (!fp)
+	{
+		staterr("bench: failed to open '%s' for writing", outfile);
+		return 1;
+	}
+
+	for(i=0;i<(int)runs.size();i++)
+	{
+		totalticks += runs[i].ticks;
+		totalms += runs[i].ms;
+	}
+
+	double tps = totalms ? ((double)totalticks * 1000.0 / totalms) : 0.0;
+
+	if (csv)
+	{
+		fprintf(fp, "phase,samples,p50_us,p95_us,p99_us,mean_us,max_us\n");
+	}
+	else
+	{
+		fprintf(fp, "{\n");
+		fprintf(fp, "\t\"headless\": %s,\n", headless ? "true" : "false");
+		fprintf(fp, "\t\"ticks\": %d,\n", totalticks);
+		fprintf(fp, "\t\"ms\": %u,\n", totalms);
+		fprintf(fp, "\t\"ticks_per_sec\": %.2f,\n", tps);
+
+		fprintf(fp, "\t\"replays\": [\n");
+		for(i=0;i<(int)runs.size();i++)
+		{
+			fprintf(fp, "\t\t{ \"file\": ");
+			fputjsonstring(replays.StringAt(i), fp);
+			fprintf(fp, ", \"ticks\": %d, \"ms\": %u, \"ticks_per_sec\": %.2f, \"desync\": %s }%s\n", \
+				runs[i].ticks, runs[i].ms, \
+				runs[i].ms ? ((double)runs[i].ticks * 1000.0 / runs[i].ms) : 0.0, \
+				runs[i].desynced ? "true" : "false", \
+				(i + 1 < (int)runs.size()) ? "," : "");
+		}
+		fprintf(fp, "\t],\n");
+		fprintf(fp, "\t\"phases\": {\n");
+	}
+
+	for(i=0;i<BENCH_NSERIES;i++)
+	{
+		std::vector<float> sorted(samples[i]);
+		std::sort(sorted.begin(), sorted.end());
+
+		double total = 0;
+		for(int j=0;j<(int)sorted.size();j++)
+			total += sorted[j];
+
+		double mean = sorted.empty() ? 0.0 : (total / sorted.size());
+		float max = sorted.empty() ? 0.0f : sorted[sorted.size() - 1];
+
+		if (csv)
+		{
+			fprintf(fp, "%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f\n", phase_names[i], (int)sorted.size(), \
+				percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99), mean, max);
+		}
+		else
+		{
+			fprintf(fp, "\t\t\"%s\": { \"samples\": %d, \"p50_us\": %.2f, \"p95_us\": %.2f, \"p99_us\": %.2f, \"mean_us\": %.2f, \"max_us\": %.2f }%s\n", \
+				phase_names[i], (int)sorted.size(), \
+				percentile(sorted, 50), percentile(sorted, 95), percentile(sorted, 99), mean, max, \
+				(i + 1 < BENCH_NSERIES) ? "," : "");
+		}
+	}
+
+	if (csv)
+		fprintf(fp, "ticks_per_sec,%d,%.2f,,,,\n", totalticks, tps);
+	else
+		fprintf(fp, "\t}");
+
+	if (AICost::enabled)
+		write_ai_types(fp, csv);
+
+	if (!csv)
+		fprintf(fp, "\n}\n");
+
+	fclose(fp);
+	stat("bench: %d ticks in %d ms (%.1f ticks/sec); report written to '%s'", totalticks, totalms, tps, outfile);
+	return 0;
+}
+
+// the object types whose AI took the most time over all the runs,
+// when -aicost accounting is on
+static void write_ai_types(FILE *fp, bool csv)
+{
+AICostEntry top[BENCH_AI_TYPES];
+int i, count;
+
+	count = AICost::GetTop(top, BENCH_AI_TYPES);
+
+	if (csv)
+		fprintf(fp, "\nai_type,ticks,ontick_us,aftermove_us,onspawn_us,ondeath_us,total_us,inclusive_us\n");
+	else
+		fprintf(fp, ",\n\t\"ai_types\": [\n");
+
+	for(i=0;i<count;i++)
+	{
+		AICostEntry *e = &top[i];
+
+		if (csv)
+		{
+			fprintf(fp, "%s,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", AICost::TypeName(e->type), \
+				e->calls[AIR_ONTICK], e->us[AIR_ONTICK], e->us[AIR_AFTERMOVE], \
+				e->us[AIR_ONSPAWN], e->us[AIR_ONDEATH], e->total_us, e->inclusive_us);
+		}
+		else
+		{
+			fprintf(fp, "\t\t{ \"type\": %d, \"name\": \"%s\", \"ticks\": %u, \"total_us\": %.1f, \"inclusive_us\": %.1f, \"ontick_us\": %.1f, \"aftermove_us\": %.1f, \"onspawn_us\": %.1f, \"ondeath_us\": %.1f }%s\n", \
+				e->type, AICost::TypeName(e->type), e->calls[AIR_ONTICK], e->total_us, e->inclusive_us, \
+				e->us[AIR_ONTICK], e->us[AIR_AFTERMOVE], e->us[AIR_ONSPAWN], e->us[AIR_ONDEATH], \
+				(i + 1 < count) ? "," : "");
+		}
+	}
+
+	if (!csv)
+		fprintf(fp, "\t]");
+}
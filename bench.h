@@ -0,0 +1,38 @@
+#ifndef _BENCH_H
+#define _BENCH_H
+
+// phases of game_tick_normal which are timed by the benchmark.
+// time between marks that isn't attributed to any of them goes to BP_OTHER.
+enum BenchPhase
+{
+	BP_OTHER,
+	BP_HANDLEPLAYER,
+	BP_RUNAI,
+	BP_PHYSICSSIM,
+	BP_AFTERMOVE,
+	BP_CULLDELETED,
+	BP_DRAWSCENE,
+	BP_DRAWSTATUSBAR,
+	BP_TEXTBOX,
+
+	BP_COUNT
+};
+
+// replay-driven benchmark: plays back a list of replay files as fast as
+// possible, times each phase of the normal game tick, and writes a report
+// with percentiles per phase and overall ticks/sec.
+namespace Bench
+{
+	void AddReplay(const char *fname);
+	void SetOutput(const char *fname);
+
+	bool IsActive();
+	const char *CurrentReplay();
+	void OnTickDone();
+
+	void TickBegin();
+	void Mark(int phase);
+	void TickEnd();
+};
+
+#endif
@@ -6,11 +6,12 @@
 #include "nx.h"
 #include <math.h>
 #include "common/llist.h"
+#include "profiler.h"
 #include "caret.fdh"
 
-Caret *firstcaret = NULL;
-Caret *lastcaret = NULL;
-static int _effecttype = EFFECT_NONE;
+#define firstcaret		(world->fFirstCaret)
+#define lastcaret		(world->fLastCaret)
+static NX_THREAD int _effecttype = EFFECT_NONE;
 
 
 bool Carets::init(void)
@@ -76,11 +77,10 @@ void Caret::MoveAtDir(int dir, int speed)
 void c------------------------------() {}
 */
 
-void Carets::DrawAll(void)
+void Carets::RunAll(void)
 {
 Caret *c = firstcaret;
 Caret *next;
-int scr_x, scr_y;
 
 	while(c)
 	{
@@ -98,25 +98,35 @@ int scr_x, scr_y;
 			// move caret
 			c->x += c->xinertia;
 			c->y += c->yinertia;
-			
-			// get caret's onscreen position
-			// since caret's are all short-lived we just assume it's still onscreen
-			// and let SDL's clipping handle it if not.
-			if (!c->invisible && !c->deleted)	// must check deleted again in case handler_function set it
-			{
-				scr_x = (c->x >> CSF) - (map.displayed_xscroll >> CSF);
-				scr_y = (c->y >> CSF) - (map.displayed_yscroll >> CSF);
-				scr_x -= sprites[c->sprite].frame[c->frame].dir[0].drawpoint.x;
-				scr_y -= sprites[c->sprite].frame[c->frame].dir[0].drawpoint.y;
-				
-				draw_sprite(scr_x, scr_y, c->sprite, c->frame, RIGHT);
-			}
 		}
 		
 		c = next;
 	}
 }
 
+void Carets::DrawAll(void)
+{
+int scr_x, scr_y;
+
+	PROFILE_SCOPE("Carets::DrawAll");
+	
+	for(Caret *c = firstcaret; c; c = c->next)
+	{
+		// get caret's onscreen position
+		// since caret's are all short-lived we just assume it's still onscreen
+		// and let SDL's clipping handle it if not.
+		if (!c->invisible && !c->deleted)
+		{
+			scr_x = (c->x >> CSF) - (map.displayed_xscroll >> CSF);
+			scr_y = (c->y >> CSF) - (map.displayed_yscroll >> CSF);
+			scr_x -= sprites[c->sprite].frame[c->frame].dir[0].drawpoint.x;
+			scr_y -= sprites[c->sprite].frame[c->frame].dir[0].drawpoint.y;
+			
+			draw_sprite(scr_x, scr_y, c->sprite, c->frame, RIGHT);
+		}
+	}
+}
+
 int Carets::CountByEffectType(int type)
 {
 	int count = 0;
@@ -149,6 +159,37 @@ void Carets::DestroyAll(void)
 		firstcaret->Destroy();
 }
 
+// some AI counts the effects on screen, so carets go into save states too.
+// they aren't pooled, so they are simply recreated in order on restore.
+void Carets::SaveState(DBuffer *out)
+{
+Caret *c;
+int count = 0;
+
+	for(c=firstcaret;c;c=c->next)
+		count++;
+	
+	SS_PUT(out, count);
+	for(c=firstcaret;c;c=c->next)
+		SS_PUT(out, *c);
+}
+
+void Carets::LoadState(const uint8_t **in)
+{
+int count, i;
+
+	DestroyAll();
+	
+	SS_GET(in, count);
+	for(i=0;i<count;i++)
+	{
+		Caret *c = new Caret;
+		SS_GET(in, *c);
+		
+		LL_ADD_END(c, prev, next, firstcaret, lastcaret);
+	}
+}
+
 /*
 void c------------------------------() {}
 */
@@ -202,7 +243,7 @@ int i;
 		case EFFECT_GHOST_SPARKLE:
 		{
 			c = CreateCaret(x, y, SPR_GHOST_SPARKLE, caret_ghost_sparkle);
-			c->yinertia = random(-0x600, -0x200);
+			c->yinertia = fxrandom(-0x600, -0x200);
 		}
 		break;
 		
@@ -212,7 +253,7 @@ int i;
 			for(i=0;i<3;i++)
 			{
 				c = CreateCaret(x, y, SPR_BLOODHIT, caret_animate3);
-				vector_from_angle(random(0, 255), (2<<CSF), &c->xinertia, &c->yinertia);
+				vector_from_angle(fxrandom(0, 255), (2<<CSF), &c->xinertia, &c->yinertia);
 			}
 		}
 		break;
@@ -224,8 +265,8 @@ int i;
 			{
 				c = CreateCaret(x, y, SPR_BONKHEADPLUS, caret_bonkplus);
 				
-				c->xinertia = random(-0x600, 0x600);
-				c->yinertia = random(-0x200, 0x200);
+				c->xinertia = fxrandom(-0x600, 0x600);
+				c->yinertia = fxrandom(-0x200, 0x200);
 				//uint8_t angle = random(-14, 14);
 				//if (random(0, 1)) angle += 128;
 				//vector_from_angle(angle, random(0x200, 0x384), &c->xinertia, &c->yinertia);
@@ -34,10 +34,14 @@ namespace Carets
 	bool init(void);
 	void close(void);
 	
+	void RunAll(void);
 	void DrawAll(void);
 	int CountByEffectType(int type);
 	int DeleteByEffectType(int type);
 	void DestroyAll(void);
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 };
 
 // synonyms
@@ -0,0 +1,90 @@
+
+#include <stdlib.h>
+#include <string.h>
+#if !defined(WIN32)
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+#endif
+
+#include "basics.h"
+#include "MappedFile.h"
+
+void stat(const char *fmt, ...);
+void staterr(const char *fmt, ...);
+
+MappedFile::MappedFile()
+{
+	fData = NULL;
+	fLength = 0;
+	fMapped = false;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// brings in the complete contents of the given file. the file itself
+// isn't needed afterwards and can be closed as soon as this returns.
+bool MappedFile::Open(FILE *fp)
+{
+long length;
+
+	Close();
+	
+	fseek(fp, 0, SEEK_END);
+	length = ftell(fp);
+	if (length <= 0)
+	{
+		staterr("MappedFile::Open: file is empty");
+		return 1;
+	}
+	
+#if !defined(WIN32)
+	void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+	if (map != MAP_FAILED)
+	{
+		fData = (uint8_t *)map;
+		fLength = length;
+		fMapped = true;
+		return 0;
+	}
+	
+	stat("MappedFile::Open: mmap failed; reading file instead");
+#endif
+	
+	fData = (uint8_t *)malloc(length);
+	fseek(fp, 0, SEEK_SET);
+	if (fread(fData, length, 1, fp) != 1)
+	{
+		staterr("MappedFile::Open: failed to read %d bytes", (int)length);
+		Close();
+		return 1;
+	}
+	
+	fLength = length;
+	fMapped = false;
+	return 0;
+}
+
+void MappedFile::Close()
+{
+	if (fData)
+	{
+	#if !defined(WIN32)
+		if (fMapped)
+			munmap(fData, fLength);
+		else
+	#endif
+			free(fData);
+	}
+	
+	fData = NULL;
+	fLength = 0;
+	fMapped = false;
+}
@@ -0,0 +1,33 @@
+
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// gives read-only access to the whole of a file as one block of memory.
+// where the platform supports it the file is mmap'd, so only the pages which
+// are actually touched get read in; elsewhere (or if the mapping fails) it's
+// read into a malloc'd buffer instead.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+	
+	bool Open(FILE *fp);
+	void Close();
+	
+	const uint8_t *Data() const		{ return fData; }
+	int Length() const				{ return fLength; }
+	
+	bool IsOpen() const				{ return (fData != NULL); }
+	bool IsMapped() const			{ return fMapped; }
+	
+private:
+	uint8_t *fData;
+	int fLength;
+	bool fMapped;
+};
+
+#endif
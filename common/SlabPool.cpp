@@ -0,0 +1,154 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "basics.h"
+#include "SlabPool.h"
+
+// items are aligned to this, and the slab header is padded out to it
+#define SLAB_ALIGN			16
+#define ALIGN_UP(N)			(((N) + (SLAB_ALIGN - 1)) & ~(SLAB_ALIGN - 1))
+
+SlabPool *SlabPool::first = NULL;
+
+SlabPool::SlabPool(const char *name, int itemsize, int items_per_slab)
+{
+	fName = name;
+	fItemSize = ALIGN_UP(MAX(itemsize, (int)sizeof(FreeItem)));
+	fItemsPerSlab = MAX(items_per_slab, 1);
+	
+	fFreeList = NULL;
+	fSlabList = NULL;
+	fLive = fPooled = fHighWater = fSlabs = 0;
+	
+	fNextPool = first;
+	first = this;
+}
+
+SlabPool::~SlabPool()
+{
+	while(fSlabList)
+	{
+		Slab *next = fSlabList->next;
+		free(fSlabList);
+		fSlabList = next;
+	}
+	
+	SlabPool **link = &first;
+	while(*link)
+	{
+		if (*link == this)
+		{
+			*link = fNextPool;
+			break;
+		}
+		
+		link = &(*link)->fNextPool;
+	}
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void *SlabPool::Alloc()
+{
+	if (!fFreeList && AddSlab())
+		return NULL;
+	
+	FreeItem *item = fFreeList;
+	fFreeList = item->next;
+	fPooled--;
+	
+	if (++fLive > fHighWater)
+		fHighWater = fLive;
+	
+	memset(item, 0, fItemSize);
+	return item;
+}
+
+void SlabPool::Release(void *ptr)
+{
+	if (!ptr) return;
+	
+	FreeItem *item = (FreeItem *)ptr;
+	item->next = fFreeList;
+	fFreeList = item;
+	
+	fPooled++;
+	fLive--;
+}
+
+static int compare_ptrs(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t)*(void * const *)a;
+	uintptr_t pb = (uintptr_t)*(void * const *)b;
+	return (pa < pb) ? -1 : (pa > pb) ? 1 : 0;
+}
+
+// makes exactly the given items live and puts everything else back on the
+// free list, without touching the contents of any item. used when restoring
+// a save state, which copies items back in at the same addresses they had
+// when it was taken. every item must have come from this pool.
+void SlabPool::SetLive(void * const *items, int count)
+{
+	void **sorted = (void **)malloc(MAX(count, 1) * sizeof(void *));
+	memcpy(sorted, items, count * sizeof(void *));
+	qsort(sorted, count, sizeof(void *), compare_ptrs);
+	
+	int headersize = ALIGN_UP(sizeof(Slab));
+	fFreeList = NULL;
+	fPooled = 0;
+	
+	for(Slab *slab=fSlabList;slab;slab=slab->next)
+	{
+		uint8_t *items = ((uint8_t *)slab + headersize);
+		
+		for(int i=fItemsPerSlab-1;i>=0;i--)
+		{
+			void *item = (items + (i * fItemSize));
+			if (bsearch(&item, sorted, count, sizeof(void *), compare_ptrs))
+				continue;
+			
+			FreeItem *fi = (FreeItem *)item;
+			fi->next = fFreeList;
+			fFreeList = fi;
+			fPooled++;
+		}
+	}
+	
+	fLive = count;
+	if (fLive > fHighWater)
+		fHighWater = fLive;
+	
+	free(sorted);
+}
+
+// allocate a new slab and thread all of it's items onto the free list
+bool SlabPool::AddSlab()
+{
+	int headersize = ALIGN_UP(sizeof(Slab));
+	uint8_t *mem = (uint8_t *)malloc(headersize + (fItemSize * fItemsPerSlab));
+	if (!mem)
+	{
+		staterr("SlabPool(%s): out of memory adding slab %d", fName, fSlabs + 1);
+		return 1;
+	}
+	
+	Slab *slab = (Slab *)mem;
+	slab->next = fSlabList;
+	fSlabList = slab;
+	fSlabs++;
+	
+	// link in reverse so that items come out in address order
+	uint8_t *items = (mem + headersize);
+	for(int i=fItemsPerSlab-1;i>=0;i--)
+	{
+		FreeItem *item = (FreeItem *)(items + (i * fItemSize));
+		item->next = fFreeList;
+		fFreeList = item;
+	}
+	
+	fPooled += fItemsPerSlab;
+	return 0;
+}
@@ -0,0 +1,55 @@
+
+#ifndef _SLABPOOL_H
+#define _SLABPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// fixed-size allocator for frequently created and destroyed items
+// (objects, floattext). items are carved out of larger slabs and kept on a
+// free list when released, so both Alloc and Release are O(1). memory
+// handed out by Alloc is always zero-filled. slabs are only returned to
+// the system when the pool itself is destroyed.
+class SlabPool
+{
+public:
+	SlabPool(const char *name, int itemsize, int items_per_slab);
+	~SlabPool();
+	
+	void *Alloc();
+	void Release(void *item);
+	
+	void SetLive(void * const *items, int count);
+	
+	const char *Name() const		{ return fName; }
+	int ItemSize() const			{ return fItemSize; }
+	
+	int CountLive() const			{ return fLive; }		// items currently handed out
+	int CountPooled() const			{ return fPooled; }		// items waiting on the free list
+	int HighWater() const			{ return fHighWater; }	// most items ever live at once
+	int CountSlabs() const			{ return fSlabs; }
+	
+	// all pools which exist, for reporting
+	static SlabPool *First()		{ return first; }
+	SlabPool *Next() const			{ return fNextPool; }
+	
+private:
+	bool AddSlab();
+	
+	struct FreeItem { FreeItem *next; };
+	struct Slab { Slab *next; };
+	
+	const char *fName;
+	int fItemSize;
+	int fItemsPerSlab;
+	
+	FreeItem *fFreeList;
+	Slab *fSlabList;
+	
+	int fLive, fPooled, fHighWater, fSlabs;
+	
+	SlabPool *fNextPool;
+	static SlabPool *first;
+};
+
+#endif
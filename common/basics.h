@@ -18,6 +18,13 @@
 
 typedef unsigned char		uchar;
 
+// a variable of which every thread has a copy of its own
+#ifdef _MSC_VER
+	#define NX_THREAD	__declspec(thread)
+#else
+	#define NX_THREAD	__thread
+#endif
+
 
 void stat(const char *fmt, ...);
 void staterr(const char *fmt, ...);
@@ -104,6 +104,48 @@ void write_U24(DBuffer *buffer, uint32_t data)
 void c------------------------------() {}
 */
 
+// variable-length unsigned ints: 7 bits to a byte, low bits first, with the
+// high bit set on every byte but the last. values under 128 take one byte.
+uint32_t read_UVarint(const uint8_t **data, const uint8_t *data_end)
+{
+uint32_t value = 0;
+int shift = 0;
+uint8_t byte;
+
+	do
+	{
+		if (*data > data_end)
+		{
+			staterr("read_UVarint: read past end of buffer: *data > data_end");
+			return 0;
+		}
+		
+		byte = *(*data)++;
+		if (shift < 32)
+			value |= (uint32_t)(byte & 0x7f) << shift;
+		
+		shift += 7;
+	}
+	while(byte & 0x80);
+	
+	return value;
+}
+
+void write_UVarint(DBuffer *buffer, uint32_t data)
+{
+	while(data >= 0x80)
+	{
+		buffer->Append8((data & 0x7f) | 0x80);
+		data >>= 7;
+	}
+	
+	buffer->Append8(data);
+}
+
+/*
+void c------------------------------() {}
+*/
+
 char read_char(const char **data, const char *data_end)
 {
 	return (char)read_U8((const uint8_t **)data, (const uint8_t *)data_end);
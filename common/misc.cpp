@@ -8,6 +8,7 @@
 #include <ctype.h>
 
 #include "basics.h"
+#include "misc.h"
 
 #include "../platform/platform.h"
 
@@ -134,6 +135,34 @@ void fputstringnonull(const char *buf, FILE *fp)
 		fprintf(fp, "%s", buf);
 }
 
+// write a string to a file as a quoted JSON string, escaping anything
+// which would end it early (such as the backslashes in a Windows path)
+void fputjsonstring(const char *buf, FILE *fp)
+{
+	fputc('"', fp);
+	
+	for(const unsigned char *p = (const unsigned char *)buf; *p; p++)
+	{
+		switch(*p)
+		{
+			case '"':  fputs("\\\"", fp); break;
+			case '\\': fputs("\\\\", fp); break;
+			case '\n': fputs("\\n", fp); break;
+			case '\r': fputs("\\r", fp); break;
+			case '\t': fputs("\\t", fp); break;
+			
+			default:
+				if (*p < 0x20)
+					fprintf(fp, "\\u%04x", *p);
+				else
+					fputc(*p, fp);
+			break;
+		}
+	}
+	
+	fputc('"', fp);
+}
+
 
 // reads strlen(str) bytes from file fp, and returns true if they match "str"
 bool fverifystring(FILE *fp, const char *str)
@@ -245,16 +274,20 @@ char *str = GetStaticStr();
 void c------------------------------() {}
 */
 
-static uint32_t seed = 0;
+// there are two streams of random numbers. the simulation's is seeded from
+// replays and save states and must come out the same every time. the
+// cosmetic one is for effects which only change what's drawn, so that
+// they can be skipped or reordered without upsetting the simulation.
+// replays recorded before the split share the simulation's stream for both.
+// the streams belong to the World, and randstate points at the current one's.
 
-uint32_t getrand()
+static inline uint32_t next_rand(uint32_t *s)
 {
-	seed = (seed * 0x343FD) + 0x269EC3;
-	return seed;
+	*s = (*s * 0x343FD) + 0x269EC3;
+	return *s;
 }
 
-// return a random number between min and max inclusive
-int random(int min, int max)
+static int rand_between(uint32_t *s, int min, int max)
 {
 int range, val;
 	
@@ -274,13 +307,57 @@ int range, val;
 		return 0;
 	}
 	
-	val = getrand() % (range + 1);
+	val = next_rand(s) % (range + 1);
 	return val + min;
 }
 
+uint32_t getrand()
+{
+	return next_rand(&randstate->seed);
+}
+
+// return a random number between min and max inclusive
+int random(int min, int max)
+{
+	return rand_between(&randstate->seed, min, max);
+}
+
 void seedrand(uint32_t newseed)
 {
-	seed = newseed;
+	randstate->seed = newseed;
+}
+
+// current state of the generator, for hashing the simulation state
+uint32_t getrandseed()
+{
+	return randstate->seed;
+}
+
+// as random(), from the cosmetic stream
+int fxrandom(int min, int max)
+{
+	return rand_between(randstate->fxshared ? &randstate->seed : &randstate->fxseed, min, max);
+}
+
+void seedfxrand(uint32_t newseed)
+{
+	randstate->fxseed = newseed;
+}
+
+uint32_t getfxrandseed()
+{
+	return randstate->fxseed;
+}
+
+// while set, fxrandom() draws from the simulation's stream like it used to
+void set_fxrand_shared(bool enable)
+{
+	randstate->fxshared = enable;
+}
+
+bool get_fxrand_shared()
+{
+	return randstate->fxshared;
 }
 
 /*
@@ -320,8 +397,8 @@ int i;
 
 char *GetStaticStr(void)
 {
-static int counter = 0;
-static struct
+static NX_THREAD int counter = 0;
+static NX_THREAD struct
 {
 	char str[1024];
 } bufs[24];
@@ -350,7 +427,7 @@ int len = strlen(src);
 void c------------------------------() {}
 */
 
-static int boolbyte, boolmask_r, boolmask_w;
+static NX_THREAD int boolbyte, boolmask_r, boolmask_w;
 
 // prepare for a boolean read operation
 void fresetboolean(void)
@@ -3,6 +3,18 @@
 #define COMMON_MISC_H__
 
 #include <cstdio>
+#include "basics.h"
+
+// the state of the random number generators. it is part of the World (see
+// world.h); random() and the rest use the one of the calling thread's world.
+struct RandState
+{
+	uint32_t seed;
+	uint32_t fxseed;
+	bool fxshared;
+};
+
+extern NX_THREAD RandState *randstate;
 
 uint16_t fgeti(FILE *fp);
 uint32_t fgetl(FILE *fp);
@@ -17,6 +29,7 @@ void fputfloat(double q, FILE *fp);
 void freadstring(FILE *fp, char *buf, int max);
 void fputstring(const char *buf, FILE *fp);
 void fputstringnonull(const char *buf, FILE *fp);
+void fputjsonstring(const char *buf, FILE *fp);
 bool fverifystring(FILE *fp, const char *str);
 void fgetcsv(FILE *fp, char *str, int maxlen);
 int fgeticsv(FILE *fp);
@@ -28,6 +41,12 @@ char *stprintf(const char *fmt, ...);
 int random(int min, int max);
 uint32_t getrand();
 void seedrand(uint32_t newseed);
+uint32_t getrandseed();
+int fxrandom(int min, int max);
+void seedfxrand(uint32_t newseed);
+uint32_t getfxrandseed();
+void set_fxrand_shared(bool enable);
+bool get_fxrand_shared();
 bool strbegin(const char *bigstr, const char *smallstr);
 bool strcasebegin(const char *bigstr, const char *smallstr);
 int count_string_list(const char *list[]);
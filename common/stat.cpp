@@ -9,7 +9,7 @@
 #include "../platform/platform.h"
 
 #define MAXBUFSIZE		1024
-char logfilename[64] = { 0 };
+NX_THREAD char logfilename[64] = { 0 };	// threads other than the main one log separately
 void writelog(const char *buf, bool append_cr);
 
 
@@ -28,5 +28,9 @@
 
 #define CONFIG_ORG_MUSIC_THREADED
 
+// build the old per-pixel movement loop alongside the swept one, and the
+// "sweepcheck" console command which compares the two.
+//#define CONFIG_SWEEP_CHECK
+
 
 #endif
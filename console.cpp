@@ -1,6 +1,13 @@
 
 #include "nx.h"
 #include <stdarg.h>
+#include "common/SlabPool.h"
+#include "profiler.h"
+#include "aicost.h"
+#include "scheduler.h"
+#include "graphics/drawqueue.h"
+#include "graphics/atlas.h"
+#include "mapcache.h"
 #include "console.fdh"
 
 
@@ -38,6 +45,29 @@ static CommandEntry commands[] =
 	"cre", __cre, 0, 0,
 	"reset", __reset, 0, 0,
 	"fps", __fps, 0, 1,
+	"pools", __pools, 0, 1,
+	"cullstress", __cullstress, 0, 1,
+	"mapbench", __mapbench, 0, 1,
+#ifdef CONFIG_SWEEP_CHECK
+	"sweepcheck", __sweepcheck, 0, 1,
+#endif
+	"hashevery", __hashevery, 0, 1,
+	"seek", __seek, 1, 1,
+	"keyframes", __keyframes, 0, 1,
+	"rewind", __rewind, 0, 1,
+	"rewindevery", __rewindevery, 0, 1,
+	"savestate", __savestate, 0, 1,
+	"loadstate", __loadstate, 0, 1,
+	"replayinfo", __replayinfo, 1, 1,
+	"convertrep", __convertrep, 2, 2,
+	"prof", __prof, 0, 0,
+	"profcsv", __profcsv, 0, 1,
+	"trace", __trace, 0, 2,
+	"sched", __sched, 0, 2,
+	"drawqueue", __drawqueue, 0, 1,
+	"atlas", __atlas, 0, 1,
+	"mapcache", __mapcache, 0, 1,
+	"aicost", __aicost, 0, 1,
 
 	"map", __map, 1, 2,
 	"posx", __posx, 1, 1,
@@ -880,6 +910,472 @@ extern int fps;
 	fps = 0;
 }
 
+// show allocation counters for the object/floattext slab pools.
+// every pool goes to the log; the console line shows the last one,
+// or just the one named in the argument.
+static void __pools(StringList *args, int num)
+{
+	const char *name = (args->CountItems() > 0) ? args->StringAt(0) : NULL;
+	bool found = false;
+	
+	for(SlabPool *pool = SlabPool::First(); pool; pool = pool->Next())
+	{
+		if (name && strcasecmp(name, pool->Name()))
+			continue;
+		
+		Respond("%s: %d live, %d pooled, %d peak", pool->Name(), \
+			pool->CountLive(), pool->CountPooled(), pool->HighWater());
+		found = true;
+	}
+	
+	if (!found)
+		Respond("No such pool '%s'", name ? name : "");
+}
+
+// stress test for Object::Destroy: time Objects::CullDeleted on batches of
+// deleted objects, each one linked to the one before it, doubling the batch
+// size up to the given maximum. the cost per object should stay flat.
+static void __cullstress(StringList *args, int num)
+{
+	int max = (args->CountItems() > 0) ? num : 1024;
+	double us_per_count = (1000000.0 / (double)SDL_GetPerformanceFrequency());
+	
+	for(int count=64;count<=max;count*=2)
+	{
+		Object *link = NULL;
+		
+		for(int i=0;i<count;i++)
+		{
+			Object *o = CreateObject(0, 0, OBJ_NULL, 0, 0, RIGHT, link, CF_NO_SPAWN_EVENT);
+			o->deleted = true;
+			link = o;
+		}
+		
+		uint64_t start = SDL_GetPerformanceCounter();
+		Objects::CullDeleted();
+		double us = (double)(SDL_GetPerformanceCounter() - start) * us_per_count;
+		
+		Respond("cull %d: %.0f us, %.3f us/obj", count, us, us / count);
+	}
+}
+
+// show the world-state hash as of the last tick, or set how many frames apart
+// new replay recordings store a checkpoint of it (0 = never).
+static void __hashevery(StringList *args, int num)
+{
+	if (args->CountItems() > 0)
+		Replay::SetHashInterval(num);
+	
+	Respond("world hash %08x; checkpoint every %d frames", \
+		Replay::WorldHash(), Replay::GetHashInterval());
+}
+
+// jump replay playback to the given frame
+static void __seek(StringList *args, int num)
+{
+	if (!Replay::IsPlaying())
+	{
+		Respond("no replay is playing");
+		return;
+	}
+	
+	int from;
+	bool unbounded;
+	
+	if (Replay::Seek(num, &from, &unbounded))
+	{
+		Respond("can't seek to frame %d", num);
+		return;
+	}
+	
+	// keyframes are only taken as playback passes them
+	if (unbounded)
+		Respond("seek to %d: past the furthest frame played; re-simulating all %d frames from %d", num, num - from, from);
+	else
+		Respond("seek to %d: fast-forwarding %d frames from %d", num, num - from, from);
+}
+
+// show the keyframes held for the current playback, or set
+// how many frames apart they're taken (0 = never).
+static void __keyframes(StringList *args, int num)
+{
+	int bytes;
+	
+	if (args->CountItems() > 0)
+		Replay::SetKeyframeInterval(num);
+	
+	int count = Replay::CountKeyframes(&bytes);
+	Respond("%d keyframes, %d KB; every %d frames", count, bytes / 1024, Replay::GetKeyframeInterval());
+}
+
+// step the game back through the rewind ring
+static void __rewind(StringList *args, int num)
+{
+	int steps = (args->CountItems() > 0) ? num : 1;
+	
+	if (Replay::IsPlaying())
+	{
+		Respond("use seek during playback");
+		return;
+	}
+	
+	if (Rewind::StepBack(steps))
+		Respond("can't rewind %d steps", steps);
+	else
+		Respond("rewound %d frames", steps * Rewind::GetInterval());
+}
+
+// show the rewind ring, or set how many frames apart it takes states (0 = never)
+static void __rewindevery(StringList *args, int num)
+{
+	int bytes;
+	
+	if (args->CountItems() > 0)
+		Rewind::SetInterval(num);
+	
+	int count = Rewind::CountStates(&bytes);
+	Respond("%d/%d states, %d KB; every %d frames", count, REWIND_SLOTS, \
+			bytes / 1024, Rewind::GetInterval());
+}
+
+// quick save-state slots, for going back to the same spot over and over
+#define NUM_QUICKSTATES		4
+static SaveState quickstates[NUM_QUICKSTATES];
+
+static void __savestate(StringList *args, int num)
+{
+	int slot = (args->CountItems() > 0) ? num : 0;
+	if (slot < 0 || slot >= NUM_QUICKSTATES)
+	{
+		Respond("slot must be 0-%d", NUM_QUICKSTATES - 1);
+		return;
+	}
+	
+	uint64_t start = SDL_GetPerformanceCounter();
+	if (quickstates[slot].Capture())
+	{
+		Respond("can't save state here");
+		return;
+	}
+	
+	double us = (double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	Respond("saved state %d: %d KB in %.0f us", slot, quickstates[slot].Size() / 1024, us);
+}
+
+static void __loadstate(StringList *args, int num)
+{
+	int slot = (args->CountItems() > 0) ? num : 0;
+	if (slot < 0 || slot >= NUM_QUICKSTATES || !quickstates[slot].IsValid())
+	{
+		Respond("no state in slot %d", slot);
+		return;
+	}
+	
+	if (Replay::IsPlaying())
+	{
+		Respond("can't load a state during playback");
+		return;
+	}
+	
+	if (Replay::IsRecording())
+		Replay::end_record();
+	
+	uint64_t start = SDL_GetPerformanceCounter();
+	if (quickstates[slot].Restore())
+	{
+		Respond("failed to load state %d", slot);
+		return;
+	}
+	
+	double us = (double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	Respond("loaded state %d in %.0f us", slot, us);
+}
+
+// read through a replay file and report what's in it, and how long it took
+static void __replayinfo(StringList *args, int num)
+{
+	ReplayFileInfo info;
+	
+	uint64_t start = SDL_GetPerformanceCounter();
+	if (Replay::Scan(args->StringAt(0), &info))
+	{
+		Respond("can't read replay '%s'", args->StringAt(0));
+		return;
+	}
+	
+	double us = (double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	Respond("v%d: %d frames, %d runs, %d checkpoints", info.version, info.frames, info.records, info.checkpoints);
+	Respond("%d bytes%s, %d index entries; read in %.0f us", info.size, \
+			info.mapped ? " (mapped)" : "", info.index_entries, us);
+}
+
+// rewrite a replay file in the current format
+static void __convertrep(StringList *args, int num)
+{
+	if (Replay::Convert(args->StringAt(0), args->StringAt(1)))
+		Respond("conversion failed");
+	else
+		Respond("ok");
+}
+
+// toggle the profiler overlay
+static void __prof(StringList *args, int num)
+{
+	Profiler::SetOverlay(!Profiler::OverlayVisible());
+}
+
+// start writing per-frame profiler times to the given file, or stop
+static void __profcsv(StringList *args, int num)
+{
+	if (args->CountItems() > 0)
+	{
+		if (Profiler::StartCSV(args->StringAt(0)))
+			Respond("can't write to '%s'", args->StringAt(0));
+	}
+	else if (Profiler::IsWritingCSV())
+	{
+		Profiler::StopCSV();
+		Respond("profiler csv closed");
+	}
+}
+
+// record a timeline of the next n frames to the given file, or end it early
+static void __trace(StringList *args, int num)
+{
+	if (args->CountItems() > 0)
+	{
+		int frames = (args->CountItems() > 1) ? atoi(args->StringAt(1)) : TRACE_DEFAULT_FRAMES;
+		
+		if (Profiler::StartTrace(args->StringAt(0), frames))
+			Respond("can't start a trace to '%s'", args->StringAt(0));
+	}
+	else if (Profiler::IsTracing())
+	{
+		Profiler::StopTrace();
+		Respond("trace stopped");
+	}
+}
+
+// show how evenly ticks have been paced, clear the figures, change what's
+// done about late ticks, or how long before each one to spin.
+static void __sched(StringList *args, int num)
+{
+SchedPolicy policy;
+
+	if (args->CountItems() > 0)
+	{
+		const char *arg = args->StringAt(0);
+		
+		if (!strcasecmp(arg, "reset"))
+		{
+			Scheduler::ResetStats();
+			Respond("scheduler stats cleared");
+		}
+		else if (!strcasecmp(arg, "spin") && args->CountItems() > 1)
+		{
+			Scheduler::SetSpin(atoi(args->StringAt(1)));
+			Respond("spinning for the last %d us before each tick", Scheduler::GetSpin());
+		}
+		else if (!Scheduler::ParsePolicy(arg, &policy))
+		{
+			Scheduler::SetPolicy(policy);
+			Respond("late ticks: %s", Scheduler::PolicyName(policy));
+		}
+		else
+		{
+			Respond("expected catchup, drop, reset or spin <us>");
+		}
+		
+		return;
+	}
+	
+	const SchedHistogram *hists[] = { Scheduler::Jitter(), Scheduler::Interval() };
+	for(int i=0;i<2;i++)
+	{
+		const SchedHistogram *h = hists[i];
+		Respond("%s: mean %.2f sd %.2f p99 %.2f max %.2f ms", h->name, \
+			h->Mean() / 1000.0, h->StdDev() / 1000.0, h->Percentile(99) / 1000.0, h->max / 1000.0);
+	}
+	
+	Respond("%d ticks, %d dropped (%s, spin %d us)", Scheduler::Jitter()->count, \
+		Scheduler::CountDropped(), Scheduler::PolicyName(Scheduler::GetPolicy()), Scheduler::GetSpin());
+}
+
+// turn the draw queue on or off, or show what it did with the last frame
+static void __drawqueue(StringList *args, int num)
+{
+	if (args->CountItems() > 0)
+		DrawQueue::SetEnabled(num != 0);
+	
+	const DrawQueueStats *st = DrawQueue::LastFrame();
+	Respond("draw queue %s: %d commands -> %d draw calls (%d batches, %d target switches)", \
+		DrawQueue::IsEnabled() ? "on" : "off", st->commands, st->draw_calls, \
+		st->batches, st->target_switches);
+}
+
+// turn packing the spritesheets into the atlas on or off, or show how full it is
+static void __atlas(StringList *args, int num)
+{
+AtlasStats st;
+
+	if (args->CountItems() > 0)
+	{
+		Atlas::SetEnabled(num != 0);
+		Sprites::FlushSheets();		// they'll be reloaded, into the atlas or not, as they're used
+	}
+	
+	Atlas::GetStats(&st);
+	int total = (st.pages * st.size * st.size);
+	
+	Respond("atlas %s: %d sheets on %d pages of %dx%d, %d%% used", \
+		Atlas::IsEnabled() ? "on" : "off", st.images, st.pages, st.size, st.size, \
+		total ? (int)(((int64_t)st.used * 100) / total) : 0);
+	Respond("last frame: %d texture switches", DrawQueue::LastFrame()->texture_switches);
+}
+
+// turn drawing the map from pre-rendered chunks on or off, or show what's cached
+static void __mapcache(StringList *args, int num)
+{
+MapCacheStats st;
+
+	if (args->CountItems() > 0)
+		MapCache::SetEnabled(num != 0);
+	
+	MapCache::GetStats(&st);
+	Respond("map cache %s: %d/%d chunks cached, %d rendered since stage load, %d drawn last frame", \
+		MapCache::IsEnabled() ? "on" : "off", st.chunks, MAPCACHE_MAX_CHUNKS, st.renders, st.composited);
+}
+
+// turn AI cost accounting on or off, or show the n object
+// types whose AI has taken the most time since it was turned on.
+static void __aicost(StringList *args, int num)
+{
+	if (args->CountItems() == 0)
+	{
+		AICost::SetEnabled(!AICost::enabled);
+		Respond("AI cost accounting %s", AICost::enabled ? "on" : "off");
+		return;
+	}
+	
+	if (!AICost::enabled)
+	{
+		AICost::SetEnabled(true);
+		Respond("AI cost accounting on");
+		return;
+	}
+	
+	AICostEntry top[20];
+	if (num < 1) num = 1;
+	if (num > 20) num = 20;
+	
+	int count = AICost::GetTop(top, num);
+	for(int i=0;i<count;i++)
+	{
+		stat("aicost: %-32s %10.0f us (%.0f inclusive)  ontick %d/%.0f  aftermove %d/%.0f  onspawn %d/%.0f  ondeath %d/%.0f", \
+			AICost::TypeName(top[i].type), top[i].total_us, top[i].inclusive_us, \
+			top[i].calls[AIR_ONTICK], top[i].us[AIR_ONTICK], \
+			top[i].calls[AIR_AFTERMOVE], top[i].us[AIR_AFTERMOVE], \
+			top[i].calls[AIR_ONSPAWN], top[i].us[AIR_ONSPAWN], \
+			top[i].calls[AIR_ONDEATH], top[i].us[AIR_ONDEATH]);
+		
+		Respond("%s: %.1f ms in %d ticks", AICost::TypeName(top[i].type), \
+				top[i].total_us / 1000.0, top[i].calls[AIR_ONTICK]);
+	}
+}
+
+// microbenchmark for the map tile storage: times drawing both map layers,
+// and Object::GetAttributes with the player's blockpoints swept across
+// every tile of the current stage.
+static void __mapbench(StringList *args, int num)
+{
+	int iterations = (args->CountItems() > 0) ? num : 100;
+	double us_per_count = (1000000.0 / (double)SDL_GetPerformanceFrequency());
+	uint64_t start;
+	int i, x, y;
+	
+	if (!player || !map.xsize || !map.ysize)
+	{
+		Respond("no stage loaded");
+		return;
+	}
+	
+	start = SDL_GetPerformanceCounter();
+	for(i=0;i<iterations;i++)
+	{
+		map_draw(0);
+		map_draw(TA_FOREGROUND);
+	}
+	
+	double drawus = (double)(SDL_GetPerformanceCounter() - start) * us_per_count;
+	Respond("map_draw: %.1f us/frame", drawus / iterations);
+	
+	int oldx = player->x;
+	int oldy = player->y;
+	SIFSprite *spr = player->Sprite();
+	int calls = 0;
+	
+	start = SDL_GetPerformanceCounter();
+	for(i=0;i<iterations;i++)
+	{
+		for(y=0;y<map.ysize;y++)
+		for(x=0;x<map.xsize;x++)
+		{
+			player->x = MAPX(x);
+			player->y = MAPY(y);
+			
+			player->GetAttributes(&spr->block_l);
+			player->GetAttributes(&spr->block_r);
+			player->GetAttributes(&spr->block_u);
+			player->GetAttributes(&spr->block_d);
+			calls += 4;
+		}
+	}
+	
+	double attrus = (double)(SDL_GetPerformanceCounter() - start) * us_per_count;
+	
+	player->x = oldx;
+	player->y = oldy;
+	
+	Respond("GetAttributes: %.3f us/call", attrus / calls);
+}
+
+#ifdef CONFIG_SWEEP_CHECK
+// checks the swept object movement against the old pixel-by-pixel loop, with
+// the sprite of every kind of object on the stage, moved from random spots.
+// see sweep_check in object.cpp.
+static void __sweepcheck(StringList *args, int num)
+{
+	int trials = (args->CountItems() > 0) ? num : 10000;
+	bool checked[MAX_SPRITES];
+	int nsprites = 0, failures = 0;
+	Object *o;
+	
+	if (!player || !map.xsize || !map.ysize)
+	{
+		Respond("no stage loaded");
+		return;
+	}
+	
+	memset(checked, 0, sizeof(checked));
+	Object *scratch = CreateObject(0, 0, OBJ_NULL, 0, 0, RIGHT, NULL, CF_NO_SPAWN_EVENT);
+	
+	FOREACH_OBJECT(o)
+	{
+		if (o == scratch || checked[o->sprite])
+			continue;
+		
+		checked[o->sprite] = true;
+		scratch->sprite = o->sprite;
+		failures += sweep_check(scratch, trials);
+		nsprites++;
+	}
+	
+	scratch->Delete();
+	
+	Respond("sweepcheck: %d sprites, %d moves each: %d differed", nsprites, trials, failures);
+}
+#endif
+
 /*
 void c------------------------------() {}
 */
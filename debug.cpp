@@ -7,15 +7,15 @@
 #include "debug.fdh"
 
 #define MAX_DEBUG_MARKS		80
-static struct
+static NX_THREAD struct
 {
 	int x, y, x2, y2;
 	char type;
 	uchar r, g, b;
 } debugmarks[MAX_DEBUG_MARKS];
 
-static int ndebugmarks = 0;
-static StringList DebugList;
+static NX_THREAD int ndebugmarks = 0;
+static StringList DebugList;		// only kept for frames which are shown
 
 
 void DrawDebug(void)
@@ -167,6 +167,9 @@ void debug(const char *fmt, ...)
 char buffer[128];
 va_list ar;
 
+	if (!present_frame)
+		return;
+	
 	va_start(ar, fmt);
 	vsnprintf(buffer, sizeof(buffer), fmt, ar);
 	va_end(ar);
@@ -7,7 +7,7 @@
 #define SCREEN_Y(Y)		( (Y) - (scroll_y >> CSF) )
 #define TEXT_SPACING	5	// X-spacing between letters
 	
-Credits *credits = NULL;
+NX_THREAD Credits *credits = NULL;
 
 /*
 void c------------------------------() {}
@@ -70,8 +70,8 @@ void Credits::Tick()
 	}
 	
 	game_tick_normal();
-	bigimage.Draw();
-	Draw();
+	bigimage.Run();
+	RunLines();
 }
 
 
@@ -179,11 +179,30 @@ bool tried_rewind = false;
 void c------------------------------() {}
 */
 
-bool Credits::DrawLine(CredLine *line)
+// deletes the lines which have scrolled off the top
+void Credits::RunLines()
+{
+CredLine *line, *next;
+
+	line = firstline;
+	while(line)
+	{
+		next = line->next;
+		
+		if (SCREEN_Y(line->y) < -MARGIN)
+		{
+			RemoveLine(line);
+			delete line;
+		}
+		
+		line = next;
+	}
+}
+
+void Credits::DrawLine(CredLine *line)
 {
 	int x = line->x;
 	int y = SCREEN_Y(line->y);
-	if (y < -MARGIN) return true;	// line can be deleted now
 	
 	if (line->image)
 	{
@@ -194,28 +213,16 @@ bool Credits::DrawLine(CredLine *line)
 	//int font_draw(int x, int y, const char *string, int font_spacing)
 	//DrawRect(x, y, x+63, y+8, 128, 0, 0);
 	font_draw(x, y, line->text, TEXT_SPACING);
-	
-	return false;
 }
 
 
 void Credits::Draw()
 {
-CredLine *line, *next;
-
-	line = firstline;
-	while(line)
-	{
-		next = line->next;
-		
-		if (DrawLine(line))
-		{
-			RemoveLine(line);
-			delete line;
-		}
-		
-		line = next;
-	}
+	game_draw_normal();
+	bigimage.Draw();
+	
+	for(CredLine *line = firstline; line; line = line->next)
+		DrawLine(line);
 }
 
 /*
@@ -327,7 +334,7 @@ void BigImage::Clear()
 	state = BI_SLIDE_OUT;
 }
 
-void BigImage::Draw()
+void BigImage::Run()
 {
 	#define IMAGE_SPEED		32
 	
@@ -351,7 +358,10 @@ void BigImage::Draw()
 				state = BI_CLEAR;
 		}
 	}
-	
+}
+
+void BigImage::Draw()
+{
 	// take up any unused space with blue
 	if (state != BI_HOLD)
 		FillRect(0, 0, Graphics::SCREEN_WIDTH/2, Graphics::SCREEN_HEIGHT, DK_BLUE);
@@ -389,6 +399,12 @@ void credit_tick()
 		credits->Tick();
 }
 
+void credit_draw()
+{
+	if (credits)
+		credits->Draw();
+}
+
 void credit_set_image(int imgno)
 {
 	if (credits)
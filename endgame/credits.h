@@ -24,6 +24,7 @@ public:
 	
 	void Set(int num);
 	void Clear();
+	void Run();
 	void Draw();
 	
 private:
@@ -38,6 +39,7 @@ class Credits
 public:
 	bool Init();
 	void Tick();
+	void Draw();
 	~Credits();
 	
 	BigImage bigimage;	// current "SIL" big left-hand image
@@ -50,8 +52,8 @@ private:
 	CredLine *AddLine(CredLine *line);
 	void RemoveLine(CredLine *line);
 	
-	void Draw();
-	bool DrawLine(CredLine *line);
+	void RunLines();
+	void DrawLine(CredLine *line);
 	
 	
 	int spawn_y;		// position of next line relative to top of roll
@@ -73,6 +75,7 @@ private:
 
 bool credit_init(int parameter);
 void credit_tick();
+void credit_draw();
 void credit_set_image(int imgno);
 void credit_clear_image();
 void credit_close();
@@ -4,7 +4,7 @@
 #include "../nx.h"
 #include "island.fdh"
 
-static struct
+static NX_THREAD struct
 {
 	int x, y;
 	int timer, scene_length;
@@ -61,8 +61,10 @@ void island_tick()
 	
 	island.y += island.speed;
 	island.timer++;
-	
-	// draw the scene
+}
+
+void island_draw()
+{
 	ClearScreen(BLACK);
 	
 	set_clip_rect(island.scene_x, island.scene_y, \
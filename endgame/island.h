@@ -4,6 +4,7 @@
 
 bool island_init(int survives);
 void island_tick();
+void island_draw();
 
 
 #endif
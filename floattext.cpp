@@ -1,9 +1,16 @@
 
+#include <vector>
+
 #include "nx.h"
+#include "common/SlabPool.h"
+#include "profiler.h"
 #include "floattext.fdh"
 
-FloatText *FloatText::first = NULL;
-FloatText *FloatText::last = NULL;
+// the list belongs to the World. every object gets one of these, so
+// they're pooled along with the objects.
+#define first			(world->fFirstFloatText)
+#define last			(world->fLastFloatText)
+#define floattextpool	(world->fFloatTextPool)
 
 /*
 void c------------------------------() {}
@@ -35,6 +42,19 @@ FloatText::~FloatText()
 	if (this == last) last = last->prev;
 }
 
+void *FloatText::operator new(size_t size)
+{
+	void *mem = floattextpool.Alloc();
+	ASSERT(mem);
+	
+	return mem;
+}
+
+void FloatText::operator delete(void *ptr)
+{
+	floattextpool.Release(ptr);
+}
+
 void FloatText::Reset()
 {
 	this->state = FT_IDLE;
@@ -95,10 +115,9 @@ void FloatText::UpdatePos(Object *assoc_object)
 
 
 // moves and draws the given float text if need be
-void FloatText::Draw()
+void FloatText::Run()
 {
 FloatText *ft = this;
-int x, y, i;
 
 	switch(ft->state)
 	{
@@ -133,12 +152,17 @@ int x, y, i;
 				ft->state = FT_IDLE;
 				ft->shownAmount = 0;
 				ft->timer = 0;
-				return;
 			}
 		}
 		break;
 	}
-	
+}
+
+void FloatText::Draw()
+{
+FloatText *ft = this;
+int x, y, i;
+
 	// set the SDL clipping region to just above the hold point
 	// so it looks like it "rolls" away.
 	if (ft->state == FT_SCROLL_AWAY)
@@ -182,11 +206,10 @@ bool FloatText::IsScrollingAway()
 void c------------------------------() {}
 */
 
-void FloatText::DrawAll(void)
+void FloatText::RunAll(void)
 {
 	FloatText *ft = first;
 	FloatText *nextft;
-	int count = 0;
 	
 	while(ft)
 	{
@@ -194,7 +217,7 @@ void FloatText::DrawAll(void)
 		
 		if (ft->state != FT_IDLE)
 		{
-			ft->Draw();
+			ft->Run();
 		}
 		else
 		{
@@ -203,7 +226,17 @@ void FloatText::DrawAll(void)
 		}
 		
 		ft = nextft;
-		count++;
+	}
+}
+
+void FloatText::DrawAll(void)
+{
+	PROFILE_SCOPE("FloatText::DrawAll");
+	
+	for(FloatText *ft = first; ft; ft = ft->next)
+	{
+		if (ft->state != FT_IDLE)
+			ft->Draw();
 	}
 }
 
@@ -227,5 +260,71 @@ void FloatText::ResetAll(void)
 	}
 }
 
+/*
+void c------------------------------() {}
+*/
+
+// floattexts are put back at the same addresses, the way objects are
+// (see Objects::SaveState). they have no vtable, so only the members are
+// saved, one by one.
+void FloatText::SaveState(DBuffer *out)
+{
+FloatText *ft;
+int count = 0;
+
+	for(ft=first;ft;ft=ft->next)
+		count++;
+	
+	SS_PUT(out, count);
+	for(ft=first;ft;ft=ft->next)
+	{
+		SS_PUT(out, ft);
+		SS_PUT(out, ft->ObjectDestroyed);
+		SS_PUT(out, ft->state);
+		SS_PUT(out, ft->yoff);
+		SS_PUT(out, ft->shownAmount);
+		SS_PUT(out, ft->sprite);
+		SS_PUT(out, ft->timer);
+		SS_PUT(out, ft->cliprect);
+		SS_PUT(out, ft->objX);
+		SS_PUT(out, ft->objY);
+		SS_PUT(out, ft->next);
+		SS_PUT(out, ft->prev);
+	}
+	
+	SS_PUT(out, first);
+	SS_PUT(out, last);
+}
+
+void FloatText::LoadState(const uint8_t **in)
+{
+std::vector<void *> items;
+FloatText *ft;
+int count, i;
+
+	SS_GET(in, count);
+	for(i=0;i<count;i++)
+	{
+		SS_GET(in, ft);
+		SS_GET(in, ft->ObjectDestroyed);
+		SS_GET(in, ft->state);
+		SS_GET(in, ft->yoff);
+		SS_GET(in, ft->shownAmount);
+		SS_GET(in, ft->sprite);
+		SS_GET(in, ft->timer);
+		SS_GET(in, ft->cliprect);
+		SS_GET(in, ft->objX);
+		SS_GET(in, ft->objY);
+		SS_GET(in, ft->next);
+		SS_GET(in, ft->prev);
+		items.push_back(ft);
+	}
+	
+	floattextpool.SetLive(items.empty() ? NULL : &items[0], items.size());
+	
+	SS_GET(in, first);
+	SS_GET(in, last);
+}
+
 
 
@@ -19,6 +19,9 @@ class FloatText
 public:
 	FloatText(int sprite);
 	~FloatText();
+	
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr);
 	void Reset();
 	
 	void AddQty(int amt);
@@ -26,13 +29,18 @@ public:
 	
 	void UpdatePos(Object *assoc_object);
 	
+	static void RunAll();
 	static void DrawAll();
 	static void DeleteAll();
 	static void ResetAll(void);
 	
+	static void SaveState(DBuffer *out);
+	static void LoadState(const uint8_t **in);
+	
 	bool ObjectDestroyed;
 
 private:
+	void Run();
 	void Draw();
 	
 	uint8_t state;
@@ -47,7 +55,6 @@ private:
 	
 	
 	FloatText *next, *prev;
-	static FloatText *first, *last;
 };
 
 
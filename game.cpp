@@ -12,43 +12,44 @@
 #include "profile.h"
 #include "game.fdh"
 #include "vjoy.h"
+#include "bench.h"
+#include "profiler.h"
 
+// OnTick advances the mode by one tick, and OnDraw draws the result. OnDraw
+// is skipped when the frame isn't going to be shown (fast-forward, headless),
+// so it mustn't change anything the simulation depends on.
 static struct TickFunctions
 {
 	void (*OnTick)(void);
+	void (*OnDraw)(void);
 	bool (*OnEnter)(int param);
 	void (*OnExit)(void);
 }
 tickfunctions[] =
 {
-	NULL,				NULL,			NULL,			// GM_NONE
-	game_tick_normal,	NULL,			NULL,			// GM_NORMAL
-	inventory_tick,		inventory_init,	NULL,			// GM_INVENTORY
-	ms_tick,			ms_init,		ms_close,		// GM_MAP_SYSTEM
-	island_tick,		island_init,	NULL,			// GM_ISLAND
-	credit_tick,		credit_init,	credit_close,	// GM_CREDITS
-	intro_tick,			intro_init,		NULL,			// GM_INTRO
-	title_tick,			title_init,		NULL,			// GM_TITLE
-	pause_tick,			pause_init,		NULL,			// GP_PAUSED
-	options_tick,		options_init,	options_close	// GP_OPTIONS
+	NULL,				NULL,				NULL,			NULL,			// GM_NONE
+	game_tick_normal,	game_draw_normal,	NULL,			NULL,			// GM_NORMAL
+	inventory_tick,		inventory_draw,		inventory_init,	NULL,			// GM_INVENTORY
+	ms_tick,			ms_draw,			ms_init,		ms_close,		// GM_MAP_SYSTEM
+	island_tick,		island_draw,		island_init,	NULL,			// GM_ISLAND
+	credit_tick,		credit_draw,		credit_init,	credit_close,	// GM_CREDITS
+	intro_tick,			intro_draw,			intro_init,		NULL,			// GM_INTRO
+	title_tick,			title_draw,			title_init,		NULL,			// GM_TITLE
+	pause_tick,			pause_draw,			pause_init,		NULL,			// GP_PAUSED
+	options_tick,		options_draw,		options_init,	options_close	// GP_OPTIONS
 	//old_options_tick,		old_options_init,	old_options_close	// GP_OPTIONS
 };
 
-Object *onscreen_objects[MAX_OBJECTS];
-int nOnscreenObjects;
-
-Game game;
-TextBox textbox;
 DebugConsole console;
 ObjProp objprop[OBJ_LAST];
 
-// init Game object: only called once during startup
+// set up what all worlds share: only called once during startup.
+// the Game object itself starts out zeroed along with the rest of the World,
+// and gets its player in world_init.
 bool Game::init()
 {
 int i;
 
-	memset(&game, 0, sizeof(game));
-	
 	// set default properties
 	memset(objprop, 0, sizeof(objprop));
 	for(i=0;i<OBJ_LAST;i++)
@@ -69,9 +70,6 @@ int i;
 	if (initslopetable()) return 1;
 	if (initmapfirsttime()) return 1;
 	
-	// create the player object--note that the player is NOT destroyed on map change
-	if (game.createplayer()) return 1;
-	
 	return 0;
 }
 
@@ -210,28 +208,45 @@ void Game::tick(void)
 {
 	if (game.paused)
 	{
-		tickfunctions[game.paused].OnTick();
+		int paused = game.paused;
+		tickfunctions[paused].OnTick();
+		
+		if (present_frame)
+			tickfunctions[paused].OnDraw();
 	}
 	else
 	{
-		// record/playback replays
+		// take rewind states, then record/playback replays
+		Rewind::Tick();
 		Replay::run();
 		
 		// run scripts
 		RunScripts();
 		
-		// call the tick function for the current game mode
-		tickfunctions[game.mode].OnTick();
+		// call the tick function for the current game mode. the frame is
+		// drawn by the mode which ran the tick, even if it's just switched away.
+		int mode = game.mode;
+		tickfunctions[mode].OnTick();
+		
+		if (present_frame && tickfunctions[mode].OnDraw)
+			tickfunctions[mode].OnDraw();
+		
+		Bench::TickEnd();
 	}
 	
     //::debug("mode %d,%d", game.mode, game.paused);
     
 	DrawDebug();
 	
-	debug_clear();
-	//debug_timer_begin();
-
-	console.Draw();
+	// the console is the main thread's, so Batch's workers (which never
+	// show a frame) mustn't touch it
+	if (present_frame)
+	{
+		debug_clear();
+		//debug_timer_begin();
+		
+		console.Draw();
+	}
 }
 
 
@@ -276,19 +291,28 @@ void game_tick_normal(void)
 {
 Object *o;
 
+	PROFILE_SCOPE("game_tick_normal");
+	
+	Bench::TickBegin();
+	
 	player->riding = NULL;
 	player->bopped_object = NULL;
 	Objects::UpdateBlockStates();
 
 	if (!game.frozen)
 	{
+		Bench::Mark(BP_OTHER);
+		
 		// run AI for player and stageboss first
 		HandlePlayer();
+		Bench::Mark(BP_HANDLEPLAYER);
 		game.stageboss.Run();
 		
 		// now objects AI and move all objects to their new positions
 		Objects::RunAI();
+		Bench::Mark(BP_RUNAI);
 		Objects::PhysicsSim();
+		Bench::Mark(BP_PHYSICSSIM);
 		
 		// run the "aftermove" AI routines
 		HandlePlayer_am();
@@ -299,23 +323,56 @@ Object *o;
 			if (!o->deleted)
 				o->OnAftermove();
 		}
+		Bench::Mark(BP_AFTERMOVE);
 	}
 
-	// important to put this before and not after DrawScene(), or non-existant objects
+	// important to put this before and not after RunScene(), or non-existant objects
 	// can wind up in the onscreen_objects[] array, and blow up the program on the next tick.
+	Bench::Mark(BP_OTHER);
 	Objects::CullDeleted();
+	Bench::Mark(BP_CULLDELETED);
+	
+	// the tick's world-state hash, for replay checkpoints
+	Replay::UpdateTickHash();
 	
 	map_scroll_do();
+	Bench::Mark(BP_OTHER);
 	
+	RunScene();
+	Bench::Mark(BP_DRAWSCENE);
+	RunStatusBar();
+	Bench::Mark(BP_DRAWSTATUSBAR);
+	world->fFade.Run();
+	niku_run();
+	
+	Bench::Mark(BP_OTHER);
+	textbox.Run();
+	Bench::Mark(BP_TEXTBOX);
+	
+	ScreenEffects::Run();
+	
+	if (game.showmapnametime)
+		game.showmapnametime--;
+}
+
+// draws the frame for game_tick_normal
+void game_draw_normal(void)
+{
+	PROFILE_SCOPE("game_draw_normal");
+	
+	Bench::Mark(BP_OTHER);
 	DrawScene();
+	Bench::Mark(BP_DRAWSCENE);
 	DrawStatusBar();
-	fade.Draw();
+	Bench::Mark(BP_DRAWSTATUSBAR);
+	world->fFade.Draw();
 	
-	niku_run();
 	if (player->equipmask & EQUIP_NIKUMARU)
 		niku_draw(game.counter);
 	
+	Bench::Mark(BP_OTHER);
 	textbox.Draw();
+	Bench::Mark(BP_TEXTBOX);
 	
 	ScreenEffects::Draw();
 	map_draw_map_name();	// stage name overlay as on entry
@@ -348,31 +405,28 @@ void megaquake(int quaketime, int snd)
 }
 
 
-void DrawScene(void)
+// the parts of the scene which move along by themselves rather than being
+// run by AI: damage shaking, floattext, carets, motion tiles, and which
+// objects are onscreen (which some AI looks at). this used to be done while
+// drawing, and still runs in the same modes DrawScene is used in.
+void RunScene(void)
 {
 int scr_x, scr_y;
-extern int flipacceltime;
+
+	PROFILE_SCOPE("RunScene");
 	
 	// sporidically-used animated tile feature,
 	// e.g. water currents in Waterway
 	if (map.nmotiontiles)
 		AnimateMotionTiles();
 	
-	// draw background map tiles
-	if (!flipacceltime)
-	{
-		map_draw_backdrop();
-		map_draw(false);
-	}
-	
-	// draw all objects following their z-order
 	nOnscreenObjects = 0;
 	
 	for(Object *o = lowestobject;
 		o != NULL;
 		o = o->higher)
 	{
-		if (o == player) continue;	// player drawn specially in DrawPlayer
+		if (o == player) continue;	// player's done in RunPlayerEffects
 		
 		// keep it's floattext linked with it's position
 		o->DamageText->UpdatePos(o);
@@ -396,7 +450,7 @@ extern int flipacceltime;
 		scr_x -= sprites[o->sprite].frame[o->frame].dir[o->dir].drawpoint.x;
 		scr_y -= sprites[o->sprite].frame[o->frame].dir[o->dir].drawpoint.y;
 		
-		// don't draw objects that are completely offscreen
+		// objects that are completely offscreen aren't drawn
 		// (+26 so floattext won't suddenly disappear on object near bottom of screen)
 		if (scr_x <= Graphics::SCREEN_WIDTH && scr_y <= Graphics::SCREEN_HEIGHT+26 && \
 			scr_x >= -sprites[o->sprite].w && scr_y >= -sprites[o->sprite].h)
@@ -411,20 +465,6 @@ extern int flipacceltime;
 				staterr("%s:%d: Max Objects Overflow", __FILE__, __LINE__);
 				return;
 			}
-			
-			if (!o->invisible && o->sprite != SPR_NULL)
-			{
-				scr_x += o->display_xoff;
-				
-				if (o->clip_enable)
-				{
-					draw_sprite_clipped(scr_x, scr_y, o->sprite, o->frame, o->dir, o->clipx1, o->clipx2, o->clipy1, o->clipy2);
-				}
-				else
-				{
-					draw_sprite(scr_x, scr_y, o->sprite, o->frame, o->dir);
-				}
-			}
 		}
 		else
 		{
@@ -432,12 +472,57 @@ extern int flipacceltime;
 		}
 	}
 	
+	RunPlayerEffects();
+	Carets::RunAll();
+	FloatText::RunAll();
+}
+
+void DrawScene(void)
+{
+int scr_x, scr_y;
+	
+	PROFILE_SCOPE("DrawScene");
+	
+	if (map.nmotiontiles)
+		DrawMotionTiles();
+	
+	// draw background map tiles
+	map_draw_backdrop();
+	map_draw(false);
+	
+	// draw all objects following their z-order. RunScene
+	// has already worked out which ones are onscreen.
+	for(Object *o = lowestobject;
+		o != NULL;
+		o = o->higher)
+	{
+		if (o == player || !o->onscreen)
+			continue;
+		
+		if (!o->invisible && o->sprite != SPR_NULL)
+		{
+			scr_x = (o->x >> CSF) - (map.displayed_xscroll >> CSF);
+			scr_y = (o->y >> CSF) - (map.displayed_yscroll >> CSF);
+			scr_x -= sprites[o->sprite].frame[o->frame].dir[o->dir].drawpoint.x;
+			scr_y -= sprites[o->sprite].frame[o->frame].dir[o->dir].drawpoint.y;
+			scr_x += o->display_xoff;
+			
+			if (o->clip_enable)
+			{
+				draw_sprite_clipped(scr_x, scr_y, o->sprite, o->frame, o->dir, o->clipx1, o->clipx2, o->clipy1, o->clipy2);
+			}
+			else
+			{
+				draw_sprite(scr_x, scr_y, o->sprite, o->frame, o->dir);
+			}
+		}
+	}
+	
 	// draw the player
 	DrawPlayer();
 	
 	// draw foreground map tiles
-	if (!flipacceltime)
-		map_draw(TA_FOREGROUND);
+	map_draw(TA_FOREGROUND);
 	
 	// draw carets (always-on-top effects such as boomflash)
 	Carets::DrawAll();
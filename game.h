@@ -33,7 +33,7 @@ enum Directions
 
 #include "game_modes.h"
 
-// note: this structure is memsetted at 0 at startup.
+// note: this structure starts out zeroed as part of the World (see world.h).
 // ensure it doesn't contain any non-POD types that would be harmed by this.
 struct Game
 {
@@ -140,11 +140,7 @@ struct Game
 
 #define NXFLAG_SLOW_WHEN_HURT		(NXFLAG_SLOW_X_WHEN_HURT | NXFLAG_SLOW_Y_WHEN_HURT)
 
-extern Game game;
-extern TextBox textbox;
-
-extern Object *onscreen_objects[MAX_OBJECTS];
-extern int nOnscreenObjects;
+extern NX_THREAD bool present_frame;		// false when this tick's frame won't be shown
 
 void debug(const char *fmt, ...);
 void quake(int quaketime, int snd=-1);
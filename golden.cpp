@@ -0,0 +1,445 @@
+
+#include <algorithm>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nx.h"
+#include "golden.h"
+#include "graphics/softblit.h"
+
+enum GoldenStatus
+{
+	GS_NOTREACHED,	// the replay ended before this tick
+	GS_OK,
+	GS_DIFFERENT,
+	GS_MISSING,		// there's no reference image for it
+	GS_UPDATED,		// the reference was written, with -goldenupdate
+	GS_ERROR,
+	GS_MISSED		// the tick ran but its frame wasn't drawn
+};
+
+struct GoldenResult
+{
+	int replay;
+	int tick;
+	int status;
+	int pixels;		// how many were off by more than the tolerance
+	int maxdiff;	// the most any channel of any pixel was off by
+};
+
+static StringList replays;
+static std::vector<int> ticks;			// sorted, each only once
+static std::vector<GoldenResult> results;
+static const char *refdir = "golden";
+static const char *outfile = "golden.json";
+static int tolerance = 0;
+static bool update = false;
+static int curreplay = -1;
+static bool finished = false;
+
+static int curticks = 0;		// ticks run so far in the current replay
+static int nextcapture = 0;		// index into ticks of the next one to capture
+
+static void finish_replay();
+static void add_result(int tick, int status);
+static void capture(int tick);
+static bool compare(SDL_Surface *actual, SDL_Surface *ref, SDL_Surface *diff, GoldenResult *r);
+static void get_image_name(int replay, int tick, const char *suffix, char *buffer);
+static SDL_Surface *load_image(const char *fname);
+static bool save_image(SDL_Surface *sfc, const char *fname);
+static bool write_report();
+
+/*
+void c------------------------------() {}
+*/
+
+void Golden::AddReplay(const char *fname)
+{
+	replays.AddString(fname);
+	curreplay = 0;
+}
+
+// adds ticks to capture at from a comma-separated list, such as "100,250,600".
+// they apply to every replay.
+bool Golden::AddTicks(const char *list)
+{
+	const char *p = list;
+
+	while(*p)
+	{
+		char *end;
+		long tick = strtol(p, &end, 10);
+		if (end == p || tick <= 0 || (*end && *end != ','))
+		{
+			staterr("golden: bad tick list '%s'", list);
+			return 1;
+		}
+
+		ticks.push_back((int)tick);
+		p = (*end) ? (end + 1) : end;
+	}
+
+	std::sort(ticks.begin(), ticks.end());
+	ticks.erase(std::unique(ticks.begin(), ticks.end()), ticks.end());
+	return 0;
+}
+
+void Golden::SetDir(const char *dir)
+{
+	refdir = dir;
+}
+
+// how far off any channel of a pixel can be and still match; 0 for exact
+void Golden::SetTolerance(int newtolerance)
+{
+	tolerance = newtolerance;
+}
+
+// write what's drawn as the new references, instead of comparing
+void Golden::SetUpdate(bool enable)
+{
+	update = enable;
+}
+
+void Golden::SetOutput(const char *fname)
+{
+	outfile = fname;
+}
+
+bool Golden::IsActive()
+{
+	return (curreplay >= 0 && !finished);
+}
+
+const char *Golden::CurrentReplay()
+{
+	if (!IsActive()) return NULL;
+	return replays.StringAt(curreplay);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// called by the main loop once the game has drawn a tick
+void Golden::OnFrameDrawn()
+{
+	if (!IsActive() || !Replay::IsPlaying())
+		return;
+
+	// anything before this tick was dealt with by OnTickDone
+	if (nextcapture < (int)ticks.size() && ticks[nextcapture] <= (curticks + 1))
+		capture(ticks[nextcapture++]);
+}
+
+// called by the main loop after every tick. once the current replay has run
+// out, or there's nothing left in it to capture, moves on to the next one.
+void Golden::OnTickDone()
+{
+	if (!IsActive())
+		return;
+
+	curticks++;
+
+	// a tick which has run without its capture being taken
+	// never had its frame drawn, so there's nothing to compare.
+	while(nextcapture < (int)ticks.size() && ticks[nextcapture] <= curticks)
+	{
+		staterr("golden: '%s': tick %d ran but wasn't drawn", \
+			replays.StringAt(curreplay), ticks[nextcapture]);
+
+		add_result(ticks[nextcapture++], GS_MISSED);
+	}
+
+	if (Replay::IsPlaying())
+	{
+		if (nextcapture < (int)ticks.size())
+			return;
+
+		Replay::end_playback();
+	}
+
+	finish_replay();
+
+	if (++curreplay < replays.CountItems())
+	{
+		game.switchstage.mapno = START_REPLAY;
+		return;
+	}
+
+	finished = true;
+	game.running = false;
+}
+
+static void finish_replay()
+{
+	for(;nextcapture<(int)ticks.size();nextcapture++)
+	{
+		staterr("golden: '%s': ended after %d ticks, before tick %d", \
+			replays.StringAt(curreplay), curticks, ticks[nextcapture]);
+
+		add_result(ticks[nextcapture], GS_NOTREACHED);
+	}
+
+	curticks = 0;
+	nextcapture = 0;
+}
+
+// records a frame which couldn't be compared
+static void add_result(int tick, int status)
+{
+GoldenResult r;
+
+	memset(&r, 0, sizeof(r));
+	r.replay = curreplay;
+	r.tick = tick;
+	r.status = status;
+	results.push_back(r);
+}
+
+// reports how many frames matched, and returns 1 if any didn't
+bool Golden::Finish()
+{
+int i, failed = 0;
+
+	if (curreplay < 0)
+		return 0;
+
+	for(i=0;i<(int)results.size();i++)
+	{
+		if (results[i].status != GS_OK && results[i].status != GS_UPDATED)
+			failed++;
+	}
+
+	write_report();
+
+	if (results.empty())
+	{
+		staterr("golden: no frames were captured; give the ticks with -goldenticks");
+		return 1;
+	}
+
+	stat("golden: %d of %d frames %s", (int)results.size() - failed, (int)results.size(), \
+		update ? "written" : "matched");
+	return (failed != 0);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static void capture(int tick)
+{
+char fname[MAXPATHLEN];
+SDL_Surface *actual, *ref, *diff;
+GoldenResult r;
+
+	memset(&r, 0, sizeof(r));
+	r.replay = curreplay;
+	r.tick = tick;
+
+	actual = screen->GetPixels();
+	get_image_name(curreplay, tick, "", fname);
+
+	if (!actual)
+	{
+		staterr("golden: nothing to capture; the software renderer isn't in use");
+		r.status = GS_ERROR;
+	}
+	else if (update)
+	{
+		r.status = save_image(actual, fname) ? GS_ERROR : GS_UPDATED;
+	}
+	else if (!(ref = load_image(fname)))
+	{
+		staterr("golden: '%s': no reference image '%s'", replays.StringAt(curreplay), fname);
+		r.status = GS_MISSING;
+	}
+	else
+	{
+		if (!(diff = SoftBlit::Create(actual->w, actual->h)))
+		{
+			r.status = GS_ERROR;
+		}
+		else if (compare(actual, ref, diff, &r))
+		{
+			staterr("golden: '%s': tick %d differs in %d pixels (by up to %d)", \
+				replays.StringAt(curreplay), tick, r.pixels, r.maxdiff);
+
+			r.status = GS_DIFFERENT;
+			get_image_name(curreplay, tick, ".diff", fname);
+			save_image(diff, fname);
+		}
+		else
+		{
+			r.status = GS_OK;
+		}
+
+		if (diff) SDL_FreeSurface(diff);
+		SDL_FreeSurface(ref);
+	}
+
+	if (actual && r.status != GS_OK && r.status != GS_UPDATED)
+	{
+		get_image_name(curreplay, tick, ".actual", fname);
+		save_image(actual, fname);
+	}
+
+	results.push_back(r);
+}
+
+// compares the two images, filling in the pixel counts of r. in diff, the
+// pixels which are off by more than the tolerance are drawn in red, over a
+// darkened copy of the reference. returns 1 if there were any.
+static bool compare(SDL_Surface *actual, SDL_Surface *ref, SDL_Surface *diff, GoldenResult *r)
+{
+int x, y;
+
+	if (actual->w != ref->w || actual->h != ref->h)
+	{
+		staterr("golden: reference is %dx%d but the frame is %dx%d", \
+			ref->w, ref->h, actual->w, actual->h);
+
+		SoftBlit::Fill(diff, NULL, SoftBlit::MapColor(255, 0, 0));
+		r->pixels = (actual->w * actual->h);
+		r->maxdiff = 255;
+		return 1;
+	}
+
+	for(y=0;y<actual->h;y++)
+	{
+		const uint32_t *a = (const uint32_t *)((uint8_t *)actual->pixels + (y * actual->pitch));
+		const uint32_t *b = (const uint32_t *)((uint8_t *)ref->pixels + (y * ref->pitch));
+		uint32_t *d = (uint32_t *)((uint8_t *)diff->pixels + (y * diff->pitch));
+
+		for(x=0;x<actual->w;x++)
+		{
+			int dist = 0;
+			for(int shift=0;shift<24;shift+=8)
+			{
+				int ch = abs((int)((a[x] >> shift) & 0xff) - (int)((b[x] >> shift) & 0xff));
+				if (ch > dist) dist = ch;
+			}
+
+			if (dist > r->maxdiff)
+				r->maxdiff = dist;
+
+			if (dist > tolerance)
+			{
+				d[x] = SoftBlit::MapColor(255, 0, 0);
+				r->pixels++;
+			}
+			else
+			{
+				d[x] = (0xff000000 | ((b[x] >> 2) & 0x3f3f3f));
+			}
+		}
+	}
+
+	return (r->pixels != 0);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// <refdir>/<name of the replay, without path or extension>-<tick><suffix>.bmp
+static void get_image_name(int replay, int tick, const char *suffix, char *buffer)
+{
+char base[MAXPATHLEN];
+
+	const char *fname = replays.StringAt(replay);
+	const char *slash = strrchr(fname, '/');
+	if (slash) fname = (slash + 1);
+
+	maxcpy(base, fname, sizeof(base));
+	char *dot = strrchr(base, '.');
+	if (dot) *dot = 0;
+
+	snprintf(buffer, MAXPATHLEN, "%s/%s-%d%s.bmp", refdir, base, tick, suffix);
+}
+
+// returns the image in SOFTBLIT_FORMAT, or NULL if it isn't there
+static SDL_Surface *load_image(const char *fname)
+{
+	FILE *fp = fileopenRW(fname, "rb");
+	if (!fp)
+		return NULL;
+
+	SDL_Surface *image = SDL_LoadBMP_RW(SDL_RWFromFP(fp, SDL_TRUE), 1);
+	if (!image)
+	{
+		staterr("golden: failed to load '%s': %s", fname, SDL_GetError());
+		return NULL;
+	}
+
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(image, SOFTBLIT_FORMAT, 0);
+	SDL_FreeSurface(image);
+	return converted;
+}
+
+// saved without the alpha channel, which doesn't mean anything on the screen
+static bool save_image(SDL_Surface *sfc, const char *fname)
+{
+	SDL_Surface *rgb = SDL_ConvertSurfaceFormat(sfc, SDL_PIXELFORMAT_RGB24, 0);
+	if (!rgb)
+	{
+		staterr("golden: failed to convert '%s': %s", fname, SDL_GetError());
+		return 1;
+	}
+
+	FILE *fp = fileopenRW(fname, "wb");
+	if (!fp)
+	{
+		staterr("golden: failed to open '%s' for writing", fname);
+		SDL_FreeSurface(rgb);
+		return 1;
+	}
+
+	bool error = (SDL_SaveBMP_RW(rgb, SDL_RWFromFP(fp, SDL_TRUE), 1) != 0);
+	if (error)
+		staterr("golden: failed to write '%s': %s", fname, SDL_GetError());
+
+	SDL_FreeSurface(rgb);
+	return error;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static bool write_report()
+{
+FILE *fp;
+int i;
+
+	fp = fileopenRW(outfile, "wb");
+	if (!fp)
+	{
+		staterr("golden: failed to open '%s' for writing", outfile);
+		return 1;
+	}
+
+	static const char *status_names[] = { "notreached", "ok", "different", "missing", "updated", "error", "missed" };
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"tolerance\": %d,\n", tolerance);
+	fprintf(fp, "\t\"frames\": [\n");
+
+	for(i=0;i<(int)results.size();i++)
+	{
+		GoldenResult *r = &results[i];
+		fprintf(fp, "\t\t{ \"replay\": ");
+		fputjsonstring(replays.StringAt(r->replay), fp);
+		fprintf(fp, ", \"tick\": %d, \"status\": \"%s\", \"pixels\": %d, \"maxdiff\": %d }%s\n", \
+			r->tick, status_names[r->status], r->pixels, r->maxdiff, \
+			(i + 1 < (int)results.size()) ? "," : "");
+	}
+
+	fprintf(fp, "\t]\n}\n");
+	fclose(fp);
+
+	stat("golden: report written to '%s'", outfile);
+	return 0;
+}
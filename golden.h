@@ -0,0 +1,32 @@
+#ifndef _GOLDEN_H
+#define _GOLDEN_H
+
+#define GOLDEN_RESOLUTION		1		// 320x240 at scale 1, so the images are the same everywhere
+
+// golden-frame regression testing: plays back a list of replays headless on
+// the software renderer, and compares the frame drawn on each of the given
+// ticks against a reference image stored for it. a frame passes if no
+// channel of any pixel is off by more than the tolerance. for each one that
+// fails, what was drawn and an image marking the differences in red are
+// written next to the reference.
+//
+// the images are captured straight after the game draws the tick, before
+// anything like the fps counter or the replay status goes on top.
+namespace Golden
+{
+	void AddReplay(const char *fname);
+	bool AddTicks(const char *list);
+	void SetDir(const char *dir);
+	void SetTolerance(int tolerance);
+	void SetUpdate(bool enable);
+	void SetOutput(const char *fname);
+
+	bool IsActive();
+	const char *CurrentReplay();
+
+	void OnFrameDrawn();
+	void OnTickDone();
+	bool Finish();
+};
+
+#endif
@@ -0,0 +1,162 @@
+
+#include <string.h>
+#include "graphics.h"
+#include "atlas.h"
+#include "atlas.fdh"
+
+extern SDL_Renderer * renderer;
+
+static AtlasPage pages[ATLAS_MAX_PAGES];
+
+static int npages = 0;
+static int pagesize = 0;
+static int nimages = 0;
+static int used = 0;
+static bool enabled = true;
+
+// largest page the renderer can handle, up to ATLAS_SIZE
+static int get_page_size()
+{
+	int size = ATLAS_SIZE;
+
+	if (renderer)
+	{
+		SDL_RendererInfo info;
+		if (!SDL_GetRendererInfo(renderer, &info) && info.max_texture_width && info.max_texture_height)
+		{
+			int max = (info.max_texture_width < info.max_texture_height) ? \
+						info.max_texture_width : info.max_texture_height;
+
+			if (size * SCALE > max)
+				size = (max / SCALE);
+		}
+	}
+
+	return size;
+}
+
+// find room for a wd x ht image on the page
+static bool place(AtlasPage *page, int wd, int ht, int *x_out, int *y_out)
+{
+	// start a new shelf if it doesn't fit across the rest of this one
+	if (page->shelf_x + wd > pagesize)
+	{
+		page->shelf_y += page->shelf_h + ATLAS_PADDING;
+		page->shelf_x = 0;
+		page->shelf_h = 0;
+	}
+
+	if (page->shelf_x + wd > pagesize || page->shelf_y + ht > pagesize)
+		return 1;
+
+	*x_out = page->shelf_x;
+	*y_out = page->shelf_y;
+
+	page->shelf_x += wd + ATLAS_PADDING;
+	if (ht > page->shelf_h)
+		page->shelf_h = ht;
+
+	return 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// copies the image into the atlas. on success returns 0, with the page it's
+// on and where. returns 1 if it won't fit, in which case the caller should
+// go on using the image as it is.
+bool Atlas::Add(NXSurface *image, NXSurface **page_out, int *x_out, int *y_out)
+{
+int wd, ht;
+int i, x, y;
+
+	if (!enabled)
+		return 1;
+
+	if (!pagesize)
+		pagesize = get_page_size();
+
+	wd = image->Width();
+	ht = image->Height();
+	if (wd > pagesize || ht > pagesize)
+		return 1;
+
+	// earlier pages may still have room for a smaller image,
+	// so they're all tried before starting another.
+	for(i=0;i<npages;i++)
+	{
+		if (!place(&pages[i], wd, ht, &x, &y))
+			break;
+	}
+
+	if (i >= npages)
+	{
+		if (npages >= ATLAS_MAX_PAGES)
+			return 1;
+
+		AtlasPage *page = &pages[npages];
+		memset(page, 0, sizeof(AtlasPage));
+
+		page->sfc = new NXSurface;
+		if (page->sfc->AllocTransparent(pagesize, pagesize))
+		{
+			staterr("Atlas::Add: failed to create a %dx%d page", pagesize, pagesize);
+			delete page->sfc;
+			page->sfc = NULL;
+			return 1;
+		}
+
+		stat("Atlas::Add: started page %d (%dx%d)", npages, pagesize, pagesize);
+		i = npages++;
+
+		if (place(page, wd, ht, &x, &y))
+			return 1;
+	}
+
+	pages[i].sfc->DrawSurface(image, x, y);
+
+	nimages++;
+	used += (wd * ht);
+
+	*page_out = pages[i].sfc;
+	*x_out = x;
+	*y_out = y;
+	return 0;
+}
+
+// frees all the pages. anything which was added has to be added again.
+void Atlas::Clear()
+{
+	for(int i=0;i<npages;i++)
+		delete pages[i].sfc;
+
+	memset(pages, 0, sizeof(pages));
+	npages = 0;
+	pagesize = 0;
+	nimages = 0;
+	used = 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// only affects images added from now on
+void Atlas::SetEnabled(bool enable)
+{
+	enabled = enable;
+}
+
+bool Atlas::IsEnabled()
+{
+	return enabled;
+}
+
+void Atlas::GetStats(AtlasStats *stats)
+{
+	stats->pages = npages;
+	stats->images = nimages;
+	stats->size = pagesize;
+	stats->used = used;
+}
@@ -0,0 +1,37 @@
+#ifndef _ATLAS_H
+#define _ATLAS_H
+
+#define ATLAS_SIZE			1024	// unscaled width and height of a page, if the renderer allows it
+#define ATLAS_MAX_PAGES		4
+#define ATLAS_PADDING		1		// kept clear around each image
+
+struct AtlasPage
+{
+	NXSurface *sfc;
+	int shelf_x, shelf_y;		// where the next image goes on the current shelf
+	int shelf_h;				// height of the tallest image on the current shelf
+};
+
+struct AtlasStats
+{
+	int pages;
+	int images;			// number of images packed
+	int size;			// width and height of each page
+	int used;			// area taken by the images, across all pages
+};
+
+// packs images (the spritesheets) into a few large textures, so drawing
+// from different ones doesn't mean switching textures. each page is filled
+// in shelves, left to right and then top to bottom, as the images come in.
+namespace Atlas
+{
+	bool Add(NXSurface *image, NXSurface **page_out, int *x_out, int *y_out);
+	void Clear();
+
+	void SetEnabled(bool enable);
+	bool IsEnabled();
+
+	void GetStats(AtlasStats *stats);
+};
+
+#endif
@@ -0,0 +1,315 @@
+
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+#include "../config.h"
+#include "graphics.h"
+#include "drawqueue.h"
+#include "../profiler.h"
+#include "hacks/hacks.hpp"
+#include "drawqueue.fdh"
+
+extern SDL_Renderer * renderer;
+
+static std::vector<DrawCommand> queue;
+static std::vector<int> run;			// indexes of the commands in the run being drawn
+static std::vector<int> skipped;		// commands a run has been pulled forward past
+static std::vector<SDL_Rect> fills;
+
+static bool enabled = true;
+static bool flushing = false;
+
+static DrawQueueStats stats;
+static DrawQueueStats laststats;
+static SDL_Texture *lasttexture = NULL;
+
+/*
+void c------------------------------() {}
+*/
+
+void DrawQueue::SetEnabled(bool enable)
+{
+	if (!enable)
+		Flush();
+
+	enabled = enable;
+}
+
+bool DrawQueue::IsEnabled()
+{
+	return enabled;
+}
+
+// true if drawing should be recorded instead of done right away.
+// the software renderer has no draw calls to save, so never records.
+bool DrawQueue::IsRecording()
+{
+	return (enabled && !flushing && !headless && !software_render);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static DrawCommand *add_command(int type, NXSurface *target)
+{
+	queue.push_back(DrawCommand());
+	stats.commands++;
+
+	DrawCommand *c = &queue.back();
+	memset(c, 0, sizeof(DrawCommand));
+	c->type = type;
+	c->target = target;
+	return c;
+}
+
+void DrawQueue::Copy(NXSurface *target, SDL_Texture *texture, \
+					 const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+	// fully clipped away
+	if (dstrect->w <= 0 || dstrect->h <= 0)
+		return;
+
+	if (texture != lasttexture)
+	{
+		stats.texture_switches++;
+		lasttexture = texture;
+	}
+
+	DrawCommand *c = add_command(DC_COPY, target);
+	c->texture = texture;
+	c->src = *srcrect;
+	c->dst = *dstrect;
+}
+
+void DrawQueue::Fill(NXSurface *target, const SDL_Rect *rect, \
+					 uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+	DrawCommand *c = add_command(DC_FILL, target);
+	c->dst = *rect;
+	c->r = r; c->g = g; c->b = b; c->a = a;
+}
+
+void DrawQueue::Line(NXSurface *target, int x1, int y1, int x2, int y2, \
+					 uint8_t r, uint8_t g, uint8_t b)
+{
+	DrawCommand *c = add_command(DC_LINE, target);
+	c->dst.x = x1; c->dst.y = y1;
+	c->dst.w = x2; c->dst.h = y2;
+	c->r = r; c->g = g; c->b = b; c->a = SDL_ALPHA_OPAQUE;
+}
+
+void DrawQueue::Clear(NXSurface *target, uint8_t r, uint8_t g, uint8_t b)
+{
+	DrawCommand *c = add_command(DC_CLEAR, target);
+	c->r = r; c->g = g; c->b = b; c->a = SDL_ALPHA_OPAQUE;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// draw everything recorded so far
+void DrawQueue::Flush()
+{
+NXSurface *curtarget = NULL;
+int i, count;
+
+	count = queue.size();
+	if (!count)
+		return;
+
+	flushing = true;
+
+	for(i=0;i<count;i++)
+	{
+		DrawCommand *c = &queue[i];
+		if (c->done)
+			continue;
+
+		if (c->target != curtarget)
+		{
+			c->target->SetAsTarget(c->target != screen);
+			curtarget = c->target;
+			stats.target_switches++;
+		}
+
+		switch(c->type)
+		{
+			case DC_COPY:
+				flush_copies(i);
+			break;
+
+			case DC_FILL:
+				flush_fills(i);
+			break;
+
+			case DC_LINE:
+				SDL_SetRenderDrawColor(renderer, c->r, c->g, c->b, c->a);
+				SDL_RenderDrawLine(renderer, c->dst.x, c->dst.y, c->dst.w, c->dst.h);
+				stats.draw_calls++;
+			break;
+
+			case DC_CLEAR:
+				SDL_SetRenderDrawColor(renderer, c->r, c->g, c->b, c->a);
+				SDL_RenderClear(renderer);
+				stats.draw_calls++;
+			break;
+		}
+	}
+
+	if (curtarget != screen)
+		screen->SetAsTarget(false);
+
+	queue.clear();
+	flushing = false;
+}
+
+// flushes, and closes off the stats for the frame
+void DrawQueue::EndFrame()
+{
+	Flush();
+
+	laststats = stats;
+	memset(&stats, 0, sizeof(stats));
+	lasttexture = NULL;
+
+	PROFILE_COUNTER("draw commands", laststats.commands);
+	PROFILE_COUNTER("draw calls", laststats.draw_calls);
+	PROFILE_COUNTER("texture switches", laststats.texture_switches);
+}
+
+const DrawQueueStats *DrawQueue::LastFrame()
+{
+	return &laststats;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// draws the copy at first along with every later one from the same texture
+// which can be brought forward to go with it. the search stops at anything
+// which draws to another target, since that target could be the texture.
+static void flush_copies(int first)
+{
+DrawCommand *c = &queue[first];
+int i, j, count;
+
+	run.clear();
+	skipped.clear();
+	run.push_back(first);
+
+	count = queue.size();
+	for(j=first+1;j<count && (j - first) <= DQ_LOOKAHEAD;j++)
+	{
+		DrawCommand *o = &queue[j];
+		if (o->done)
+			continue;
+
+		if (o->target != c->target || o->type == DC_CLEAR)
+			break;
+
+		if (o->type == DC_COPY && o->texture == c->texture && !overlaps_skipped(o))
+			run.push_back(j);
+		else
+			skipped.push_back(j);
+	}
+
+	int n = run.size();
+
+#if defined(CONFIG_BATCH_RENDERING)
+	if (n > 1 && !GraphicHacks::BatchBegin(renderer, 0))
+	{
+		for(i=0;i<n;i++)
+		{
+			DrawCommand *o = &queue[run[i]];
+			GraphicHacks::BatchAddCopy(renderer, o->texture, &o->src, &o->dst);
+			o->done = true;
+		}
+
+		GraphicHacks::BatchEnd(renderer);
+		stats.draw_calls++;
+		stats.batches++;
+		return;
+	}
+#endif
+
+	for(i=0;i<n;i++)
+	{
+		DrawCommand *o = &queue[run[i]];
+
+		if (SDL_RenderCopy(renderer, o->texture, &o->src, &o->dst))
+			staterr("DrawQueue::Flush: SDL_RenderCopy failed: %s", SDL_GetError());
+
+		o->done = true;
+		stats.draw_calls++;
+	}
+}
+
+// consecutive fills of the same color go out together
+static void flush_fills(int first)
+{
+DrawCommand *c = &queue[first];
+int j, count;
+
+	fills.clear();
+
+	count = queue.size();
+	for(j=first;j<count;j++)
+	{
+		DrawCommand *o = &queue[j];
+		if (o->type != DC_FILL || o->target != c->target || \
+			o->r != c->r || o->g != c->g || o->b != c->b || o->a != c->a)
+			break;
+
+		fills.push_back(o->dst);
+		o->done = true;
+	}
+
+	SDL_SetRenderDrawColor(renderer, c->r, c->g, c->b, c->a);
+	SDL_RenderFillRects(renderer, &fills[0], fills.size());
+	stats.draw_calls++;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static void get_bounds(const DrawCommand *c, SDL_Rect *rect)
+{
+	if (c->type == DC_LINE)
+	{
+		int x1 = c->dst.x, y1 = c->dst.y;
+		int x2 = c->dst.w, y2 = c->dst.h;
+
+		rect->x = (x1 < x2) ? x1 : x2;
+		rect->y = (y1 < y2) ? y1 : y2;
+		rect->w = abs(x2 - x1) + 1;
+		rect->h = abs(y2 - y1) + 1;
+	}
+	else
+	{
+		*rect = c->dst;
+	}
+}
+
+// true if c overlaps anything in the skipped list, in which
+// case it can't be drawn ahead of them.
+static bool overlaps_skipped(const DrawCommand *c)
+{
+SDL_Rect a, b;
+
+	get_bounds(c, &a);
+
+	for(int i=0;i<(int)skipped.size();i++)
+	{
+		get_bounds(&queue[skipped[i]], &b);
+
+		if (a.x < b.x + b.w && b.x < a.x + a.w && \
+			a.y < b.y + b.h && b.y < a.y + a.h)
+			return true;
+	}
+
+	return false;
+}
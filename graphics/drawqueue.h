@@ -0,0 +1,68 @@
+#ifndef _DRAWQUEUE_H
+#define _DRAWQUEUE_H
+
+#include <SDL.h>
+
+class NXSurface;
+struct NXColor;
+
+#define DQ_LOOKAHEAD		64		// commands searched past for more of the same texture
+
+enum DrawCommandType
+{
+	DC_COPY,
+	DC_FILL,
+	DC_LINE,
+	DC_CLEAR
+};
+
+// one recorded drawing operation. rects are in final (scaled) pixels, and
+// have already been clipped with the target's clip rect, so the clip rect
+// can change between recording and Flush() without affecting them.
+struct DrawCommand
+{
+	uint8_t type;
+	uint8_t r, g, b, a;
+	bool done;				// already drawn as part of an earlier run
+
+	NXSurface *target;
+	SDL_Texture *texture;	// DC_COPY
+	SDL_Rect src;			// DC_COPY
+	SDL_Rect dst;			// DC_LINE keeps the end points here as x, y, w, h
+};
+
+struct DrawQueueStats
+{
+	int commands;			// recorded since the last Flush
+	int draw_calls;			// what they went out as; a batch is a single call
+	int batches;
+	int target_switches;
+	int texture_switches;	// copies from a different texture than the one before, as recorded
+};
+
+// records everything drawn through an NXSurface during a frame, instead of
+// sending each one to the renderer as it comes. Flush() plays them back in
+// order, putting runs of copies from the same texture onto the same target
+// through a single batch. a copy may be pulled forward into an earlier run
+// if nothing it would be moved in front of overlaps it, so the picture comes
+// out the same as drawing them in order.
+//
+// the queue is flushed before every Flip(), and before any surface is freed,
+// since commands hold on to the surfaces and textures they use.
+namespace DrawQueue
+{
+	void SetEnabled(bool enable);
+	bool IsEnabled();
+	bool IsRecording();
+
+	void Copy(NXSurface *target, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect);
+	void Fill(NXSurface *target, const SDL_Rect *rect, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
+	void Line(NXSurface *target, int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, uint8_t b);
+	void Clear(NXSurface *target, uint8_t r, uint8_t g, uint8_t b);
+
+	void Flush();
+	void EndFrame();
+	const DrawQueueStats *LastFrame();
+};
+
+#endif
@@ -9,6 +9,8 @@
 
 #include "../nx.h"
 #include "font.h"
+#include "drawqueue.h"
+#include "softblit.h"
 #include "font.fdh"
 
 static int text_draw(int x, int y, const char *text, int spacing=0, NXFont *font=&whitefont);
@@ -32,6 +34,7 @@ const char *ttffontfile = "font.ttf";
 //static SDL_Surface *sdl_screen = NULL;
 //static SDL_Surface *shadesfc = NULL;
 static SDL_Texture* tshadesfc = NULL;
+static SDL_Surface* sshadesfc = NULL;		// the software renderer's version
 static int shadesfc_h = 0;
 
 static bool initilized = false;
@@ -156,6 +159,9 @@ NXFont::~NXFont()
 
 void NXFont::free()
 {
+	// queued text may still be using the letters
+	DrawQueue::Flush();
+	
 	for(int i=0;i<NUM_LETTERS_RENDERED;i++)
 	{
 		if (letters[i]) SDL_FreeSurface(letters[i]);
@@ -417,6 +423,30 @@ SDL_Rect dstrect;
 
 bool NXFont::InitTextures()
 {
+	// the software renderer draws straight from the letters,
+	// once they're in it's format.
+	if (software_render)
+	{
+		for (int i = 0; i < NUM_FONT_LETTERS; ++i)
+		{
+			if (!letters[i])
+				continue;
+
+			SDL_Surface *converted = SoftBlit::Convert(letters[i], 1);
+			if (!converted)
+				return true;
+
+			SDL_FreeSurface(letters[i]);
+			letters[i] = converted;
+		}
+
+		return false;
+	}
+
+	// headless keeps the letter surfaces so text can still be measured
+	if (headless)
+		return false;
+	
 	for (int i = 0; i < NUM_FONT_LETTERS; ++i)
 	{
 		if (!letters[i])
@@ -510,7 +540,7 @@ SDL_Rect srcrect;
 				draw_sprite((x/SCALE), (y/SCALE)+yadj, SPR_TEXTBULLET);
 			}
 		}
-		else if (rendering && ch != ' ' && tletter)
+		else if (rendering && ch != ' ' && (tletter || (software_render && letter)))
 		{
 			// must set this every time, because SDL_BlitSurface overwrites
 			// dstrect with final clipping rectangle.
@@ -527,7 +557,10 @@ SDL_Rect srcrect;
 			if (Graphics::is_set_clip())
 				Graphics::clip(srcrect, dstrect);
 			
-			SDL_RenderCopy(renderer, tletter, &srcrect, &dstrect);
+			if (software_render)
+				Graphics::DrawPixels(letter, &srcrect, &dstrect);
+			else
+				Graphics::DrawTexture(tletter, &srcrect, &dstrect);
 		}
 		
 		if (spacing != 0)
@@ -585,8 +618,26 @@ void c------------------------------() {}
 // with 50% per-surface alpha applied, that we can use to darken the background.
 static bool create_shade_sfc(void)
 {
+	if (software_render)
+	{
+		if (sshadesfc)
+			SDL_FreeSurface(sshadesfc);
+		
+		shadesfc_h = whitefont.letters['M']->h;
+		sshadesfc = SoftBlit::Create(Graphics::SCREEN_WIDTH * SCALE, shadesfc_h);
+		if (!sshadesfc)
+			return 1;
+		
+		SoftBlit::Fill(sshadesfc, NULL, SoftBlit::MapColor(0, 0, 0, 128));
+		return 0;
+	}
+	
+	if (headless)
+		return 0;
+	
 	if (tshadesfc)
 	{
+		DrawQueue::Flush();
 		SDL_DestroyTexture(tshadesfc);
 		tshadesfc = NULL;
 	}
@@ -678,7 +729,10 @@ int wd;
 	if (Graphics::is_set_clip())
 		Graphics::clip(srcrect, dstrect);
 
-	SDL_RenderCopy(renderer, tshadesfc, &srcrect, &dstrect);
+	if (tshadesfc)
+		Graphics::DrawTexture(tshadesfc, &srcrect, &dstrect);
+	else if (sshadesfc)
+		Graphics::DrawPixels(sshadesfc, &srcrect, &dstrect);
 	
 	// draw the text on top as normal
 	wd = text_draw(x, y, text, spacing, font);
@@ -8,6 +8,7 @@
 #include "graphics.h"
 #include "tileset.h"
 #include "sprites.h"
+#include "softblit.h"
 #include "../dirnames.h"
 #include "graphics.fdh"
 #include "../platform/platform.h"
@@ -24,6 +25,8 @@ int Graphics::SCREEN_HEIGHT = 240;
 NXSurface *screen = NULL;				// created from SDL's screen
 static NXSurface *drawtarget = NULL;	// target of DrawRect etc; almost always screen
 bool use_palette = false;				// true if we are in an indexed-color video mode
+bool headless = false;					// no window or renderer; surfaces track only their size
+bool software_render = false;			// surfaces are drawn on the CPU, even when headless
 int screen_bpp;
 
 const NXColor DK_BLUE(0, 0, 0x21);		// the popular dk blue backdrop color
@@ -76,12 +79,17 @@ bool Graphics::init(int resolution)
 void Graphics::close()
 {
 	stat("Graphics::Close()");
+	if (headless) return;
+	
 	SDL_ShowCursor(true);
 	SDL_DestroyWindow(window); window = NULL;
 }
 
 bool Graphics::WindowVisible()
 {
+	if (headless)
+		return true;
+	
 	Uint32 flags = SDL_GetWindowFlags(window);
 
 	return (flags & SDL_WINDOW_SHOWN) && !(flags & SDL_WINDOW_MINIMIZED) // SDL_APPACTIVE
@@ -180,6 +188,16 @@ bool Graphics::InitVideo()
 	if (drawtarget == screen) drawtarget = NULL;
 	if (screen) delete screen;
 	
+	if (headless)
+	{
+		stat("Graphics::InitVideo: headless, %dx%d", Graphics::SCREEN_WIDTH, Graphics::SCREEN_HEIGHT);
+		screen = NXSurface::createScreen(Graphics::SCREEN_WIDTH*SCALE, Graphics::SCREEN_HEIGHT*SCALE, \
+			SDL_PIXELFORMAT_RGB888);
+		
+		if (!drawtarget) drawtarget = screen;
+		return (screen == NULL);
+	}
+	
 	uint32_t window_flags = SDL_WINDOW_SHOWN | SDL_WINDOW_BORDERLESS;
 	if (is_fullscreen) window_flags |= SDL_WINDOW_FULLSCREEN;
 	
@@ -200,6 +218,20 @@ bool Graphics::InitVideo()
 		staterr("Graphics::InitVideo: error setting video mode (SDL_CreateWindow: %s)", SDL_GetError());
 		return 1;
 	}
+	
+	// the software renderer draws into the screen's own pixels and copies
+	// them to the window surface on Flip, so there's no renderer at all.
+	if (software_render)
+	{
+		stat("Graphics::InitVideo: using the software renderer");
+		SDL_ShowCursor(is_fullscreen == false);
+		
+		screen = NXSurface::createScreen(Graphics::SCREEN_WIDTH*SCALE, Graphics::SCREEN_HEIGHT*SCALE, \
+			SOFTBLIT_FORMAT);
+		
+		if (!drawtarget) drawtarget = screen;
+		return (screen == NULL);
+	}
 
 	int drv_index = -1;
 #if 0
@@ -363,9 +395,13 @@ void c------------------------------() {}
 void Graphics::CopySpriteToTile(int spr, int tileno, int offset_x, int offset_y)
 {
 NXRect srcrect, dstrect;
+int sheet_x, sheet_y;
 
-	srcrect.x = (sprites[spr].frame[0].dir[0].sheet_offset.x + offset_x);
-	srcrect.y = (sprites[spr].frame[0].dir[0].sheet_offset.y + offset_y);
+	NXSurface *tileset = Tileset::GetSurface();
+	NXSurface *spritesheet = Sprites::get_spritesheet(sprites[spr].spritesheet, &sheet_x, &sheet_y);
+	
+	srcrect.x = (sheet_x + sprites[spr].frame[0].dir[0].sheet_offset.x + offset_x);
+	srcrect.y = (sheet_y + sprites[spr].frame[0].dir[0].sheet_offset.y + offset_y);
 	srcrect.w = TILE_W;
 	srcrect.h = TILE_H;
 	
@@ -374,9 +410,6 @@ NXRect srcrect, dstrect;
 	dstrect.w = TILE_W;
 	dstrect.h = TILE_H;
 	
-	NXSurface *tileset = Tileset::GetSurface();
-	NXSurface *spritesheet = Sprites::get_spritesheet(sprites[spr].spritesheet);
-	
 	if (tileset && spritesheet)
 	{
 		// blank out the old tile data with clear
@@ -441,6 +474,18 @@ void Graphics::BlitPatternAcross(NXSurface *sfc, int x_dst, int y_dst, int y_src
 	drawtarget->BlitPatternAcross(sfc, x_dst, y_dst, y_src, height);
 }
 
+// copy from a texture which isn't part of an NXSurface, such as the font's
+void Graphics::DrawTexture(SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+	drawtarget->DrawTexture(texture, srcrect, dstrect);
+}
+
+// the same, for the software renderer, which has pixels instead of textures
+void Graphics::DrawPixels(SDL_Surface *pixels, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+	drawtarget->DrawPixels(pixels, srcrect, dstrect);
+}
+
 
 void Graphics::DrawBatchBegin(size_t max_count)
 {
@@ -9,6 +9,8 @@ extern const NXColor DK_BLUE;
 extern const NXColor BLACK;
 extern const NXColor CLEAR;
 extern bool use_palette;
+extern bool headless;
+extern bool software_render;
 
 namespace Graphics
 {
@@ -40,6 +42,8 @@ namespace Graphics
 	void DrawSurface(NXSurface *src, int dstx, int dsty, int srcx, int srcy, int wd, int ht);
 	
 	void BlitPatternAcross(NXSurface *sfc, int x_dst, int y_dst, int y_src, int height);
+	void DrawTexture(SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect);
+	void DrawPixels(SDL_Surface *pixels, const SDL_Rect *srcrect, const SDL_Rect *dstrect);
 	
 	void DrawBatchBegin(size_t max_count);
 	void DrawBatchAdd(NXSurface *src, int dstx, int dsty, int srcx, int srcy, int wd, int ht);
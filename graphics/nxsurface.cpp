@@ -5,6 +5,8 @@
 #include "../config.h"
 #include "graphics.h"
 #include "nxsurface.h"
+#include "drawqueue.h"
+#include "softblit.h"
 #include "nxsurface.fdh"
 #include "../platform/platform.h"
 
@@ -16,10 +18,12 @@
 #endif
 
 extern SDL_Renderer * renderer;
+extern SDL_Window * window;
 
 
 NXSurface::NXSurface() :
 	fTexture(NULL),
+	fPixels(NULL),
 	tex_w(0),
 	tex_h(0),
 	tex_format(),
@@ -30,6 +34,7 @@ NXSurface::NXSurface() :
 
 NXSurface::NXSurface(int wd, int ht, NXFormat *format) :
 	fTexture(NULL),
+	fPixels(NULL),
 	tex_w(0),
 	tex_h(0),
 	tex_format(),
@@ -41,7 +46,7 @@ NXSurface::NXSurface(int wd, int ht, NXFormat *format) :
 
 NXSurface* NXSurface::createScreen(int wd, int ht, Uint32 pixel_format)
 {
-	if (GraphicHacks::Init(renderer))
+	if (!headless && !software_render && GraphicHacks::Init(renderer))
 	{
 		staterr("unable to init GraphicHacks");
 		return NULL;
@@ -50,7 +55,20 @@ NXSurface* NXSurface::createScreen(int wd, int ht, Uint32 pixel_format)
 	NXSurface* s = new NXSurface();
 	s->tex_w = wd;
 	s->tex_h = ht;
-	s->setPixelFormat(pixel_format);
+
+	if (software_render)
+	{
+		s->setPixelFormat(SOFTBLIT_FORMAT);
+		if (!(s->fPixels = SoftBlit::Create(wd, ht)))
+		{
+			delete s;
+			return NULL;
+		}
+	}
+	else
+	{
+		s->setPixelFormat(pixel_format);
+	}
 
 	return s;
 }
@@ -81,6 +99,21 @@ bool NXSurface::AllocNew(int wd, int ht, NXFormat* format)
 
 	stat("NXSurface::AllocNew this = %p", this);
 
+	if (software_render)
+	{
+		fPixels = SoftBlit::Create(wd*SCALE, ht*SCALE);
+		tex_w = wd*SCALE;
+		tex_h = ht*SCALE;
+		return (fPixels == NULL);
+	}
+
+	if (headless)
+	{
+		tex_w = wd*SCALE;
+		tex_h = ht*SCALE;
+		return false;
+	}
+
 	fTexture = SDL_CreateTexture(renderer, format->format, SDL_TEXTUREACCESS_TARGET, wd*SCALE, ht*SCALE);
 	
 	if (!fTexture)
@@ -96,6 +129,33 @@ bool NXSurface::AllocNew(int wd, int ht, NXFormat* format)
 }
 
 
+// allocate an empty surface with an alpha channel, which starts out fully
+// transparent and is blended when drawn, like an image loaded with colorkey.
+bool NXSurface::AllocTransparent(int wd, int ht)
+{
+NXFormat format;
+
+	memset(&format, 0, sizeof(format));
+	format.format = SDL_PIXELFORMAT_ARGB8888;
+	
+	if (AllocNew(wd, ht, &format))
+		return 1;
+	
+	setFormat(&format);
+	if (headless || software_render)
+		return 0;	// software surfaces are created clear
+	
+	if (SDL_SetTextureBlendMode(fTexture, SDL_BLENDMODE_BLEND))
+	{
+		staterr("NXSurface::AllocTransparent: SDL_SetTextureBlendMode failed: %s", SDL_GetError());
+		return 1;
+	}
+	
+	ClearRect(0, 0, wd - 1, ht - 1);
+	return 0;
+}
+
+
 // load the surface from a .pbm or bitmap file
 bool NXSurface::LoadImage(const char *pbm_name, bool use_colorkey, int use_display_format)
 {
@@ -118,6 +178,26 @@ bool NXSurface::LoadImage(const char *pbm_name, bool use_colorkey, int use_displ
 	{
 		SDL_SetColorKey(image, SDL_TRUE, SDL_MapRGB(image->format, 0, 0, 0));
 	}
+	
+	if (software_render)
+	{
+		fPixels = SoftBlit::Convert(image, SCALE);
+		SDL_FreeSurface(image);
+		if (!fPixels)
+			return 1;
+		
+		tex_w = fPixels->w;
+		tex_h = fPixels->h;
+		setPixelFormat(SOFTBLIT_FORMAT);
+		return 0;
+	}
+	
+	if (headless)
+	{	// nothing will ever be drawn; only the dimensions are needed
+		bool error = AllocNew(image->w, image->h, image->format);
+		SDL_FreeSurface(image);
+		return error;
+	}
 
 	SDL_Texture * tmptex = SDL_CreateTextureFromSurface(renderer, image);
 	if (!tmptex)
@@ -185,11 +265,7 @@ void c------------------------------() {}
 void NXSurface::DrawSurface(NXSurface *src, \
 							int dstx, int dsty, int srcx, int srcy, int wd, int ht)
 {
-	if (this != screen)
-		SetAsTarget(true);
-
-	assert(renderer);
-	assert(src->fTexture);
+	if (headless && !software_render) return;
 
 	SDL_Rect srcrect, dstrect;
 
@@ -205,13 +281,19 @@ void NXSurface::DrawSurface(NXSurface *src, \
 
 	if (need_clip) clip(srcrect, dstrect);
 	
-	if (SDL_RenderCopy(renderer, src->fTexture, &srcrect, &dstrect))
+	if (software_render)
 	{
-		staterr("NXSurface::DrawSurface: SDL_RenderCopy failed: %s", SDL_GetError());
+		// a sheet which failed to load has nothing to copy
+		if (!src->fPixels) return;
+		
+		SoftBlit::Copy(src->fPixels, &srcrect, fPixels, &dstrect);
+		return;
 	}
-
-	if (this != screen)
-		SetAsTarget(false);
+	
+	assert(renderer);
+	assert(src->fTexture);
+	
+	DrawTexture(src->fTexture, &srcrect, &dstrect);
 }
 
 void NXSurface::DrawSurface(NXSurface *src, int dstx, int dsty)
@@ -227,8 +309,7 @@ void NXSurface::DrawSurface(NXSurface *src, int dstx, int dsty)
 void NXSurface::BlitPatternAcross(NXSurface *src,
 						   int x_dst, int y_dst, int y_src, int height)
 {
-	if (this != screen)
-		SetAsTarget(true);
+	if (headless && !software_render) return;
 
 	SDL_Rect srcrect, dstrect;
 
@@ -246,34 +327,105 @@ void NXSurface::BlitPatternAcross(NXSurface *src,
 	
 	assert(!need_clip && "clip for blitpattern is not implemented");
 	
+	if (software_render)
+	{
+		if (!src->fPixels) return;
+		
+		do
+		{
+			dstrect.x = x;
+			dstrect.y = y;
+			SoftBlit::Copy(src->fPixels, &srcrect, fPixels, &dstrect);
+			
+			x += src->tex_w;
+		}
+		while(x < destwd);
+		
+		return;
+	}
+	
+	bool deferred = DrawQueue::IsRecording();
+	if (!deferred && this != screen)
+		SetAsTarget(true);
+	
 	do
 	{
 		dstrect.x = x;
 		dstrect.y = y;
 		
-		SDL_RenderCopy(renderer, src->fTexture, &srcrect, &dstrect);
+		if (deferred)
+			DrawQueue::Copy(this, src->fTexture, &srcrect, &dstrect);
+		else
+			SDL_RenderCopy(renderer, src->fTexture, &srcrect, &dstrect);
+		
 		x += src->tex_w;
 	}
 	while(x < destwd);
 
+	if (!deferred && this != screen)
+		SetAsTarget(false);
+}
+
+// copy from a raw texture with rects which are already scaled and clipped.
+// goes through the draw queue like everything else drawn to the surface.
+void NXSurface::DrawTexture(SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+	if (headless || software_render) return;
+
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Copy(this, texture, srcrect, dstrect);
+		return;
+	}
+
+	if (this != screen)
+		SetAsTarget(true);
+
+	if (SDL_RenderCopy(renderer, texture, srcrect, dstrect))
+	{
+		staterr("NXSurface::DrawTexture: SDL_RenderCopy failed: %s", SDL_GetError());
+	}
+
 	if (this != screen)
 		SetAsTarget(false);
 }
 
+// copy from a raw SDL_Surface in SOFTBLIT_FORMAT, with rects which are
+// already scaled and clipped. only the software renderer has these.
+void NXSurface::DrawPixels(SDL_Surface *pixels, const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+	if (!software_render || !pixels) return;
+
+	SoftBlit::Copy(pixels, srcrect, fPixels, dstrect);
+}
+
 /*
 void c------------------------------() {}
 */
 
 #if defined(CONFIG_BATCH_RENDERING)
 
+// while the draw queue is recording, it does the batching itself
+// and these just go into it like any other copy.
+// the software renderer has nothing to batch, and draws each one right away.
 void NXSurface::DrawBatchBegin(size_t max_count)
 {
+	if (headless || software_render || DrawQueue::IsRecording()) return;
+
 	bool res = GraphicHacks::BatchBegin(renderer, max_count);
 	assert(!res);
 }
 
 void NXSurface::DrawBatchAdd(NXSurface *src, int dstx, int dsty, int srcx, int srcy, int wd, int ht)
 {
+	if (software_render)
+	{
+		DrawSurface(src, dstx, dsty, srcx, srcy, wd, ht);
+		return;
+	}
+
+	if (headless) return;
+
 	assert(renderer);
 	assert(src->fTexture);
 
@@ -291,6 +443,12 @@ void NXSurface::DrawBatchAdd(NXSurface *src, int dstx, int dsty, int srcx, int s
 
 	if (need_clip) clip(srcrect, dstrect);
 	
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Copy(this, src->fTexture, &srcrect, &dstrect);
+		return;
+	}
+	
 	if (GraphicHacks::BatchAddCopy(renderer, src->fTexture, &srcrect, &dstrect))
 	{
 		staterr("NXSurface::DrawBatchAdd: GraphicHacks::BatchAddCopy failed");
@@ -305,6 +463,14 @@ void NXSurface::DrawBatchAdd(NXSurface *src, int dstx, int dsty)
 void NXSurface::DrawBatchAddPatternAcross(NXSurface *src,
                                           int x_dst, int y_dst, int y_src, int height)
 {
+	if (software_render)
+	{
+		BlitPatternAcross(src, x_dst, y_dst, y_src, height);
+		return;
+	}
+
+	if (headless) return;
+
 	SDL_Rect srcrect, dstrect;
     
 	srcrect.x = 0;
@@ -326,7 +492,11 @@ void NXSurface::DrawBatchAddPatternAcross(NXSurface *src,
 		dstrect.x = x;
 		dstrect.y = y;
 		
-		GraphicHacks::BatchAddCopy(renderer, src->fTexture, &srcrect, &dstrect);
+		if (DrawQueue::IsRecording())
+			DrawQueue::Copy(this, src->fTexture, &srcrect, &dstrect);
+		else
+			GraphicHacks::BatchAddCopy(renderer, src->fTexture, &srcrect, &dstrect);
+		
 		x += src->tex_w;
 	}
 	while(x < destwd);
@@ -334,6 +504,8 @@ void NXSurface::DrawBatchAddPatternAcross(NXSurface *src,
 
 void NXSurface::DrawBatchEnd()
 {
+	if (headless || software_render || DrawQueue::IsRecording()) return;
+
 	bool res = GraphicHacks::BatchEnd(renderer);
 	assert(!res);
 }
@@ -369,6 +541,21 @@ void c------------------------------() {}
 
 void NXSurface::DrawLine(int x1, int y1, int x2, int y2, NXColor color)
 {
+	if (software_render)
+	{
+		SoftBlit::Line(fPixels, x1 * SCALE, y1 * SCALE, x2 * SCALE, y2 * SCALE, \
+						SoftBlit::MapColor(color.r, color.g, color.b));
+		return;
+	}
+
+	if (headless) return;
+
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Line(this, x1 * SCALE, y1 * SCALE, x2 * SCALE, y2 * SCALE, color.r, color.g, color.b);
+		return;
+	}
+
 	if (this != screen)
 		SetAsTarget(true);
 
@@ -381,8 +568,7 @@ void NXSurface::DrawLine(int x1, int y1, int x2, int y2, NXColor color)
 
 void NXSurface::DrawRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, uint8_t b)
 {
-	if (this != screen)
-		SetAsTarget(true);
+	if (headless && !software_render) return;
 
 	SDL_Rect rects[4] = {
 		{x1 * SCALE, y1 * SCALE, ((x2 - x1) + 1) * SCALE, SCALE},
@@ -391,6 +577,25 @@ void NXSurface::DrawRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, u
 		{x2 * SCALE, y1 * SCALE, SCALE,                   ((y2 - y1) + 1) * SCALE}
 	};
 
+	if (software_render)
+	{
+		for(int i=0;i<4;i++)
+			SoftBlit::Fill(fPixels, &rects[i], SoftBlit::MapColor(r, g, b));
+		
+		return;
+	}
+	
+	if (DrawQueue::IsRecording())
+	{
+		for(int i=0;i<4;i++)
+			DrawQueue::Fill(this, &rects[i], r, g, b, SDL_ALPHA_OPAQUE);
+		
+		return;
+	}
+
+	if (this != screen)
+		SetAsTarget(true);
+
 	SDL_SetRenderDrawColor(renderer, r, g, b, SDL_ALPHA_OPAQUE);
 	SDL_RenderFillRects(renderer, rects, 4);
 
@@ -401,8 +606,7 @@ void NXSurface::DrawRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, u
 
 void NXSurface::FillRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, uint8_t b)
 {
-	if (this != screen)
-		SetAsTarget(true);
+	if (headless && !software_render) return;
 
 	SDL_Rect rect;
 
@@ -411,6 +615,21 @@ void NXSurface::FillRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, u
 	rect.w = ((x2 - x1) + 1) * SCALE;
 	rect.h = ((y2 - y1) + 1) * SCALE;
 	
+	if (software_render)
+	{
+		SoftBlit::Fill(fPixels, &rect, SoftBlit::MapColor(r, g, b));
+		return;
+	}
+	
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Fill(this, &rect, r, g, b, SDL_ALPHA_OPAQUE);
+		return;
+	}
+
+	if (this != screen)
+		SetAsTarget(true);
+
 	SDL_SetRenderDrawColor(renderer, r, g, b, SDL_ALPHA_OPAQUE);
 	SDL_RenderFillRect(renderer, &rect);
 
@@ -420,8 +639,7 @@ void NXSurface::FillRect(int x1, int y1, int x2, int y2, uint8_t r, uint8_t g, u
 
 void NXSurface::ClearRect(int x1, int y1, int x2, int y2)
 {
-	if (this != screen)
-		SetAsTarget(true);
+	if (headless && !software_render) return;
 
 	SDL_Rect rect;
 
@@ -430,6 +648,21 @@ void NXSurface::ClearRect(int x1, int y1, int x2, int y2)
 	rect.w = ((x2 - x1) + 1) * SCALE;
 	rect.h = ((y2 - y1) + 1) * SCALE;
 	
+	if (software_render)
+	{
+		SoftBlit::Fill(fPixels, &rect, 0);
+		return;
+	}
+	
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Fill(this, &rect, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
+		return;
+	}
+
+	if (this != screen)
+		SetAsTarget(true);
+
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_TRANSPARENT);
 	SDL_RenderFillRect(renderer, &rect);
 
@@ -440,6 +673,20 @@ void NXSurface::ClearRect(int x1, int y1, int x2, int y2)
 
 void NXSurface::Clear(uint8_t r, uint8_t g, uint8_t b)
 {
+	if (software_render)
+	{
+		SoftBlit::Fill(fPixels, NULL, SoftBlit::MapColor(r, g, b));
+		return;
+	}
+
+	if (headless) return;
+
+	if (DrawQueue::IsRecording())
+	{
+		DrawQueue::Clear(this, r, g, b);
+		return;
+	}
+
 	if (this != screen)
 		SetAsTarget(true);
 
@@ -475,10 +722,23 @@ NXFormat *NXSurface::Format()
 	return &tex_format;
 }
 
+// what's been drawn, if this is the software renderer, else NULL
+SDL_Surface *NXSurface::GetPixels()
+{
+	return fPixels;
+}
+
 void NXSurface::Flip()
 {
-	if (this == screen)
+	if (this == screen && !headless && software_render)
 	{
+		SDL_Surface *winsfc = SDL_GetWindowSurface(window);
+		if (!winsfc || SDL_BlitSurface(fPixels, NULL, winsfc, NULL) || SDL_UpdateWindowSurface(window))
+			staterr("NXSurface::Flip: failed to present: %s", SDL_GetError());
+	}
+	else if (this == screen && !headless)
+	{
+		DrawQueue::EndFrame();
 		SDL_RenderPresent(renderer);
 	}
 }
@@ -569,8 +829,17 @@ void c------------------------------() {}
 
 void NXSurface::Free()
 {
+	if (fPixels)
+	{
+		SDL_FreeSurface(fPixels);
+		fPixels = NULL;
+	}
+
 	if (fTexture)
 	{
+		// anything still queued might be using it
+		DrawQueue::Flush();
+		
 		SDL_DestroyTexture(fTexture);
 		fTexture = NULL;
 	}
@@ -580,6 +849,8 @@ void NXSurface::Free()
 
 void NXSurface::SetAsTarget(bool enabled)
 {
+	if (headless || software_render) return;
+
 	// stat("NXSurface::SetAsTarget this = %p, enabled = %d", this, (int)enabled);
 
 	if (SDL_SetRenderTarget(renderer, (enabled ? fTexture : NULL)))
@@ -68,6 +68,7 @@ public:
 	~NXSurface();
 	
 	bool AllocNew(int wd, int ht, NXFormat *format = screen->Format());
+	bool AllocTransparent(int wd, int ht);
 	bool LoadImage(const char *pbm_name, bool use_colorkey=false, int use_display_format=-1);
 	static NXSurface *FromFile(const char *pbm_name, bool use_colorkey=false, int use_display_format=-1);
 	
@@ -75,6 +76,8 @@ public:
 	void DrawSurface(NXSurface *src, int dstx, int dsty);
 	void DrawSurface(NXSurface *src, int dstx, int dsty, int srcx, int srcy, int wd, int ht);
 	void BlitPatternAcross(NXSurface *src, int x_dst, int y_dst, int y_src, int height);
+	void DrawTexture(SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_Rect *dstrect);
+	void DrawPixels(SDL_Surface *pixels, const SDL_Rect *srcrect, const SDL_Rect *dstrect);
 	
 	void DrawBatchBegin(size_t max_count);
 	void DrawBatchAdd(NXSurface *src, int dstx, int dsty, int srcx, int srcy, int wd, int ht);
@@ -112,6 +115,7 @@ public:
 	int Height();
 	// void EnableColorKey();
 	NXFormat *Format();
+	SDL_Surface *GetPixels();
 	
 	void Flip();
 	// SDL_Surface *GetSDLSurface() { return fSurface; }
@@ -134,6 +138,7 @@ private:
 	//SDL_Surface *fSurface;
 	// SDL_Renderer * fRenderer;
 	SDL_Texture * fTexture;
+	SDL_Surface * fPixels;		// in place of fTexture, with the software renderer
 	int tex_w;
 	int tex_h;
 	NXFormat tex_format;
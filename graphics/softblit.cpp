@@ -0,0 +1,255 @@
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "softblit.h"
+#include "softblit.fdh"
+
+#define ALPHA_MASK		0xff000000
+
+SDL_Surface *SoftBlit::Create(int wd, int ht)
+{
+	SDL_Surface *sfc = SDL_CreateRGBSurface(0, wd, ht, 32, \
+							0x00ff0000, 0x0000ff00, 0x000000ff, ALPHA_MASK);
+	if (!sfc)
+	{
+		staterr("SoftBlit::Create: failed to create a %dx%d surface: %s", wd, ht, SDL_GetError());
+		return NULL;
+	}
+
+	// only used for presenting; everything else goes through Copy
+	SDL_SetSurfaceBlendMode(sfc, SDL_BLENDMODE_NONE);
+	SDL_FillRect(sfc, NULL, 0);
+	return sfc;
+}
+
+// returns a copy of the image in SOFTBLIT_FORMAT, enlarged by scale. if the
+// image has a colorkey, pixels of that color become transparent; if it has
+// neither a colorkey nor an alpha channel, everything is made opaque.
+SDL_Surface *SoftBlit::Convert(SDL_Surface *image, int scale)
+{
+SDL_Surface *argb, *out;
+Uint32 key;
+Uint8 kr, kg, kb;
+int x, y, i;
+
+	bool haskey = (SDL_GetColorKey(image, &key) == 0);
+	bool hasalpha = (image->format->Amask != 0);
+	uint32_t keyrgb = 0;
+
+	if (haskey)
+	{
+		SDL_GetRGB(key, image->format, &kr, &kg, &kb);
+		keyrgb = (MapColor(kr, kg, kb) & ~ALPHA_MASK);
+	}
+
+	argb = SDL_ConvertSurfaceFormat(image, SOFTBLIT_FORMAT, 0);
+	if (!argb)
+	{
+		staterr("SoftBlit::Convert: SDL_ConvertSurfaceFormat failed: %s", SDL_GetError());
+		return NULL;
+	}
+
+	out = Create(image->w * scale, image->h * scale);
+	if (!out)
+	{
+		SDL_FreeSurface(argb);
+		return NULL;
+	}
+
+	for(y=0;y<argb->h;y++)
+	{
+		const uint32_t *srcrow = (const uint32_t *)((uint8_t *)argb->pixels + (y * argb->pitch));
+		uint32_t *dstrow = (uint32_t *)((uint8_t *)out->pixels + ((y * scale) * out->pitch));
+
+		for(x=0;x<argb->w;x++)
+		{
+			uint32_t p = srcrow[x];
+
+			if (haskey)
+				p = ((p & ~ALPHA_MASK) == keyrgb) ? 0 : (p | ALPHA_MASK);
+			else if (!hasalpha)
+				p |= ALPHA_MASK;
+
+			for(i=0;i<scale;i++)
+				dstrow[(x * scale) + i] = p;
+		}
+
+		// the rest of the rows for this one are the same
+		for(i=1;i<scale;i++)
+			memcpy((uint8_t *)dstrow + (i * out->pitch), dstrow, out->w * sizeof(uint32_t));
+	}
+
+	SDL_FreeSurface(argb);
+	return out;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// what SDL_BLENDMODE_BLEND does with a texture
+static inline uint32_t blend(uint32_t s, uint32_t d)
+{
+	uint32_t a = (s >> 24);
+	if (a == 0xff) return s;
+	if (a == 0) return d;
+
+	uint32_t ia = (255 - a);
+	uint32_t r = ((((s >> 16) & 0xff) * a) + (((d >> 16) & 0xff) * ia)) / 255;
+	uint32_t g = ((((s >> 8) & 0xff) * a) + (((d >> 8) & 0xff) * ia)) / 255;
+	uint32_t b = (((s & 0xff) * a) + ((d & 0xff) * ia)) / 255;
+	uint32_t da = a + (((d >> 24) * ia) / 255);
+
+	return (da << 24) | (r << 16) | (g << 8) | b;
+}
+
+// nearly every pixel is either transparent or opaque, so four at a time are
+// checked for that and merged with a mask. any partly transparent pixels
+// among them are blended one by one.
+static void copy_row(const uint32_t *s, uint32_t *d, int count)
+{
+int i = 0;
+
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi32((int)ALPHA_MASK);
+
+	for(;i+4<=count;i+=4)
+	{
+		__m128i sp = _mm_loadu_si128((const __m128i *)(s + i));
+		__m128i a = _mm_and_si128(sp, alpha);
+		__m128i clear = _mm_cmpeq_epi32(a, zero);
+		__m128i solid = _mm_cmpeq_epi32(a, alpha);
+
+		int clearbits = _mm_movemask_epi8(clear);
+		if (clearbits == 0xffff)
+			continue;
+
+		if ((clearbits | _mm_movemask_epi8(solid)) != 0xffff)
+		{
+			for(int j=0;j<4;j++)
+				d[i + j] = blend(s[i + j], d[i + j]);
+
+			continue;
+		}
+
+		__m128i dp = _mm_loadu_si128((const __m128i *)(d + i));
+		dp = _mm_or_si128(_mm_and_si128(clear, dp), _mm_andnot_si128(clear, sp));
+		_mm_storeu_si128((__m128i *)(d + i), dp);
+	}
+#endif
+
+	for(;i<count;i++)
+		d[i] = blend(s[i], d[i]);
+}
+
+static void fill_row(uint32_t *d, int count, uint32_t color)
+{
+int i = 0;
+
+#if defined(__SSE2__)
+	const __m128i c = _mm_set1_epi32((int)color);
+
+	for(;i+4<=count;i+=4)
+		_mm_storeu_si128((__m128i *)(d + i), c);
+#endif
+
+	for(;i<count;i++)
+		d[i] = color;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void SoftBlit::Copy(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect)
+{
+int sx, sy, dx, dy, w, h;
+
+	sx = srcrect->x; sy = srcrect->y;
+	dx = dstrect->x; dy = dstrect->y;
+	w = srcrect->w; h = srcrect->h;
+
+	// clip to the source...
+	if (sx < 0) { dx -= sx; w += sx; sx = 0; }
+	if (sy < 0) { dy -= sy; h += sy; sy = 0; }
+	if (sx + w > src->w) w = (src->w - sx);
+	if (sy + h > src->h) h = (src->h - sy);
+
+	// ...and to the destination
+	if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+	if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+	if (dx + w > dst->w) w = (dst->w - dx);
+	if (dy + h > dst->h) h = (dst->h - dy);
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	const uint8_t *s = (const uint8_t *)src->pixels + (sy * src->pitch) + (sx * sizeof(uint32_t));
+	uint8_t *d = (uint8_t *)dst->pixels + (dy * dst->pitch) + (dx * sizeof(uint32_t));
+
+	while(h--)
+	{
+		copy_row((const uint32_t *)s, (uint32_t *)d, w);
+		s += src->pitch;
+		d += dst->pitch;
+	}
+}
+
+// fills the rect (or the whole surface if it's NULL) with the color as is,
+// alpha and all, without blending.
+void SoftBlit::Fill(SDL_Surface *dst, const SDL_Rect *rect, uint32_t color)
+{
+int x1, y1, x2, y2;
+
+	if (rect)
+	{
+		x1 = (rect->x < 0) ? 0 : rect->x;
+		y1 = (rect->y < 0) ? 0 : rect->y;
+		x2 = rect->x + rect->w;
+		y2 = rect->y + rect->h;
+		if (x2 > dst->w) x2 = dst->w;
+		if (y2 > dst->h) y2 = dst->h;
+	}
+	else
+	{
+		x1 = y1 = 0;
+		x2 = dst->w;
+		y2 = dst->h;
+	}
+
+	if (x2 <= x1 || y2 <= y1)
+		return;
+
+	uint8_t *d = (uint8_t *)dst->pixels + (y1 * dst->pitch) + (x1 * sizeof(uint32_t));
+	for(int y=y1;y<y2;y++)
+	{
+		fill_row((uint32_t *)d, (x2 - x1), color);
+		d += dst->pitch;
+	}
+}
+
+// a one pixel wide line, with both end points included
+void SoftBlit::Line(SDL_Surface *dst, int x1, int y1, int x2, int y2, uint32_t color)
+{
+	int dx = abs(x2 - x1), sx = (x1 < x2) ? 1 : -1;
+	int dy = -abs(y2 - y1), sy = (y1 < y2) ? 1 : -1;
+	int err = (dx + dy);
+
+	for(;;)
+	{
+		if ((unsigned)x1 < (unsigned)dst->w && (unsigned)y1 < (unsigned)dst->h)
+			((uint32_t *)((uint8_t *)dst->pixels + (y1 * dst->pitch)))[x1] = color;
+
+		if (x1 == x2 && y1 == y2)
+			break;
+
+		int e2 = (err * 2);
+		if (e2 >= dy) { err += dy; x1 += sx; }
+		if (e2 <= dx) { err += dx; y1 += sy; }
+	}
+}
@@ -0,0 +1,28 @@
+#ifndef _SOFTBLIT_H
+#define _SOFTBLIT_H
+
+#include <SDL.h>
+
+#define SOFTBLIT_FORMAT		SDL_PIXELFORMAT_ARGB8888
+
+// pixel routines for the software renderer, where every NXSurface is an
+// SDL_Surface in SOFTBLIT_FORMAT instead of a texture. alpha is 0 for
+// transparent pixels (what was the colorkey) and 255 for everything else;
+// copies skip transparent pixels and blend anything in between. rects are
+// in final (scaled) pixels and are clipped to both surfaces.
+namespace SoftBlit
+{
+	SDL_Surface *Create(int wd, int ht);
+	SDL_Surface *Convert(SDL_Surface *image, int scale);
+
+	void Copy(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, const SDL_Rect *dstrect);
+	void Fill(SDL_Surface *dst, const SDL_Rect *rect, uint32_t color);
+	void Line(SDL_Surface *dst, int x1, int y1, int x2, int y2, uint32_t color);
+
+	static inline uint32_t MapColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = SDL_ALPHA_OPAQUE)
+	{
+		return ((uint32_t)a << 24) | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+	}
+};
+
+#endif
@@ -13,9 +13,17 @@
 using namespace Graphics;
 
 #include "sprites.h"
+#include "atlas.h"
 #include "sprites.fdh"
 
-static NXSurface *spritesheet[MAX_SPRITESHEETS];
+// where each sheet's image ended up once loaded
+static struct SheetInfo
+{
+	NXSurface *sfc;		// an atlas page, or a surface of its own if it wasn't packed
+	int x, y;			// position of the image on sfc
+	bool own;			// sfc belongs to this sheet alone
+} sheets[MAX_SPRITESHEETS];
+
 static int num_spritesheets;
 static StringList sheetfiles;
 
@@ -27,7 +35,7 @@ static bool batch_draw_enabled = false;
 
 bool Sprites::Init()
 {
-	memset(spritesheet, 0, sizeof(spritesheet));
+	memset(sheets, 0, sizeof(sheets));
 	
 	// load sprites info--sheet positions, bounding boxes etc
 	if (load_sif("sprites.sif"))
@@ -47,12 +55,12 @@ void Sprites::FlushSheets()
 {
 	for(int i=0;i<MAX_SPRITESHEETS;i++)
 	{
-		if (spritesheet[i])
-		{
-			delete spritesheet[i];
-			spritesheet[i] = NULL;
-		}
+		if (sheets[i].own)
+			delete sheets[i].sfc;
 	}
+	
+	memset(sheets, 0, sizeof(sheets));
+	Atlas::Clear();
 }
 
 /*
@@ -62,20 +70,35 @@ void c------------------------------() {}
 // ensure the given spritesheet is loaded
 static void Sprites::LoadSheetIfNeeded(int sheetno)
 {
-	if (!spritesheet[sheetno])
+	if (!sheets[sheetno].sfc)
 	{
 		char pbm_name[MAXPATHLEN];
+		SheetInfo *sheet = &sheets[sheetno];
 		
 		sprintf(pbm_name, "%s/%s", data_dir, sheetfiles.StringAt(sheetno));
-		spritesheet[sheetno] = new NXSurface;
-		spritesheet[sheetno]->LoadImage(pbm_name, true);
+		NXSurface *image = new NXSurface;
+		bool failed = image->LoadImage(pbm_name, true);
 		
 		// fix the blue dash in the middle of the starpoof effect on that one frame,
 		// I'm pretty sure this is a glitch.
 		if (!settings->emulate_bugs)
 		{
 			if (sheetno == 3)	// Caret.pbm
-				spritesheet[sheetno]->FillRect(40, 58, 41, 58, 0, 0, 0);
+				image->FillRect(40, 58, 41, 58, 0, 0, 0);
+		}
+		
+		// move it into the atlas if there's room, so that it can be drawn
+		// from in the same batches as the other sheets.
+		if (!failed && !Atlas::Add(image, &sheet->sfc, &sheet->x, &sheet->y))
+		{
+			delete image;
+			sheet->own = false;
+		}
+		else
+		{
+			sheet->sfc = image;
+			sheet->x = sheet->y = 0;
+			sheet->own = true;
 		}
 	}
 }
@@ -90,24 +113,25 @@ static void Sprites::BlitSprite(int x, int y, int s, int frame, uint8_t dir, \
 								int xoff, int yoff, int wd, int ht)
 {
 	LoadSheetIfNeeded(sprites[s].spritesheet);
+	SheetInfo *sheet = &sheets[sprites[s].spritesheet];
 	
 	dir %= sprites[s].ndirs;
 	SIFDir *sprdir = &sprites[s].frame[frame].dir[dir];
 	
     if (batch_draw_enabled)
     {
-        DrawBatchAdd(spritesheet[sprites[s].spritesheet], \
+        DrawBatchAdd(sheet->sfc, \
                      x, y, \
-                     (sprdir->sheet_offset.x + xoff), \
-                     (sprdir->sheet_offset.y + yoff), \
+                     (sheet->x + sprdir->sheet_offset.x + xoff), \
+                     (sheet->y + sprdir->sheet_offset.y + yoff), \
                      wd, ht);
     }
     else
     {
-        DrawSurface(spritesheet[sprites[s].spritesheet], \
+        DrawSurface(sheet->sfc, \
                     x, y, \
-                    (sprdir->sheet_offset.x + xoff), \
-                    (sprdir->sheet_offset.y + yoff), \
+                    (sheet->x + sprdir->sheet_offset.x + xoff), \
+                    (sheet->y + sprdir->sheet_offset.y + yoff), \
                     wd, ht);
     }
 }
@@ -197,11 +221,15 @@ void Sprites::draw_sprite_repeating_x(int x, int y, int s, int frame, int wd)
 void c------------------------------() {}
 */
 
-// return the NXSurface for a given spritesheet #
-NXSurface *Sprites::get_spritesheet(int sheetno)
+// return the NXSurface for a given spritesheet #. that may be an atlas page
+// with other sheets on it, in which case the sheet starts at x_out, y_out.
+NXSurface *Sprites::get_spritesheet(int sheetno, int *x_out, int *y_out)
 {
 	LoadSheetIfNeeded(sheetno);
-	return spritesheet[sheetno];
+	
+	if (x_out) *x_out = sheets[sheetno].x;
+	if (y_out) *y_out = sheets[sheetno].y;
+	return sheets[sheetno].sfc;
 }
 
 // create an empty spritesheet of the given size and return it's index.
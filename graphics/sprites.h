@@ -32,7 +32,7 @@ namespace Sprites
     
     RectI get_sprite_rect(int x, int y, int s, int frame=0, uint8_t dir=0);
 	
-	NXSurface *get_spritesheet(int sheetno);
+	NXSurface *get_spritesheet(int sheetno, int *x_out = NULL, int *y_out = NULL);
 	int create_spritesheet(int wd, int ht);
 	void draw_sprite_to_surface(NXSurface *dst, int x, int y, int s, int frame, uint8_t dir);
 
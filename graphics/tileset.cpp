@@ -13,8 +13,9 @@ using namespace Graphics;
 extern const char *tileset_names[];		// from stagedata.cpp
 extern const char *stage_dir;			// from main
 
-static NXSurface *tileset;
-static int current_tileset = -1;
+// every thread has its own, as the stage its world is in decides which
+static NX_THREAD NXSurface *tileset;
+static NX_THREAD int current_tileset = -1;
 
 bool Tileset::Init()
 {
@@ -0,0 +1,222 @@
+
+#include <algorithm>
+#include <vector>
+
+#include "nx.h"
+#include "hitgrid.h"
+
+#define GRID_FLAGS		(FLAG_SHOOTABLE | FLAG_INVULNERABLE)
+
+// the grid belongs to the World
+#define cellhead		(world->fHitGrid.cellhead)
+#define cellgen			(world->fHitGrid.cellgen)
+#define nodes			(world->fHitGrid.nodes)
+#define curgen			(world->fHitGrid.curgen)
+#define gridw			(world->fHitGrid.gridw)
+#define gridh			(world->fHitGrid.gridh)
+#define candidates		(world->fHitGrid.candidates)
+#define active			(world->fHitGrid.active)
+#define valid			(world->fHitGrid.valid)
+#define built_last		(world->fHitGrid.built_last)
+
+/*
+void c------------------------------() {}
+*/
+
+static inline bool is_shot(int type)
+{
+	return (type >= OBJ_SHOTS_START && type <= OBJ_SHOTS_END);
+}
+
+void HitGrid::BeginAI()
+{
+	active = true;
+	valid = false;
+}
+
+// called after each object has run it's AI. player shots don't move anything
+// but themselves, so the grid can survive them, as long as the shot isn't
+// itself something that can be shot at.
+void HitGrid::AfterAI(Object *o, int oldtype)
+{
+	if (!is_shot(oldtype) || !is_shot(o->type) || (o->flags & GRID_FLAGS))
+		valid = false;
+}
+
+void HitGrid::EndAI()
+{
+	active = false;
+	valid = false;
+}
+
+void HitGrid::Invalidate()
+{
+	valid = false;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static inline int cell_clamp(int v, int max)
+{
+	if (v < 0) return 0;
+	if (v >= max) return (max - 1);
+	return v;
+}
+
+// the range of cells touched by an object's bounding box. bboxes are allowed
+// to be inside-out, so this covers the whole span between both edges.
+static void get_cells(Object *o, int *x1, int *y1, int *x2, int *y2)
+{
+	int l = o->Left(), r = o->Right();
+	int t = o->Top(), b = o->Bottom();
+
+	if (l > r) { int temp = l; l = r; r = temp; }
+	if (t > b) { int temp = t; t = b; b = temp; }
+
+	*x1 = cell_clamp((l >> CSF) / TILE_W, gridw);
+	*x2 = cell_clamp((r >> CSF) / TILE_W, gridw);
+	*y1 = cell_clamp((t >> CSF) / TILE_H, gridh);
+	*y2 = cell_clamp((b >> CSF) / TILE_H, gridh);
+}
+
+static void rebuild()
+{
+Object *o;
+int x1, y1, x2, y2;
+int x, y;
+
+	int w = (map.xsize > 0) ? map.xsize : 1;
+	int h = (map.ysize > 0) ? map.ysize : 1;
+
+	if (w != gridw || h != gridh)
+	{
+		gridw = w;
+		gridh = h;
+		cellhead.resize(w * h);
+		cellgen.assign(w * h, 0);
+		curgen = 0;
+	}
+
+	// bumping the generation empties every cell at once
+	if (++curgen == 0)
+	{
+		std::fill(cellgen.begin(), cellgen.end(), 0);
+		curgen = 1;
+	}
+
+	nodes.clear();
+
+	FOREACH_OBJECT(o)
+	{
+		if (!(o->flags & GRID_FLAGS))
+			continue;
+
+		get_cells(o, &x1, &y1, &x2, &y2);
+
+		for(y=y1;y<=y2;y++)
+		for(x=x1;x<=x2;x++)
+		{
+			int cell = (y * gridw) + x;
+			if (cellgen[cell] != curgen)
+			{
+				cellgen[cell] = curgen;
+				cellhead[cell] = -1;
+			}
+
+			HitGridNode node;
+			node.o = o;
+			node.next = cellhead[cell];
+
+			cellhead[cell] = nodes.size();
+			nodes.push_back(node);
+		}
+	}
+
+	built_last = lastobject;
+	valid = true;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static inline bool is_hit(Object *enemy, Object *shot, uint32_t flags_to_exclude)
+{
+	return ((enemy->flags & GRID_FLAGS) && \
+			(enemy->flags & flags_to_exclude) == 0 && \
+			hitdetect(enemy, shot));
+}
+
+// brute-force check of every object from "o" to the end of the list
+static Object *scan(Object *o, Object *shot, uint32_t flags_to_exclude)
+{
+	for(;o;o=o->next)
+	{
+		if (is_hit(o, shot, flags_to_exclude))
+			return o;
+	}
+
+	return NULL;
+}
+
+// objects are only ever added at the end of the list, so serial order is list order
+static bool serial_less(Object *a, Object *b)
+{
+	return (a->serial < b->serial);
+}
+
+// returns the first object after "after" in the object list (or from the
+// start of the list if "after" is NULL) that is shootable or invulnerable,
+// has none of flags_to_exclude set, and whose bbox is touching the shot.
+Object *HitGrid::FindNext(Object *shot, uint32_t flags_to_exclude, Object *after)
+{
+int x1, y1, x2, y2;
+int x, y;
+int i;
+
+	if (!active)
+		return scan(after ? after->next : firstobject, shot, flags_to_exclude);
+
+	if (!valid)
+		rebuild();
+
+	uint32_t minserial = after ? after->serial : 0;
+	candidates.clear();
+
+	get_cells(shot, &x1, &y1, &x2, &y2);
+	for(y=y1;y<=y2;y++)
+	for(x=x1;x<=x2;x++)
+	{
+		int cell = (y * gridw) + x;
+		if (cellgen[cell] != curgen)
+			continue;
+
+		for(int n=cellhead[cell];n>=0;n=nodes[n].next)
+		{
+			if (nodes[n].o->serial > minserial)
+				candidates.push_back(nodes[n].o);
+		}
+	}
+
+	// objects which span several cells show up more than once
+	if (candidates.size() > 1)
+		std::sort(candidates.begin(), candidates.end(), serial_less);
+
+	for(i=0;i<(int)candidates.size();i++)
+	{
+		if (i > 0 && candidates[i] == candidates[i - 1])
+			continue;
+
+		if (is_hit(candidates[i], shot, flags_to_exclude))
+			return candidates[i];
+	}
+
+	// anything created since the grid was built is at the end of the list
+	Object *tail = built_last ? built_last->next : firstobject;
+	if (after && tail && after->serial >= tail->serial)
+		tail = after->next;
+
+	return scan(tail, shot, flags_to_exclude);
+}
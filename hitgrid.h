@@ -0,0 +1,49 @@
+#ifndef _HITGRID_H
+#define _HITGRID_H
+
+#include <vector>
+
+// broadphase for player shots vs. enemies. shootable and invulnerable objects
+// are bucketed into a grid of map tiles, so a shot only has to look at the
+// objects near it instead of every object in the stage.
+//
+// the grid is only trusted while Objects::RunAI is running the AI of player
+// shots, which move nothing but themselves; anything else which could move an
+// enemy or change it's flags (other AI, Kill) throws it away and it is rebuilt
+// on the next query. objects created since the last rebuild are checked
+// directly. the end result is exactly what a scan of the whole object list
+// would find, in the same order.
+namespace HitGrid
+{
+	void BeginAI();
+	void AfterAI(Object *o, int oldtype);
+	void EndAI();
+
+	void Invalidate();
+
+	Object *FindNext(Object *shot, uint32_t flags_to_exclude, Object *after);
+};
+
+struct HitGridNode
+{
+	Object *o;
+	int next;		// index of next node in the same cell, or -1
+};
+
+// the grid itself, which belongs to the World (see world.h)
+struct HitGridState
+{
+	std::vector<int> cellhead;
+	std::vector<uint32_t> cellgen;	// cellhead is only valid if this matches curgen
+	std::vector<HitGridNode> nodes;
+	uint32_t curgen;
+	int gridw, gridh;
+	
+	std::vector<Object *> candidates;
+	
+	bool active;			// inside Objects::RunAI
+	bool valid;				// grid still matches the objects
+	Object *built_last;		// lastobject at the time the grid was built
+};
+
+#endif
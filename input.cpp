@@ -1,5 +1,9 @@
 #include <map>
+#include <SDL.h>
+#include "input.h"
 
+// ahead of nx.h, as map there is the current world's
+typedef std::map<SDL_Keycode, INPUTS> mappings_t;
 
 #include "nx.h"
 #include "input.fdh"
@@ -7,7 +11,6 @@
 
 #include "vjoy.h"
 
-typedef std::map<SDL_Keycode, INPUTS> mappings_t;
 mappings_t mappings;
 
 INPUTS have_mapping(SDL_Keycode keycode)
@@ -20,8 +23,9 @@ INPUTS have_mapping(SDL_Keycode keycode)
 }
 
 
-bool inputs[INPUT_COUNT];
-bool lastinputs[INPUT_COUNT];
+// replays feed these from whichever thread plays them back
+NX_THREAD bool inputs[INPUT_COUNT];
+NX_THREAD bool lastinputs[INPUT_COUNT];
 int last_sdl_key;
 
 bool input_init(void)
@@ -138,7 +142,7 @@ int ino, key;
 				
 				#ifndef __SDLSHIM__
 				static uint8_t shiftstates = 0;
-				extern bool freezeframe;
+				extern NX_THREAD bool freezeframe;
 				
 				if (console.IsVisible() && !IsNonConsoleKey(key))
 				{
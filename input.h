@@ -2,6 +2,8 @@
 #ifndef _INPUT_H
 #define _INPUT_H
 
+#include "common/basics.h"
+
 enum INPUTS
 {
 	LEFTKEY, RIGHTKEY, UPKEY, DOWNKEY,
@@ -37,8 +39,8 @@ enum INPUTS
 #define DEBUG_SAVE_KEY		F4KEY
 #define FFWDKEY				F5KEY
 
-extern bool inputs[INPUT_COUNT];
-extern bool lastinputs[INPUT_COUNT];
+extern NX_THREAD bool inputs[INPUT_COUNT];
+extern NX_THREAD bool lastinputs[INPUT_COUNT];
 extern int last_sdl_key;
 
 #endif
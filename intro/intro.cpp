@@ -4,13 +4,14 @@
 #include "intro.fdh"
 #include "../vjoy.h"
 
-static int blanktimer;
+static NX_THREAD int blanktimer;
+static NX_THREAD bool blanked;		// the screen is black, between the intro and the title
 #define EXIT_DELAY				20		// delay between intro and title screen
 
 bool intro_init(int param)
 {
 	music(0);
-	fade.set_full(FADE_OUT);
+	world->fFade.set_full(FADE_OUT);
 	
 	game.switchstage.mapno = STAGE_KINGS;
 	game.switchstage.playerx = 0;
@@ -23,10 +24,9 @@ bool intro_init(int param)
 
 void intro_tick()
 {
-	if (blanktimer > 0)
+	blanked = (blanktimer > 0);
+	if (blanked)
 	{
-		ClearScreen(BLACK);
-		
 		if (--blanktimer == 0)
 			game.setmode(GM_TITLE);
 		return;
@@ -52,6 +52,14 @@ void intro_tick()
 	}
 }
 
+void intro_draw()
+{
+	if (blanked)
+		ClearScreen(BLACK);
+	else
+		game_draw_normal();
+}
+
 /*
 void c------------------------------() {}
 */
@@ -118,7 +126,7 @@ void ai_intro_crown(Object *o)
 		{
 			if ((++o->timer % 8) == 1)
 			{
-				effect(o->x + random(-8<<CSF, 8<<CSF),
+				effect(o->x + fxrandom(-8<<CSF, 8<<CSF),
 						o->y + (8<<CSF),
 						   EFFECT_GHOST_SPARKLE);
 			}
@@ -5,5 +5,6 @@
 
 bool intro_init(int param);
 void intro_tick();
+void intro_draw();
 
 #endif
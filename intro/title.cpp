@@ -32,6 +32,7 @@ static struct
 	int selchoice, seldelay;
 	int kc_pos;
 	bool in_multiload;
+	bool blank;				// black screen while an option is being selected
 	
 	uint32_t besttime;		// Nikumaru display
 } title;
@@ -72,11 +73,13 @@ bool title_init(int param)
 
 void title_tick()
 {
+	title.blank = false;
+	
 	if (!title.in_multiload)
 	{
 		if (title.seldelay > 0)
 		{
-			ClearScreen(BLACK);
+			title.blank = true;
 			
 			title.seldelay--;
 			if (!title.seldelay)
@@ -86,12 +89,17 @@ void title_tick()
 		}
 		
 		handle_input();
-		draw_title();
+		
+		// animate character
+		if (++title.seltimer > 8)
+		{
+			title.seltimer = 0;
+			if (++title.selframe >= sprites[title.sprite].nframes)
+				title.selframe = 0;
+		}
 	}
 	else
 	{
-		ClearScreen(BLACK);
-		
 		if (!textbox.SaveSelect.IsVisible())
 		{	// selection was made, and settings.last_save_slot is now set appropriately
 			
@@ -101,14 +109,32 @@ void title_tick()
 			title.selchoice = 1;
 			title.seldelay = SELECT_LOAD_DELAY;
 			title.in_multiload = false;
+			title.blank = true;
 		}
 		else
 		{
-			textbox.Draw();
+			textbox.Run();
 		}
 	}
 }
 
+void title_draw()
+{
+	if (title.blank)
+	{
+		ClearScreen(BLACK);
+	}
+	else if (title.in_multiload)
+	{
+		ClearScreen(BLACK);
+		textbox.Draw();
+	}
+	else
+	{
+		draw_title();
+	}
+}
+
 
 /*
 void c------------------------------() {}
@@ -176,6 +202,9 @@ static void handle_input()
 
             cy += (sprites[SPR_MENU].h + 18);
         }
+        
+        if (VJoy::ModeAware::wasTap(options_rect()))
+            game.pause(GP_OPTIONS);
     }
 #endif
     
@@ -271,14 +300,6 @@ static void draw_title()
 		cy += (sprites[SPR_MENU].h + 18);
 	}
 	
-	// animate character
-	if (++title.seltimer > 8)
-	{
-		title.seltimer = 0;
-		if (++title.selframe >= sprites[title.sprite].nframes)
-			title.selframe = 0;
-	}
-	
 	// accreditation
 	cx = (Graphics::SCREEN_WIDTH / 2) - (sprites[SPR_PIXEL_FOREVER].w / 2);
 	int acc_y = Graphics::SCREEN_HEIGHT - 48;
@@ -297,24 +318,26 @@ static void draw_title()
     
     // options
     {
-        const char *str = "F3:Options";
-        cx = (Graphics::SCREEN_WIDTH / 2) - (GetFontWidth(str, 0) / 2) - 4;
-        cy = (Graphics::SCREEN_HEIGHT - 8) - GetFontHeight();
-        int f3wd = font_draw(cx, cy, "F3", 0);
-        font_draw(cx + f3wd, cy, ":Options", 0, &bluefont);
+        RectI r = options_rect();
+        int f3wd = font_draw(r.x, r.y, "F3", 0);
+        font_draw(r.x + f3wd, r.y, ":Options", 0, &bluefont);
         
 #ifdef CONFIG_USE_TAPS
-        RectI r = RectI(cx, cy, GetFontWidth(str, 0), GetFontHeight());
         debug_absbox(r.x, r.y, r.x + r.w, r.y + r.h, 255, 255, 255);
-        if (VJoy::ModeAware::wasTap(r))
-        {
-            game.pause(GP_OPTIONS);
-        }
 #endif
-        
     }
 }
 
+// where "F3:Options" is drawn, and can be tapped
+static RectI options_rect()
+{
+	const char *str = "F3:Options";
+	int x = (Graphics::SCREEN_WIDTH / 2) - (GetFontWidth(str, 0) / 2) - 4;
+	int y = (Graphics::SCREEN_HEIGHT - 8) - GetFontHeight();
+	
+	return RectI(x, y, GetFontWidth(str, 0), GetFontHeight());
+}
+
 
 
 static int kc_table[] = { UPKEY, UPKEY, DOWNKEY, DOWNKEY,
@@ -5,5 +5,6 @@
 
 bool title_init(int param);
 void title_tick();
+void title_draw();
 
 #endif
@@ -15,7 +15,7 @@
 #define ITEMS_X			10
 #define ITEMS_Y			60
 
-static stInventory inv;
+static NX_THREAD stInventory inv;
 
 // can't enter Inven if
 //  * script is running
@@ -57,8 +57,15 @@ void inventory_tick(void)
 {
 	// run the selectors
 	RunSelector(inv.curselector);
+	AnimateSelector(&inv.armssel);
+	AnimateSelector(&inv.itemsel);
 	
-	// draw
+	RunScene();
+	textbox.Run();
+}
+
+void inventory_draw(void)
+{
 	DrawScene();
 	DrawInventory();
 	textbox.Draw();
@@ -399,11 +406,8 @@ static void ExitInventory(void)
 
 
 
-static void DrawSelector(stSelector *selector, int x, int y)
+static void AnimateSelector(stSelector *selector)
 {
-int selx, sely;
-int xsel, ysel;
-
 	if (selector == inv.curselector)
 	{
 		// flash the box
@@ -418,7 +422,13 @@ int xsel, ysel;
 		selector->flashstate = 1;
 		selector->animtimer = 99;		// light up immediately upon becoming active
 	}
-	
+}
+
+static void DrawSelector(stSelector *selector, int x, int y)
+{
+int selx, sely;
+int xsel, ysel;
+
 	if (selector->rowlen)
 	{
 		xsel = (selector->cursel % selector->rowlen);
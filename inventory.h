@@ -33,6 +33,7 @@ struct stInventory
 
 bool inventory_init(int param);
 void inventory_tick(void);
+void inventory_draw(void);
 
 enum INVENTORY
 {
@@ -7,6 +7,13 @@
 #include "graphics/safemode.h"
 #include "main.fdh"
 #include "vjoy.h"
+#include "bench.h"
+#include "batch.h"
+#include "golden.h"
+#include "profiler.h"
+#include "aicost.h"
+#include "scheduler.h"
+#include "graphics/drawqueue.h"
 
 
 #include <exception>
@@ -21,11 +28,17 @@ int fps = 0;
 static int fps_so_far = 0;
 static uint32_t fpstimer = 0;
 
-#define GAME_WAIT			(1000/GAME_FPS)	// sets framerate
+// these go with the world the thread is running
+NX_THREAD int framecount = 0;
+NX_THREAD bool freezeframe = false;
+NX_THREAD int flipacceltime = 0;
+NX_THREAD bool present_frame = true;
 
-int framecount = 0;
-bool freezeframe = false;
-int flipacceltime = 0;
+// command-line options
+static int headless_ticks = 0;		// -ticks: stop after this many ticks (0 = run until exit)
+static int start_replay = -1;		// -replay: play back this replay slot at startup
+static const char *convert_in = NULL;	// -convertrep: convert this replay and exit
+static const char *convert_out = NULL;
 
 
 // On iOS it seems to a bad idea to return from main. The screen is left to be just black.
@@ -35,7 +48,6 @@ int main(int argc, char *argv[])
 {
 bool inhibit_loadfade = false;
 bool error = false;
-bool freshstart;
 	
 	
 	if (!setup_path(argc, argv))
@@ -45,7 +57,15 @@ bool freshstart;
 	}
 	
 	SetLogFilename("debug.txt");
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+	parse_args(argc, argv);
+	
+	// conversion is pure file work, so it's done before anything else comes up
+	if (convert_in)
+		return Replay::Convert(convert_in, convert_out);
+	
+	// in headless mode there is no window, renderer or audio device;
+	// only the timer and event subsystems are brought up.
+	if (SDL_Init(headless ? 0 : (SDL_INIT_VIDEO | SDL_INIT_AUDIO)) < 0)
 	{
 		staterr("ack, sdl_init failed: %s.", SDL_GetError());
 		fatal("sdl_init fail");
@@ -60,7 +80,7 @@ bool freshstart;
 	// so we know the initial screen resolution.
 	settings_load();
 	
-	if (Graphics::init(settings->resolution)) { fatal("Failed to initialize graphics."); return 1; }
+	if (Graphics::init(Golden::IsActive() ? GOLDEN_RESOLUTION : settings->resolution)) { fatal("Failed to initialize graphics."); return 1; }
 	if (font_init()) { fatal("Failed to load font."); return 1; }
 	
 	//speed_test();
@@ -91,8 +111,6 @@ bool freshstart;
 	if (trig_init()) { fatal("Failed trig module init."); return 1; }
 	
 	if (tsc_init()) { fatal("Failed to initialize script engine."); return 1; }
-	if (textbox.Init()) { fatal("Failed to initialize textboxes."); return 1; }
-	if (Carets::init()) { fatal("Failed to initialize carets."); return 1; }
 	
 #ifdef CONFIG_USE_VJOY
 	VJoy::Init();
@@ -101,6 +119,7 @@ bool freshstart;
 	//org_test_miniloop();
 
 	if (game.init()) { fatal("game.init() error"); return 1; }
+	if (world_init()) { fatal("world_init() error"); return 1; }
 	game.setmode(GM_NORMAL);
 	// set null stage just to have something to do while we go to intro
 	game.switchstage.mapno = 0;
@@ -121,12 +140,25 @@ bool freshstart;
 			game.setmode(GM_INTRO);
 	#endif
 	
+	// with more than one job, the main thread only waits on the workers
+	if (Batch::Start())
+		goto shutdown;
+	
+	if (Bench::IsActive() || Batch::IsActive() || Golden::IsActive())
+	{
+		game.setmode(GM_NORMAL);
+		game.switchstage.mapno = START_REPLAY;
+	}
+	else if (start_replay >= 0)
+	{
+		game.setmode(GM_NORMAL);
+		game.switchstage.mapno = START_REPLAY;
+		game.switchstage.param = start_replay;
+	}
+	
 	// for debug
 	if (game.paused) { game.switchstage.mapno = 0; game.switchstage.eventonentry = 0; }
-	if (game.switchstage.mapno == LOAD_GAME) inhibit_loadfade = true;
-	
-	game.running = true;
-	freshstart = true;
+	inhibit_loadfade = (game.switchstage.mapno == LOAD_GAME);
 	
 	stat("Entering main loop...");
 	#ifdef __SDLSHIM__
@@ -136,6 +168,36 @@ bool freshstart;
 	//speed_test();
 	//return 1;
 	
+	if (run_stages(inhibit_loadfade))
+		error = true;
+	
+shutdown: ;
+	if (Batch::Finish())
+		error = true;
+	
+	if (Golden::Finish())
+		error = true;
+	
+	Profiler::StopCSV();
+	Profiler::StopTrace();
+	Scheduler::Finish();
+	world_close();
+	
+	Graphics::close();
+	input_close();
+	font_close();
+	sound_close();
+	return error;
+}
+
+// plays stage after stage in the current world, until the game stops running.
+// Batch's worker threads run their worlds through this as well.
+bool run_stages(bool inhibit_loadfade)
+{
+bool freshstart = true;
+
+	game.running = true;
+	
 	while(game.running)
 	{
 		// SSS/SPS persists across stage transitions until explicitly
@@ -162,15 +224,19 @@ bool freshstart;
 			
 			Replay::OnGameStarting();
 			
-			if (!inhibit_loadfade) fade.Start(FADE_IN, FADE_CENTER);
+			if (!inhibit_loadfade) world->fFade.Start(FADE_IN, FADE_CENTER);
 			else inhibit_loadfade = false;
 		}
 		else if (game.switchstage.mapno == START_REPLAY)
 		{
-			stat(">> beginning replay '%s'", GetReplayName(game.switchstage.param));
+			const char *fname = Bench::IsActive() ? Bench::CurrentReplay() : \
+								Batch::IsActive() ? Batch::CurrentReplay() : \
+								Golden::IsActive() ? Golden::CurrentReplay() : \
+								GetReplayName(game.switchstage.param);
+			stat(">> beginning replay '%s'", fname);
 			
 			StopScripts();
-			if (Replay::begin_playback(GetReplayName(game.switchstage.param)))
+			if (Replay::begin_playback(fname))
 			{
 				fatal("error starting playback");
 				goto ingame_error;
@@ -200,7 +266,7 @@ bool freshstart;
 		}
 		
 		// start the level
-		if (game.initlevel()) { fatal("game.initlevel() error"); return 1; }
+		if (game.initlevel()) { fatal("game.initlevel() error"); goto ingame_error; }
 		
 		if (freshstart)
 			weapon_introslide();
@@ -210,79 +276,100 @@ bool freshstart;
 		freshstart = false;
 	}
 	
-shutdown: ;
-	Replay::close();
-	game.close();
-	Carets::close();
-	
-	Graphics::close();
-	input_close();
-	font_close();
-	sound_close();
-	tsc_close();
-	textbox.Deinit();
-	return error;
+	return 0;
 	
 ingame_error: ;
 	stat("");
 	stat(" ************************************************");
 	stat(" * An in-game error occurred. Game shutting down.");
 	stat(" ************************************************");
-	error = true;
-	goto shutdown;
+	return 1;
 }
 
 
 void gameloop(void)
 {
-int32_t nexttick = 0;
-
 	game.switchstage.mapno = -1;
 	
+	if (headless)
+	{
+		gameloop_headless();
+		return;
+	}
+	
+	Scheduler::Reset();
 	while(game.running && game.switchstage.mapno < 0)
 	{
-		// get time until next tick
-		int32_t curtime = SDL_GetTicks();
-		int32_t timeRemaining = nexttick - curtime;
+		// benchmark runs unthrottled, with rendering. the pacing
+		// starts over from wherever that leaves off.
+		if (game.ffwdtime || Bench::IsActive())
+			Scheduler::Reset();
+		else
+			Scheduler::WaitForTick();
+		
+		run_tick();
+		Bench::OnTickDone();
+		Batch::OnTickDone();
+		Golden::OnTickDone();
 		
-		if (timeRemaining <= 0 || game.ffwdtime)
+		if (game.ffwdtime)
+			game.ffwdtime--;
+		
+		// pause game if window minimized
+		if (!Graphics::WindowVisible())
 		{
-			run_tick();
-			
-			// try to "catch up" if something else on the system bogs us down for a moment.
-			// but if we get really far behind, it's ok to start dropping frames
-			if (game.ffwdtime)
-				game.ffwdtime--;
-			
-			nexttick = curtime + GAME_WAIT;
-			
-			// pause game if window minimized
-			if (!Graphics::WindowVisible())
-			{
-				AppMinimized();
-				nexttick = 0;
-			}
+			AppMinimized();
+			Scheduler::Reset();
 		}
-		else
+	}
+}
+
+// run ticks back-to-back with no frame pacing, for simulation-only runs.
+// stops after headless_ticks if it was given, or when a replay
+// started from the command line finishes.
+static void gameloop_headless(void)
+{
+static NX_THREAD int ticks_run = 0;
+static NX_THREAD uint32_t start_time = 0;
+
+	if (!start_time)
+		start_time = SDL_GetTicks();
+	
+	while(game.running && game.switchstage.mapno < 0)
+	{
+		run_tick();
+		Bench::OnTickDone();
+		Batch::OnTickDone();
+		Golden::OnTickDone();
+		ticks_run++;
+		
+		if (game.ffwdtime)
+			game.ffwdtime--;
+		
+		if ((headless_ticks && ticks_run >= headless_ticks) || \
+			(start_replay >= 0 && !Replay::IsPlaying()))
 		{
-			// don't needlessly hog CPU, but don't sleep for entire
-			// time left, some CPU's/kernels will fall asleep for
-			// too long and cause us to run slower than we should
-			timeRemaining /= 2;
-			if (timeRemaining)
-				SDL_Delay(timeRemaining);
+			uint32_t elapsed = (SDL_GetTicks() - start_time);
+			stat("headless: ran %d ticks in %d ms (%.1f ticks/sec)", ticks_run, elapsed, \
+				elapsed ? ((double)ticks_run * 1000.0 / elapsed) : 0.0);
+			
+			game.running = false;
 		}
 	}
 }
 
 static inline void run_tick()
 {
-static bool can_tick = true;
-static bool last_freezekey = false;
-static bool last_framekey = false;
-static int frameskip = 0;
+static NX_THREAD bool can_tick = true;
+static NX_THREAD bool last_freezekey = false;
+static NX_THREAD bool last_framekey = false;
+static NX_THREAD int frameskip = 0;
 
-	input_poll();
+	PROFILE_FRAME("run_tick");
+	
+	// headless has no window to poll; inputs come only from replays
+	if (!headless)
+		input_poll();
 	
 	// input handling for a few global things
 	if (justpushed(ESCKEY))
@@ -333,8 +420,16 @@ static int frameskip = 0;
 	
 	if (can_tick)
 	{
+		// fast-forward only shows every so many frames, and headless none
+		// at all unless the software renderer is there to draw them; the
+		// rest are simulated without being drawn.
+		present_frame = ((!headless || software_render) && (!flipacceltime || frameskip <= 0));
+		
 		game.tick();
 		
+		if (present_frame)
+			Golden::OnFrameDrawn();
+		
 		if (freezeframe)
 		{
 			char buf[1024];
@@ -342,25 +437,35 @@ static int frameskip = 0;
 			font_draw_shaded(4, (Graphics::SCREEN_HEIGHT-GetFontHeight()-4), buf, 0, &greenfont);
 			can_tick = false;
 		}
-		else
+		else if (present_frame)
 		{
 			Replay::DrawStatus();
 		}
 		
-		if (settings->show_fps)
+		if (settings->show_fps && !headless)
 		{
 			update_fps();
 		}
-
-		VJoy::DrawAll();
+		
+		if (present_frame)
+		{
+			Profiler::DrawOverlay();
+			VJoy::DrawAll();
+		}
 		
 		// This will issue flush for old events.
 		// New events will be acquired from inside screen flip (there ui message
 		// pump) or on next cycle in input_poll()
-		VJoy::PreProcessInput();
+		if (!headless)
+			VJoy::PreProcessInput();
 		
-		if (!flipacceltime)
+		if (headless)
 		{
+			if (flipacceltime) flipacceltime--;
+		}
+		else if (!flipacceltime)
+		{
+			PROFILE_SCOPE("Flip");
 			//platform_sync_to_vblank();
 			screen->Flip();
 		}
@@ -369,9 +474,14 @@ static int frameskip = 0;
 			flipacceltime--;
 			if (--frameskip < 0)
 			{
+				PROFILE_SCOPE("Flip");
 				screen->Flip();
 				frameskip = 256;
 			}
+			else
+			{	// not shown, but whatever was drawn still mustn't pile up
+				DrawQueue::EndFrame();
+			}
 		}
 		
 		memcpy(lastinputs, inputs, sizeof(lastinputs));
@@ -432,7 +542,7 @@ void InitNewGame(bool with_intro)
 	game.switchstage.playery = 8;
 	game.switchstage.eventonentry = (with_intro) ? 200 : 91;
 	
-	fade.set_full(FADE_OUT);
+	world->fFade.set_full(FADE_OUT);
 }
 
 
@@ -464,6 +574,8 @@ void c------------------------------() {}
 static void fatal(const char *str)
 {
 	staterr("fatal: '%s'", str);
+	if (headless)
+		return;
 	
 #ifdef IPHONE
 	// Crash an application on ios. This will not left user with blank screen
@@ -492,6 +604,12 @@ char fname[MAXPATHLEN];
 	sprintf(fname, "%s/npc.tbl", data_dir);
 	if (file_exists(fname)) return 0;
 	
+	if (headless)
+	{
+		staterr("Missing \"%s\" directory.", data_dir);
+		return 1;
+	}
+	
 	if (!safemode::init())
 	{
 		safemode::moveto(SM_UPPER_THIRD);
@@ -508,6 +626,144 @@ char fname[MAXPATHLEN];
 	return 1;
 }
 
+// -headless			run without a window, renderer or audio device
+// -software		draw on the CPU instead of through an SDL_Renderer; with
+//					-headless, frames are still drawn, just never shown
+// -ticks <n>		exit after n ticks
+// -replay <slot>	start playback of the given replay slot
+// -bench <file>	benchmark playback of the given replay file (may be repeated)
+// -benchout <file>	where to write the benchmark report (.json or .csv)
+// -hashevery <n>	store a world-state checkpoint in recordings every n frames
+// -convertrep <in> <out>	rewrite a replay file in the current format and exit
+// -verify <file>	check the given replay against its checkpoints, headless (may be repeated)
+// -jobs <n>		how many replays -verify runs at once (default: one per CPU)
+// -verifyout <file>	where to write the -verify report
+// -profcsv <file>	write per-frame profiler times to the given file
+// -trace <file>	write a Chrome trace of the first frames to the given file
+// -sched <policy>	what to do about late ticks: "catchup" (default) or "drop"
+// -schedspin <us>	how close to a tick's deadline to stop sleeping and spin
+// -schedstats <file>	write tick jitter and interval histograms to the given file
+// -aicost			account AI time per object type (reported by -bench)
+// -golden <file>	compare frames of the given replay against reference images,
+//					headless on the software renderer (may be repeated)
+// -goldenticks <list>	comma-separated ticks of each replay to compare, e.g. "60,300"
+// -goldendir <dir>	where the reference images are (default "golden")
+// -goldentol <n>	how far off a color channel can be and still match (default 0)
+// -goldenupdate	write the frames as the new reference images instead of comparing
+// -goldenout <file>	where to write the -golden report
+static void parse_args(int argc, char *argv[])
+{
+	for(int i=1;i<argc;i++)
+	{
+		const char *arg = argv[i];
+		
+		if (!strcmp(arg, "-headless"))
+		{
+			headless = true;
+		}
+		else if (!strcmp(arg, "-software"))
+		{
+			software_render = true;
+		}
+		else if (!strcmp(arg, "-ticks") && i+1 < argc)
+		{
+			headless_ticks = atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-replay") && i+1 < argc)
+		{
+			start_replay = atoi(argv[++i]);
+		}
+		else if (!strcmp(arg, "-bench") && i+1 < argc)
+		{
+			Bench::AddReplay(argv[++i]);
+		}
+		else if (!strcmp(arg, "-benchout") && i+1 < argc)
+		{
+			Bench::SetOutput(argv[++i]);
+		}
+		else if (!strcmp(arg, "-hashevery") && i+1 < argc)
+		{
+			Replay::SetHashInterval(atoi(argv[++i]));
+		}
+		else if (!strcmp(arg, "-verify") && i+1 < argc)
+		{
+			Batch::AddReplay(argv[++i]);
+			headless = true;
+		}
+		else if (!strcmp(arg, "-jobs") && i+1 < argc)
+		{
+			Batch::SetJobs(atoi(argv[++i]));
+		}
+		else if (!strcmp(arg, "-verifyout") && i+1 < argc)
+		{
+			Batch::SetOutput(argv[++i]);
+		}
+		else if (!strcmp(arg, "-golden") && i+1 < argc)
+		{
+			Golden::AddReplay(argv[++i]);
+			headless = true;
+			software_render = true;
+		}
+		else if (!strcmp(arg, "-goldenticks") && i+1 < argc)
+		{
+			Golden::AddTicks(argv[++i]);
+		}
+		else if (!strcmp(arg, "-goldendir") && i+1 < argc)
+		{
+			Golden::SetDir(argv[++i]);
+		}
+		else if (!strcmp(arg, "-goldentol") && i+1 < argc)
+		{
+			Golden::SetTolerance(atoi(argv[++i]));
+		}
+		else if (!strcmp(arg, "-goldenupdate"))
+		{
+			Golden::SetUpdate(true);
+		}
+		else if (!strcmp(arg, "-goldenout") && i+1 < argc)
+		{
+			Golden::SetOutput(argv[++i]);
+		}
+		else if (!strcmp(arg, "-aicost"))
+		{
+			AICost::SetEnabled(true);
+		}
+		else if (!strcmp(arg, "-profcsv") && i+1 < argc)
+		{
+			Profiler::StartCSV(argv[++i]);
+		}
+		else if (!strcmp(arg, "-trace") && i+1 < argc)
+		{
+			Profiler::StartTrace(argv[++i], TRACE_DEFAULT_FRAMES);
+		}
+		else if (!strcmp(arg, "-sched") && i+1 < argc)
+		{
+			SchedPolicy policy;
+			if (Scheduler::ParsePolicy(argv[++i], &policy))
+				staterr("unknown scheduler policy '%s'", argv[i]);
+			else
+				Scheduler::SetPolicy(policy);
+		}
+		else if (!strcmp(arg, "-schedspin") && i+1 < argc)
+		{
+			Scheduler::SetSpin(atoi(argv[++i]));
+		}
+		else if (!strcmp(arg, "-schedstats") && i+1 < argc)
+		{
+			Scheduler::SetOutput(argv[++i]);
+		}
+		else if (!strcmp(arg, "-convertrep") && i+2 < argc)
+		{
+			convert_in = argv[++i];
+			convert_out = argv[++i];
+		}
+		else
+		{	// the OS may hand us options of its own; don't treat them as fatal
+			stat("ignoring unrecognized command-line option '%s'", arg);
+		}
+	}
+}
+
 void visible_warning(const char *fmt, ...)
 {
 va_list ar;
@@ -645,7 +901,7 @@ uint32_t last_change = 0;
 			if (autochange && (curtime - last_change) >= change_time)
 			{
 				last_change = curtime;
-				int newsong = random(1, 42);
+				int newsong = fxrandom(1, 42);
 				music(newsong);
 			}
 		}
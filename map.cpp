@@ -1,21 +1,21 @@
 
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
 #include "nx.h"
 #include "map.h"
+#include "profiler.h"
+#include "mapcache.h"
 #include "map.fdh"
 
-stMap map;
-
 MapRecord stages[MAX_STAGES];
 int num_stages;
 
+// each thread loads the backdrops its world uses
 #define MAX_BACKDROPS			32
-NXSurface *backdrop[MAX_BACKDROPS];
+NX_THREAD NXSurface *backdrop[MAX_BACKDROPS];
 
-// for FindObject--finding NPC's by ID2
-Object *ID2Lookup[65536];
-
-unsigned char tilecode[MAX_TILES];			// tile codes for every tile in current tileset
-unsigned int tileattr[MAX_TILES];			// tile attribute bits for every tile in current tileset
 unsigned int tilekey[MAX_TILES];			// mapping from tile codes -> tile attributes
 
 
@@ -26,6 +26,8 @@ bool load_stage(int stage_no)
 char stage[MAXPATHLEN];
 char fname[MAXPATHLEN];
 
+	PROFILE_SCOPE("load_stage");
+	
 	stat(" >> Entering stage %d: '%s'.", stage_no, stages[stage_no].stagename);
 	game.curmap = stage_no;		// do it now so onspawn events will have it
 	
@@ -49,6 +51,7 @@ char fname[MAXPATHLEN];
 	
 	sprintf(fname, "%s/%s.pxa", stage_dir, tileset_names[stages[stage_no].tileset]);
 	if (load_tileattr(fname)) return 1;
+	map_build_attrgrid();
 	
 	sprintf(fname, "%s.pxe", stage);
 	if (load_entities(fname)) return 1;
@@ -60,6 +63,7 @@ char fname[MAXPATHLEN];
 	map.scrolltype = stages[stage_no].scroll_type;
 	map.motionpos = 0;
 	
+	MapCache::Reset();
 	return 0;
 }
 
@@ -86,27 +90,45 @@ int x, y;
 		return 1;
 	}
 	
+	map_free_grids();
 	memset(&map, 0, sizeof(map));
 	
 	fgetc(fp);
-	map.xsize = fgeti(fp);
-	map.ysize = fgeti(fp);
+	x = fgeti(fp);
+	y = fgeti(fp);
 	
-	if (map.xsize > MAP_MAXSIZEX || map.ysize > MAP_MAXSIZEY)
+	if (x > MAP_MAXSIZEX || y > MAP_MAXSIZEY)
+	{
+		staterr("load_map: map is too large -- size %dx%d but max is %dx%d", x, y, MAP_MAXSIZEX, MAP_MAXSIZEY);
+		fclose(fp);
+		return 1;
+	}
+	else if (x == 0 || y == 0)
 	{
-		staterr("load_map: map is too large -- size %dx%d but max is %dx%d", map.xsize, map.ysize, MAP_MAXSIZEX, MAP_MAXSIZEY);
+		staterr("load_map: map is empty -- size %dx%d: '%s'", x, y, fname);
 		fclose(fp);
 		return 1;
 	}
 	else
 	{
-		stat("load_map: level size %dx%d", map.xsize, map.ysize);
+		stat("load_map: level size %dx%d", x, y);
 	}
 	
-	for(y=0;y<map.ysize;y++)
-	for(x=0;x<map.xsize;x++)
+	map.tiles = (uint8_t *)malloc(x * y);
+	if (!map.tiles)
 	{
-		map.tiles[x][y] = fgetc(fp);
+		staterr("load_map: failed to allocate %d bytes for the map", x * y);
+		fclose(fp);
+		return 1;
+	}
+	
+	map.xsize = x;
+	map.ysize = y;
+	
+	if (fread(map.tiles, x * y, 1, fp) != 1)
+	{
+		staterr("load_map: map data is truncated: '%s'", fname);
+		memset(map.tiles, 0, x * y);
 	}
 	
 	fclose(fp);
@@ -119,6 +141,16 @@ int x, y;
 }
 
 
+static void map_free_grids(void)
+{
+	free(map.tiles);
+	free(map.attr);
+	
+	for(int i=0;i<NUM_ATTR_PLANES;i++)
+		free(map.planes[i]);
+}
+
+
 // load a PXE (entity list for a map)
 bool load_entities(const char *fname)
 {
@@ -202,7 +234,7 @@ int nEntities;
 										 0, 0, dir, NULL, CF_NO_SPAWN_EVENT);
 				
 				o->id1 = id1;
-				o->id2 = id2;
+				Objects::SetIndexedID2(o, id2);
 				o->flags |= flags;
 				
 				ID2Lookup[o->id2] = o;
@@ -234,6 +266,200 @@ int nEntities;
 	memcpy(&tileattr, &ta, sizeof(ta));
 */
 
+/*
+void c------------------------------() {}
+*/
+
+// which of the bit-planes a set of tile attributes belongs in
+static uint32_t attr_to_planes(uint32_t attr)
+{
+uint32_t planes = 0;
+
+	if (attr & TA_SOLID) planes |= (1 << AP_SOLID);
+	if (attr & TA_WATER) planes |= (1 << AP_WATER);
+	if (attr & TA_SLOPE) planes |= (1 << AP_SLOPE);
+	if (attr & TA_HURTS_PLAYER) planes |= (1 << AP_SPIKE);
+	
+	return planes;
+}
+
+static void set_attr(int x, int y)
+{
+	uint32_t attr = tileattr[map.tiles[(y * map.xsize) + x]];
+	uint32_t planes = attr_to_planes(attr);
+	
+	map.attr[(y * map.xsize) + x] = attr;
+	
+	int word = (y * map.planepitch) + (x >> 5);
+	uint32_t bit = (1 << (x & 31));
+	
+	for(int i=0;i<NUM_ATTR_PLANES;i++)
+	{
+		if (planes & (1 << i))
+			map.planes[i][word] |= bit;
+		else
+			map.planes[i][word] &= ~bit;
+	}
+}
+
+// build the collision attribute grid for the current map and tileset,
+// so collision checks don't have to go through the tile number to get
+// the attributes. must be called after the map and tileattrs are loaded.
+void map_build_attrgrid(void)
+{
+int x, y, i;
+
+	free(map.attr);
+	for(i=0;i<NUM_ATTR_PLANES;i++)
+		free(map.planes[i]);
+	
+	map.planepitch = (map.xsize + 31) >> 5;
+	map.attr = (uint32_t *)malloc((map.xsize * map.ysize + 1) * sizeof(uint32_t));
+	
+	for(i=0;i<NUM_ATTR_PLANES;i++)
+		map.planes[i] = (uint32_t *)calloc(map.planepitch * map.ysize + 1, sizeof(uint32_t));
+	
+	for(y=0;y<map.ysize;y++)
+	for(x=0;x<map.xsize;x++)
+	{
+		set_attr(x, y);
+	}
+}
+
+// changes the tile at x,y, keeping the attribute grid in step.
+// does nothing if x,y is outside the map.
+void map_settile(int x, int y, int tile)
+{
+	if ((unsigned)x >= (unsigned)map.xsize || (unsigned)y >= (unsigned)map.ysize)
+		return;
+	
+	map.tiles[(y * map.xsize) + x] = tile;
+	
+	if (map.attr)
+		set_attr(x, y);
+	
+	MapCache::InvalidateTile(x, y);
+}
+
+// saves the map and it's tiles, which scripts can change, for a save state.
+// the attribute grid isn't saved; it's rebuilt from the tiles on restore.
+void map_save_state(DBuffer *out)
+{
+int i, count = 0;
+
+	SS_PUT(out, map);
+	SS_PUTDATA(out, map.tiles, map.xsize * map.ysize);
+	
+	for(i=0;i<65536;i++)
+		if (ID2Lookup[i]) count++;
+	
+	SS_PUT(out, count);
+	for(i=0;i<65536;i++)
+	{
+		if (ID2Lookup[i])
+		{
+			uint16_t id2 = i;
+			SS_PUT(out, id2);
+			SS_PUT(out, ID2Lookup[i]);
+		}
+	}
+}
+
+// the stage the state was saved in must already be loaded.
+bool map_load_state(const uint8_t **in)
+{
+stMap saved;
+int i, count;
+
+	SS_GET(in, saved);
+	if (saved.xsize != map.xsize || saved.ysize != map.ysize)
+	{
+		staterr("map_load_state: map size mismatch: %dx%d, current map is %dx%d", \
+			saved.xsize, saved.ysize, map.xsize, map.ysize);
+		return 1;
+	}
+	
+	// keep our own buffers
+	saved.tiles = map.tiles;
+	saved.attr = map.attr;
+	memcpy(saved.planes, map.planes, sizeof(saved.planes));
+	saved.planepitch = map.planepitch;
+	
+	int backdrop = saved.backdrop;
+	saved.backdrop = map.backdrop;
+	
+	memcpy(&map, &saved, sizeof(map));
+	SS_GETDATA(in, map.tiles, map.xsize * map.ysize);
+	map_build_attrgrid();
+	map_set_backdrop(backdrop);
+	MapCache::InvalidateAll();
+	
+	memset(ID2Lookup, 0, sizeof(ID2Lookup));
+	SS_GET(in, count);
+	for(i=0;i<count;i++)
+	{
+		uint16_t id2;
+		SS_GET(in, id2);
+		SS_GET(in, ID2Lookup[id2]);
+	}
+	
+	return 0;
+}
+
+// for each point in the list, treated as a pixel offset from xoff,yoff, gets
+// the index into map.tiles and map.attr of the tile under it, or -1 if it's
+// off the map. points are handled four at a time with SSE2 when available.
+void map_probe(int xoff, int yoff, const SIFPoint *points, int npoints, int *index)
+{
+int i = 0;
+
+#if defined(__SSE2__) && (TILE_W == 16) && (TILE_H == 16)
+	const __m128i tilemask = _mm_set1_epi32(TILE_W - 1);
+	const __m128i xsize = _mm_set1_epi32(map.xsize);
+	const __m128i ysize = _mm_set1_epi32(map.ysize);
+	const __m128i minus1 = _mm_set1_epi32(-1);
+	// for _mm_madd_epi16: (tx * 1) + (ty * xsize)
+	const __m128i rowmul = _mm_set1_epi32((map.xsize << 16) | 1);
+	
+	for(;i+4<=npoints;i+=4)
+	{
+		__m128i px = _mm_set_epi32(points[i+3].x, points[i+2].x, points[i+1].x, points[i].x);
+		__m128i py = _mm_set_epi32(points[i+3].y, points[i+2].y, points[i+1].y, points[i].y);
+		px = _mm_add_epi32(px, _mm_set1_epi32(xoff));
+		py = _mm_add_epi32(py, _mm_set1_epi32(yoff));
+		
+		// divide by the tile size, rounding towards zero the same as "/" does
+		__m128i tx = _mm_add_epi32(px, _mm_and_si128(_mm_srai_epi32(px, 31), tilemask));
+		__m128i ty = _mm_add_epi32(py, _mm_and_si128(_mm_srai_epi32(py, 31), tilemask));
+		tx = _mm_srai_epi32(tx, 4);
+		ty = _mm_srai_epi32(ty, 4);
+		
+		__m128i inside = _mm_and_si128(_mm_cmpgt_epi32(tx, minus1), _mm_cmplt_epi32(tx, xsize));
+		inside = _mm_and_si128(inside, _mm_cmpgt_epi32(ty, minus1));
+		inside = _mm_and_si128(inside, _mm_cmplt_epi32(ty, ysize));
+		
+		// tile coordinates of anything inside the map fit in 16 bits, and
+		// anything which doesn't is masked off below anyway.
+		__m128i pairs = _mm_unpacklo_epi16(_mm_packs_epi32(tx, tx), _mm_packs_epi32(ty, ty));
+		__m128i idx = _mm_madd_epi16(pairs, rowmul);
+		
+		idx = _mm_or_si128(_mm_and_si128(inside, idx), _mm_andnot_si128(inside, minus1));
+		_mm_storeu_si128((__m128i *)&index[i], idx);
+	}
+#endif
+	
+	for(;i<npoints;i++)
+	{
+		int x = (xoff + points[i].x) / TILE_W;
+		int y = (yoff + points[i].y) / TILE_H;
+		
+		if (x >= 0 && y >= 0 && x < map.xsize && y < map.ysize)
+			index[i] = (y * map.xsize) + x;
+		else
+			index[i] = -1;
+	}
+}
+
 // loads a pxa (tileattr) file
 bool load_tileattr(const char *fname)
 {
@@ -502,6 +728,8 @@ int i;
 			CopySpriteToTile(SPR_DESTROYABLE, i, 0, 0);
 		}
 	}
+	
+	MapCache::Reset();
 }
 
 
@@ -555,6 +783,11 @@ int mapx, mapy;
 int blit_x, blit_y, blit_x_start;
 int scroll_x, scroll_y;
 
+	PROFILE_SCOPE("map_draw");
+	
+	if (!MapCache::Draw(foreground))
+		return;
+	
 	const int max_x = (Graphics::SCREEN_WIDTH  / TILE_W) + MAP_DRAW_EXTRA_X;
 	const int max_y = (Graphics::SCREEN_HEIGHT / TILE_H) + MAP_DRAW_EXTRA_Y;
 	
@@ -571,13 +804,21 @@ int scroll_x, scroll_y;
 	
 	// MAP_DRAW_EXTRA_Y etc is 1 if resolution is changed to
 	// something not a multiple of TILE_H.
+	// anything past the edge of the map is drawn as tile 0.
 	for(y=0; y <= max_y; y++)
 	{
+		const uint8_t *row = NULL;
+		if (mapy + y >= 0 && mapy + y < map.ysize)
+			row = map_tilerow(mapy + y);
+		
 		blit_x = blit_x_start;
 		
 		for(x=0; x <= max_x; x++)
 		{
-			int t = map.tiles[mapx+x][mapy+y];
+			int t = 0;
+			if (row && mapx + x >= 0 && mapx + x < map.xsize)
+				t = row[mapx + x];
+			
 			if ((tileattr[t] & TA_FOREGROUND) == foreground)
 			{
 				Tileset::draw_tilegrid_add(blit_x, blit_y, t);
@@ -875,7 +1116,7 @@ void map_ChangeTileWithSmoke(int x, int y, int newtile, int nclouds, bool boomfl
 	if (x < 0 || y < 0 || x >= map.xsize || y >= map.ysize)
 		return;
 	
-	map.tiles[x][y] = newtile;
+	map_settile(x, y, newtile);
 	
 	int xa = ((x * TILE_W) + (TILE_W / 2)) << CSF;
 	int ya = ((y * TILE_H) + (TILE_H / 2)) << CSF;
@@ -902,18 +1143,23 @@ void map_show_map_name()
 	game.showmapnametime = 120;
 }
 
+// game_tick_normal counts down showmapnametime
 void map_draw_map_name(void)
 {
 	if (game.showmapnametime)
-	{
 		font_draw(game.mapname_x, 84, map_get_stage_name(game.curmap), 0, &shadowfont);
-		game.showmapnametime--;
-	}
 }
 
 
-// animate all motion tiles
+// moves all motion tiles along
 void AnimateMotionTiles(void)
+{
+	map.motionpos += 2;
+	if (map.motionpos >= TILE_W) map.motionpos = 0;
+}
+
+// updates the tileset with the motion tiles at their current positions
+void DrawMotionTiles(void)
 {
 int i;
 int x_off, y_off;
@@ -933,9 +1179,6 @@ int x_off, y_off;
 		
 		CopySpriteToTile(map.motiontiles[i].sprite, map.motiontiles[i].tileno, x_off, y_off);
 	}
-	
-	map.motionpos += 2;
-	if (map.motionpos >= TILE_W) map.motionpos = 0;
 }
 
 
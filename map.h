@@ -9,6 +9,18 @@
 
 #define MAP_PHASE_ADJ_SPEED			64
 
+// bit-planes of the collision attribute grid: one bit per tile,
+// for the attributes which are tested most often.
+enum AttrPlane
+{
+	AP_SOLID,			// any of TA_SOLID
+	AP_WATER,			// TA_WATER
+	AP_SLOPE,			// TA_SLOPE
+	AP_SPIKE,			// TA_HURTS_PLAYER
+	
+	NUM_ATTR_PLANES
+};
+
 // this macro returns true if the current stage is spec'd to use the specified NPC spriteset.
 #define DoesCurrentStageUseSpriteset(SET) \
 	( stages[game.curmap].NPCset1==SET || stages[game.curmap].NPCset2==SET )
@@ -58,10 +70,27 @@ struct stMap
 	int nmotiontiles;
 	int motionpos;
 	
-	unsigned char tiles[MAP_MAXSIZEX][MAP_MAXSIZEY];
+	// tile numbers, stored row by row and sized to the map (xsize * ysize).
+	// use map_tile() and friends (see world.h) rather than indexing it directly.
+	uint8_t *tiles;
+	
+	// collision attributes (tileattr[] of the tile) for every tile, laid out
+	// the same as tiles, and the bit-planes, planepitch uint32s to a row.
+	// built by map_build_attrgrid once the stage is loaded and kept up to
+	// date by map_settile.
+	uint32_t *attr;
+	uint32_t *planes[NUM_ATTR_PLANES];
+	int planepitch;
 };
 
-extern stMap map;
+// map_tile() and the rest are in world.h
+
+void map_settile(int x, int y, int tile);
+void map_build_attrgrid(void);
+void map_probe(int xoff, int yoff, const SIFPoint *points, int npoints, int *index);
+
+void map_save_state(DBuffer *out);
+bool map_load_state(const uint8_t **in);
 
 void map_focus(Object *o, int spd = 16);
 
@@ -92,12 +121,10 @@ void map_focus(Object *o, int spd = 16);
 #define TA_CURRENT			0x00100			// blows player (tilecode checked to see which direction)
 #define TA_SLOPE			0x00200			// is a slope (the tilecode is checked to see what kind)
 
-extern uint8_t tilecode[MAX_TILES];
-extern uint32_t tileattr[MAX_TILES];
 extern uint32_t tilekey[256];
-extern Object *ID2Lookup[65536];
 
 void AnimateMotionTiles(void);
+void DrawMotionTiles(void);
 
 void map_ChangeTileWithSmoke(int x, int y, int newtile, int nclouds=4, bool boomflash=false, Object *push_behind=NULL);
 
@@ -16,7 +16,7 @@
 #define BANNER_TOP			7
 #define BANNER_BTM			23
 
-static struct
+static NX_THREAD struct
 {
 	NXSurface *sfc;			// surface for the map image
 	
@@ -25,6 +25,7 @@ static struct
 	
 	int expandframe;		// for expand/contract effect
 	int current_row;		// scan down effect
+	int drawn_rows;			// how far the scan has been drawn onto sfc
 	
 	int px, py;				// the position of the you-are-here dot
 	int timer;				// for the flashing
@@ -78,8 +79,7 @@ void c------------------------------() {}
 
 void ms_tick(void)
 {
-	DrawScene();
-	draw_banner();
+	RunScene();
 	
 	if (ms.state == MS_EXPANDING)
 	{
@@ -87,28 +87,17 @@ void ms_tick(void)
 		
 		if (ms.expandframe > EXPAND_LENGTH)
 			ms.state = MS_DISPLAYED;
-		else
-			draw_expand();
 	}
 	
 	if (ms.state == MS_DISPLAYED)
 	{
 		// scan down effect
-		if (ms.current_row < map.ysize)
-		{
-			draw_row(ms.current_row++);
-			
-			if (ms.current_row < map.ysize)
-				draw_row(ms.current_row++);
-		}
-		
-		// draw map
-		DrawRect(ms.x - 1, ms.y - 1, ms.x + ms.w, ms.y + ms.h, DK_BLUE);
-		DrawSurface(ms.sfc, ms.x, ms.y);
+		ms.current_row += 2;
+		if (ms.current_row > map.ysize)
+			ms.current_row = map.ysize;
 		
 		// you-are-here dot
-		if (++ms.timer & 8)
-			draw_sprite(ms.px, ms.py, SPR_MAP_PIXELS, 4);
+		ms.timer++;
 		
         if (VJoy::ModeAware::wasTap())
             ms.state = MS_CONTRACTING;
@@ -133,10 +122,32 @@ void ms_tick(void)
 			int param = (ms.return_gm == GM_INVENTORY) ? 1 : 0;
 			game.setmode(ms.return_gm, param);
 		}
-		else
-		{
-			draw_expand();
-		}
+	}
+}
+
+void ms_draw(void)
+{
+	DrawScene();
+	draw_banner();
+	
+	if (ms.state == MS_DISPLAYED)
+	{
+		// rows are drawn onto the map as the scan reaches them,
+		// including any which were passed over while not presenting.
+		while(ms.drawn_rows < ms.current_row)
+			draw_row(ms.drawn_rows++);
+		
+		// draw map
+		DrawRect(ms.x - 1, ms.y - 1, ms.x + ms.w, ms.y + ms.h, DK_BLUE);
+		DrawSurface(ms.sfc, ms.x, ms.y);
+		
+		// you-are-here dot
+		if (ms.timer & 8)
+			draw_sprite(ms.px, ms.py, SPR_MAP_PIXELS, 4);
+	}
+	else if (ms.expandframe > 0 && ms.expandframe <= EXPAND_LENGTH)
+	{
+		draw_expand();
 	}
 }
 
@@ -177,6 +188,7 @@ void c------------------------------() {}
 static void draw_row(int y)
 {
 int x;
+const uint8_t *row = map_tilerow(y);
 
 	Graphics::SetDrawTarget(ms.sfc);
     
@@ -186,7 +198,7 @@ int x;
     
 	for(x=0;x<map.xsize;x++)
 	{
-		int tc = tilecode[map.tiles[x][y]];
+		int tc = tilecode[row[x]];
 		draw_sprite(x, y, SPR_MAP_PIXELS, get_color(tc));
         
 	}
@@ -198,9 +210,9 @@ int x;
 }
 
 
-static int get_color(int tilecode)
+static int get_color(int tc)
 {
-	switch(tilecode)
+	switch(tc)
 	{
 		case 0:
 			return 0;
@@ -5,6 +5,7 @@
 
 bool ms_init(int param);
 void ms_tick(void);
+void ms_draw(void);
 void ms_close(void);
 
 #endif
@@ -0,0 +1,283 @@
+
+#include <string.h>
+#include "nx.h"
+#include "mapcache.h"
+
+// the cache follows the map of the thread's world
+static NX_THREAD MapChunk chunks[MAPCACHE_MAX_CHUNKS];
+static NX_THREAD bool is_motion[MAX_TILES];
+
+static bool enabled = true;
+static NX_THREAD uint32_t curdraw = 0;
+
+static NX_THREAD int renders = 0;
+static NX_THREAD int composited = 0;
+
+// rounds towards negative infinity, so the chunks left of and
+// above the map (which are all tile 0) don't share with chunk 0.
+static inline int floordiv(int a, int b)
+{
+	return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+}
+
+static void find_motion_tiles()
+{
+	memset(is_motion, 0, sizeof(is_motion));
+
+	for(int i=0;i<map.nmotiontiles;i++)
+		is_motion[map.motiontiles[i].tileno] = true;
+}
+
+static inline int map_tile_or_zero(int x, int y)
+{
+	if ((unsigned)x >= (unsigned)map.xsize || (unsigned)y >= (unsigned)map.ysize)
+		return 0;
+
+	return map.tiles[(y * map.xsize) + x];
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static void render_chunk(MapChunk *c)
+{
+NXSurface *tileset = Tileset::GetSurface();
+int x, y, t;
+int mapx, mapy;
+
+	c->sfc->ClearRect(0, 0, MAPCACHE_CHUNK_W - 1, MAPCACHE_CHUNK_H - 1);
+	c->nlive = 0;
+	c->empty = true;
+
+	mapx = (c->cx * MAPCACHE_CHUNK_TILES);
+	mapy = (c->cy * MAPCACHE_CHUNK_TILES);
+
+	for(y=0;y<MAPCACHE_CHUNK_TILES;y++)
+	for(x=0;x<MAPCACHE_CHUNK_TILES;x++)
+	{
+		t = map_tile_or_zero(mapx + x, mapy + y);
+		if ((tileattr[t] & TA_FOREGROUND) != c->layer)
+			continue;
+
+		if (is_motion[t])
+		{
+			c->live[c->nlive++] = (y * MAPCACHE_CHUNK_TILES) + x;
+		}
+		else
+		{
+			// 16 tiles per row on all tilesheet
+			c->sfc->DrawSurface(tileset, x * TILE_W, y * TILE_H, \
+								(t % 16) * TILE_W, (t / 16) * TILE_H, TILE_W, TILE_H);
+			c->empty = false;
+		}
+	}
+
+	c->dirty = false;
+	renders++;
+}
+
+// returns the chunk at cx, cy on the given layer, rendering it if it isn't
+// already cached. returns NULL if there's nowhere to put it.
+static MapChunk *get_chunk(int cx, int cy, uint8_t layer)
+{
+MapChunk *c, *victim = NULL;
+int i;
+
+	for(i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+	{
+		c = &chunks[i];
+		if (c->valid && c->cx == cx && c->cy == cy && c->layer == layer)
+		{
+			if (c->dirty)
+				render_chunk(c);
+
+			c->lastused = curdraw;
+			return c;
+		}
+	}
+
+	// take an unused surface if there is one, else the least recently used
+	// chunk. chunks already drawn by this call are never taken.
+	for(i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+	{
+		c = &chunks[i];
+		if (!c->valid)
+		{
+			victim = c;
+			break;
+		}
+
+		if (c->lastused != curdraw && (!victim || c->lastused < victim->lastused))
+			victim = c;
+	}
+
+	if (!victim)
+		return NULL;
+
+	if (!victim->sfc)
+	{
+		victim->sfc = new NXSurface;
+		if (victim->sfc->AllocTransparent(MAPCACHE_CHUNK_W, MAPCACHE_CHUNK_H))
+		{
+			staterr("MapCache: failed to create a %dx%d chunk", MAPCACHE_CHUNK_W, MAPCACHE_CHUNK_H);
+			delete victim->sfc;
+			victim->sfc = NULL;
+			return NULL;
+		}
+	}
+
+	victim->cx = cx;
+	victim->cy = cy;
+	victim->layer = layer;
+	victim->valid = true;
+	render_chunk(victim);
+
+	victim->lastused = curdraw;
+	return victim;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// draws the given layer of the map the same way map_draw would. returns 1
+// without drawing anything if the cache can't be used, in which case the
+// caller should draw the tiles itself.
+bool MapCache::Draw(uint8_t foreground)
+{
+MapChunk *visible[MAPCACHE_MAX_CHUNKS];
+int nvisible = 0;
+int scroll_x, scroll_y;
+int cx, cy, cx1, cy1;
+int i, j;
+
+	if (!enabled || !Tileset::GetSurface())
+		return 1;
+
+	scroll_x = (map.displayed_xscroll >> CSF);
+	scroll_y = (map.displayed_yscroll >> CSF);
+
+	cx1 = floordiv(scroll_x + Graphics::SCREEN_WIDTH - 1, MAPCACHE_CHUNK_W);
+	cy1 = floordiv(scroll_y + Graphics::SCREEN_HEIGHT - 1, MAPCACHE_CHUNK_H);
+
+	// get everything on screen before drawing any of it, so if we run
+	// out of surfaces part way it can all be left to the caller.
+	curdraw++;
+	for(cy=floordiv(scroll_y, MAPCACHE_CHUNK_H);cy<=cy1;cy++)
+	for(cx=floordiv(scroll_x, MAPCACHE_CHUNK_W);cx<=cx1;cx++)
+	{
+		if (nvisible >= MAPCACHE_MAX_CHUNKS)
+			return 1;
+
+		if (!(visible[nvisible++] = get_chunk(cx, cy, foreground)))
+			return 1;
+	}
+
+	if (!foreground)
+		composited = 0;
+
+	for(i=0;i<nvisible;i++)
+	{
+		MapChunk *c = visible[i];
+		int x = (c->cx * MAPCACHE_CHUNK_W) - scroll_x;
+		int y = (c->cy * MAPCACHE_CHUNK_H) - scroll_y;
+
+		if (!c->empty)
+		{
+			DrawSurface(c->sfc, x, y);
+			composited++;
+		}
+
+		for(j=0;j<c->nlive;j++)
+		{
+			int tx = (c->live[j] % MAPCACHE_CHUNK_TILES);
+			int ty = (c->live[j] / MAPCACHE_CHUNK_TILES);
+			int blit_x = x + (tx * TILE_W);
+			int blit_y = y + (ty * TILE_H);
+
+			if (blit_x <= -TILE_W || blit_x >= Graphics::SCREEN_WIDTH || \
+				blit_y <= -TILE_H || blit_y >= Graphics::SCREEN_HEIGHT)
+				continue;
+
+			draw_tile(blit_x, blit_y, map_tile_or_zero((c->cx * MAPCACHE_CHUNK_TILES) + tx, \
+											(c->cy * MAPCACHE_CHUNK_TILES) + ty));
+		}
+	}
+
+	return 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// the tile at x, y has changed. the tile may have moved to the other layer,
+// so the chunks for both are marked.
+void MapCache::InvalidateTile(int x, int y)
+{
+	int cx = floordiv(x, MAPCACHE_CHUNK_TILES);
+	int cy = floordiv(y, MAPCACHE_CHUNK_TILES);
+
+	for(int i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+	{
+		MapChunk *c = &chunks[i];
+		if (c->valid && c->cx == cx && c->cy == cy)
+			c->dirty = true;
+	}
+}
+
+// the tiles of the whole map have changed, but not the tileset
+// or the resolution, so the surfaces can be kept.
+void MapCache::InvalidateAll()
+{
+	for(int i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+		chunks[i].dirty = true;
+
+	find_motion_tiles();
+}
+
+// a new map or tileset has been loaded, or the resolution has changed.
+// frees all the surfaces, since they may be the wrong size now.
+void MapCache::Reset()
+{
+	for(int i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+		delete chunks[i].sfc;
+
+	memset(chunks, 0, sizeof(chunks));
+	curdraw = 0;
+	renders = 0;
+	composited = 0;
+
+	find_motion_tiles();
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void MapCache::SetEnabled(bool enable)
+{
+	if (!enable)
+		Reset();
+
+	enabled = enable;
+}
+
+bool MapCache::IsEnabled()
+{
+	return enabled;
+}
+
+void MapCache::GetStats(MapCacheStats *stats)
+{
+	stats->chunks = 0;
+	for(int i=0;i<MAPCACHE_MAX_CHUNKS;i++)
+	{
+		if (chunks[i].valid)
+			stats->chunks++;
+	}
+
+	stats->renders = renders;
+	stats->composited = composited;
+}
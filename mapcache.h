@@ -0,0 +1,52 @@
+#ifndef _MAPCACHE_H
+#define _MAPCACHE_H
+
+#define MAPCACHE_CHUNK_TILES	16			// chunks are this many tiles across and down
+#define MAPCACHE_CHUNK_W		(MAPCACHE_CHUNK_TILES * TILE_W)
+#define MAPCACHE_CHUNK_H		(MAPCACHE_CHUNK_TILES * TILE_H)
+#define MAPCACHE_MAX_CHUNKS		24			// surfaces kept around, for both layers
+
+struct MapChunk
+{
+	NXSurface *sfc;
+	int cx, cy;				// position on the map, in chunks
+	uint8_t layer;			// 0 or TA_FOREGROUND, as passed to map_draw
+
+	bool valid;				// holds the chunk at cx, cy, layer
+	bool dirty;				// has to be rendered again before it's used
+	bool empty;				// nothing in it but motion tiles
+	uint32_t lastused;
+
+	// motion tiles are animated by drawing into the tileset, so they're
+	// left out of the chunk and drawn from the tileset every frame.
+	uint16_t live[MAPCACHE_CHUNK_TILES * MAPCACHE_CHUNK_TILES];
+	int nlive;
+};
+
+struct MapCacheStats
+{
+	int chunks;				// chunks currently cached
+	int renders;			// chunks rendered since the last Reset
+	int composited;			// chunks drawn to the screen in the last frame
+};
+
+// keeps each layer of the map pre-rendered in chunks of 16x16 tiles, so
+// drawing the map is a handful of copies instead of one for every tile.
+// chunks are rendered the first time they come on screen and kept until
+// their surface is needed for another one; changing a tile marks only it's
+// own chunk to be rendered again.
+namespace MapCache
+{
+	bool Draw(uint8_t foreground);
+
+	void InvalidateTile(int x, int y);
+	void InvalidateAll();
+	void Reset();
+
+	void SetEnabled(bool enable);
+	bool IsEnabled();
+
+	void GetStats(MapCacheStats *stats);
+};
+
+#endif
@@ -70,10 +70,10 @@ uint32_t *buf_dword = (uint32_t *)buf_byte;
 	buf_dword[3] = value;
 	
 	// generate keys
-	buf_byte[16] = random(0, 255);
-	buf_byte[17] = random(0, 255);
-	buf_byte[18] = random(0, 255);
-	buf_byte[19] = random(0, 255);
+	buf_byte[16] = fxrandom(0, 255);
+	buf_byte[17] = fxrandom(0, 255);
+	buf_byte[18] = fxrandom(0, 255);
+	buf_byte[19] = fxrandom(0, 255);
 	
 	// encode each copy
 	for(int i=0;i<4;i++)
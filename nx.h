@@ -66,7 +66,9 @@ class Object;
 #include "slope.h"
 #include "player.h"
 #include "p_arms.h"
+#include "savestate.h"
 #include "replay.h"
+#include "world.h"
 #include "platform/platform.h"
 
 #include "sound/sound.h"
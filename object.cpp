@@ -1,6 +1,8 @@
 
 #include "nx.h"
 #include "common/llist.h"
+#include "hitgrid.h"
+#include "aicost.h"
 #include "object.fdh"
 
 // deletes the specified object, or well, marks it to be deleted.
@@ -39,13 +41,9 @@ Object * const &o = this;
 	// delete associated floaty text as soon as it's animation is done
 	DamageText->ObjectDestroyed = true;
 	
-	// if any objects are linked to this obj then unlink them
-	Object *link;
-	for(link = firstobject; link; link = link->next)
-	{
-		if (link->linkedobject == o)
-			link->linkedobject = NULL;
-	}
+	// any ObjectLinks still pointing at us will now read back as NULL
+	Objects::Unindex(o);
+	o->serial = 0;
 	
 	// remove from list and free
 	LL_REMOVE(o, prev, next, firstobject, lastobject);
@@ -81,7 +79,7 @@ void Object::SetType(int type)
 {
 Object * const &o = this;
 
-	o->type = type;
+	Objects::SetIndexedType(o, type);
 	o->sprite = objprop[type].sprite;
 	o->hp = objprop[type].initial_hp;
 	o->damage = objprop[o->type].damage;
@@ -193,19 +191,23 @@ uint32_t Object::GetAttributes(const Point *pointlist, int npoints, int *tile)
 {
 int tileno = 0;
 uint32_t attr = 0;
+int index[SIF_MAX_BLOCK_POINTS];
 
 	int xoff = (this->x >> CSF);
 	int yoff = (this->y >> CSF);
 	
-	for(int i=0;i<npoints;i++)
+	for(int i=0;i<npoints;i+=SIF_MAX_BLOCK_POINTS)
 	{
-		int x = (xoff + pointlist[i].x) / TILE_W;
-		int y = (yoff + pointlist[i].y) / TILE_H;
+		int n = MIN(npoints - i, SIF_MAX_BLOCK_POINTS);
+		map_probe(xoff, yoff, &pointlist[i], n, index);
 		
-		if (x >= 0 && y >= 0 && x < map.xsize && y < map.ysize)
+		for(int j=0;j<n;j++)
 		{
-			tileno = map.tiles[x][y];
-			attr |= tileattr[tileno];
+			if (index[j] >= 0)
+			{
+				tileno = map.tiles[index[j]];
+				attr |= map.attr[index[j]];
+			}
 		}
 	}
 	
@@ -229,22 +231,23 @@ uint32_t attr = 0;
 bool Object::CheckAttribute(const Point *pointlist, int npoints, uint32_t attrmask,
 							int *tile_x, int *tile_y)
 {
-int x, y, xoff, yoff;
+int xoff, yoff;
+int index[SIF_MAX_BLOCK_POINTS];
 
 	xoff = (this->x >> CSF);
 	yoff = (this->y >> CSF);
 	
-	for(int i=0;i<npoints;i++)
+	for(int i=0;i<npoints;i+=SIF_MAX_BLOCK_POINTS)
 	{
-		x = (xoff + pointlist[i].x) / TILE_W;
-		y = (yoff + pointlist[i].y) / TILE_H;
+		int n = MIN(npoints - i, SIF_MAX_BLOCK_POINTS);
+		map_probe(xoff, yoff, &pointlist[i], n, index);
 		
-		if (x >= 0 && y >= 0 && x < map.xsize && y < map.ysize)
+		for(int j=0;j<n;j++)
 		{
-			if ((tileattr[map.tiles[x][y]] & attrmask) != 0)
+			if (index[j] >= 0 && (map.attr[index[j]] & attrmask) != 0)
 			{
-				if (tile_x) *tile_x = x;
-				if (tile_y) *tile_y = y;
+				if (tile_x) *tile_x = (index[j] % map.xsize);
+				if (tile_y) *tile_y = (index[j] / map.xsize);
 				return true;
 			}
 		}
@@ -428,6 +431,134 @@ Object * const &o = this;
 void c------------------------------() {}
 */
 
+// swept collision for apply_xinertia and apply_yinertia. instead of probing
+// the map after every pixel moved, each point which would be probed is walked
+// along the path a tile at a time, to find how far the object can go before
+// anything could possibly block it or put it on a slope. those steps are
+// taken all at once and the rest are still done a pixel at a time, so objects
+// end up exactly where they always did.
+
+#define MAX_SWEEP_POINTS		(SIF_MAX_BLOCK_POINTS + 4)
+
+// walks a point along one axis from pixel "pos", "dir" (+1 or -1) a pixel at
+// a time for up to maxsteps pixels, with the other coordinate fixed. returns
+// the first step at which the point is over a tile with any of the attributes
+// in mask, or maxsteps+1 if it never is. negative coordinates don't divide
+// evenly into tiles, so anything which touches them returns 0.
+static int sweep_point(int pos, int fixed, int dir, int maxsteps, bool horizontal, uint32_t mask)
+{
+	int tilesize = horizontal ? TILE_W : TILE_H;
+	
+	if (pos < 0 || fixed < 0 || (pos + (dir * maxsteps)) < 0)
+		return 0;
+	
+	for(int k=0;k<=maxsteps;)
+	{
+		int c = pos + (dir * k);
+		uint32_t attr;
+		
+		if (horizontal)
+			attr = map_attr(c / TILE_W, fixed / TILE_H);
+		else
+			attr = map_attr(fixed / TILE_W, c / TILE_H);
+		
+		if (attr & mask)
+			return k;
+		
+		// skip to the first pixel in the next tile
+		if (dir > 0)
+			k += tilesize - (c % tilesize);
+		else
+			k += (c % tilesize) + 1;
+	}
+	
+	return maxsteps + 1;
+}
+
+// returns how many of the next maxsteps single-pixel moves along an axis are
+// certain not to meet a tile which is solid to the object or is a slope, going
+// by the given points (pixel offsets from the object's position).
+static int sweep_clear_steps(Object *o, const SIFPoint *points, int npoints, \
+							int dir, int maxsteps, bool horizontal)
+{
+	uint32_t mask = (o->GetBlockingType() | TA_SLOPE);
+	int ox = (o->x >> CSF);
+	int oy = (o->y >> CSF);
+	int first = maxsteps + 1;
+	
+	for(int i=0;i<npoints && first > 0;i++)
+	{
+		int f;
+		
+		if (horizontal)
+			f = sweep_point(ox + points[i].x, oy + points[i].y, dir, maxsteps, true, mask);
+		else
+			f = sweep_point(oy + points[i].y, ox + points[i].x, dir, maxsteps, false, mask);
+		
+		if (f < first) first = f;
+	}
+	
+	// every position before "first" is clear, and we start from position 0
+	return MAX(0, MIN(first - 1, maxsteps));
+}
+
+// the points probed by each pixel of movehandleslope and UpdateBlockStates
+// when moving in the X direction.
+static int sweep_x(Object *o, int dir, int maxsteps)
+{
+SIFSprite *sprite = o->Sprite();
+SIFPointList *plist = (dir > 0) ? &sprite->block_r : &sprite->block_l;
+SIFPoint points[MAX_SWEEP_POINTS];
+int i, npoints = 0;
+
+	// the player can also be blocked by FLAG_SOLID_BRICK objects,
+	// which the map knows nothing about.
+	if (o == player || maxsteps <= 0)
+		return 0;
+	
+	for(i=0;i<plist->count;i++)
+		points[npoints++] = plist->point[i];
+	
+	if (o->nxflags & NXFLAG_FOLLOW_SLOPE)
+	{
+		int xoff = (dir > 0) ? sprite->slopebox.x2 : sprite->slopebox.x1;
+		int opposing_x = (dir > 0) ? sprite->slopebox.x1 : sprite->slopebox.x2;
+		
+		points[npoints++].set(opposing_x, sprite->slopebox.y2 + 1);
+		points[npoints++].set(opposing_x, sprite->slopebox.y1 - 1);
+		points[npoints++].set(xoff, sprite->slopebox.y1);
+		points[npoints++].set(xoff, sprite->slopebox.y2);
+	}
+	
+	return sweep_clear_steps(o, points, npoints, dir, maxsteps, true);
+}
+
+// the same for the Y direction: the blockpoints plus CheckStandOnSlope
+// or CheckBoppedHeadOnSlope.
+static int sweep_y(Object *o, int dir, int maxsteps)
+{
+SIFSprite *sprite = o->Sprite();
+SIFPointList *plist = (dir > 0) ? &sprite->block_d : &sprite->block_u;
+SIFPoint points[MAX_SWEEP_POINTS];
+int i, npoints = 0;
+
+	if (o == player || maxsteps <= 0)
+		return 0;
+	
+	for(i=0;i<plist->count;i++)
+		points[npoints++] = plist->point[i];
+	
+	int y = (dir > 0) ? (sprite->slopebox.y2 + 1) : (sprite->slopebox.y1 - 1);
+	points[npoints++].set(sprite->slopebox.x1, y);
+	points[npoints++].set(sprite->slopebox.x2, y);
+	
+	return sweep_clear_steps(o, points, npoints, dir, maxsteps, false);
+}
+
+/*
+void c------------------------------() {}
+*/
+
 // tries to move the object in the X direction by the given amount.
 // returns nonzero if the object was blocked.
 bool Object::apply_xinertia(int inertia)
@@ -448,6 +579,18 @@ Object * const &o = this;
 	// high speed from becoming embedded in walls
 	if (inertia > 0)
 	{
+		// first take as many pixels as can't possibly be blocked all at once
+		if (!o->blockr)
+		{
+			int steps = sweep_x(o, 1, (inertia - 1) >> CSF);
+			if (steps > 0)
+			{
+				o->x += (steps << CSF);
+				inertia -= (steps << CSF);
+				o->UpdateBlockStates(RIGHTMASK);
+			}
+		}
+		
 		while(inertia > (1<<CSF))
 		{
 			if (movehandleslope(o, (1<<CSF))) return 1;
@@ -458,6 +601,17 @@ Object * const &o = this;
 	}
 	else if (inertia < 0)
 	{
+		if (!o->blockl)
+		{
+			int steps = sweep_x(o, -1, (-inertia - 1) >> CSF);
+			if (steps > 0)
+			{
+				o->x -= (steps << CSF);
+				inertia += (steps << CSF);
+				o->UpdateBlockStates(LEFTMASK);
+			}
+		}
+		
 		while(inertia < -(1<<CSF))
 		{
 			if (movehandleslope(o, -(1<<CSF))) return 1;
@@ -496,6 +650,14 @@ Object * const &o = this;
 	{
 		if (o->blockd) return 1;
 		
+		int steps = sweep_y(o, 1, (inertia - 1) >> CSF);
+		if (steps > 0)
+		{
+			o->y += (steps << CSF);
+			inertia -= (steps << CSF);
+			o->UpdateBlockStates(DOWNMASK);
+		}
+		
 		while(inertia > (1<<CSF))
 		{
 			o->y += (1<<CSF);
@@ -509,6 +671,14 @@ Object * const &o = this;
 	{
 		if (o->blocku) return 1;
 		
+		int steps = sweep_y(o, -1, (-inertia - 1) >> CSF);
+		if (steps > 0)
+		{
+			o->y -= (steps << CSF);
+			inertia += (steps << CSF);
+			o->UpdateBlockStates(UPMASK);
+		}
+		
 		while(inertia < -(1<<CSF))
 		{
 			o->y -= (1<<CSF);
@@ -526,6 +696,168 @@ Object * const &o = this;
 	return 0;
 }
 
+/*
+void c------------------------------() {}
+*/
+
+#ifdef CONFIG_SWEEP_CHECK
+// apply_xinertia and apply_yinertia as they were before they swept, moving
+// every pixel of the way one at a time. only used by sweep_check.
+static bool perpixel_xinertia(Object *o, int inertia)
+{
+	if (inertia == 0)
+		return 0;
+	
+	if (o->flags & FLAG_IGNORE_SOLID)
+	{
+		o->x += inertia;
+		return 0;
+	}
+	
+	if (inertia > 0)
+	{
+		while(inertia > (1<<CSF))
+		{
+			if (movehandleslope(o, (1<<CSF))) return 1;
+			inertia -= (1<<CSF);
+			
+			o->UpdateBlockStates(RIGHTMASK);
+		}
+	}
+	else if (inertia < 0)
+	{
+		while(inertia < -(1<<CSF))
+		{
+			if (movehandleslope(o, -(1<<CSF))) return 1;
+			inertia += (1<<CSF);
+			
+			o->UpdateBlockStates(LEFTMASK);
+		}
+	}
+	
+	if (inertia)
+		movehandleslope(o, inertia);
+	
+	return 0;
+}
+
+static bool perpixel_yinertia(Object *o, int inertia)
+{
+	if (inertia == 0)
+		return 0;
+	
+	if (o->flags & FLAG_IGNORE_SOLID)
+	{
+		o->y += inertia;
+		return 0;
+	}
+	
+	if (inertia > 0)
+	{
+		if (o->blockd) return 1;
+		
+		while(inertia > (1<<CSF))
+		{
+			o->y += (1<<CSF);
+			inertia -= (1<<CSF);
+			
+			o->UpdateBlockStates(DOWNMASK);
+			if (o->blockd) return 1;
+		}
+	}
+	else if (inertia < 0)
+	{
+		if (o->blocku) return 1;
+		
+		while(inertia < -(1<<CSF))
+		{
+			o->y -= (1<<CSF);
+			inertia += (1<<CSF);
+			
+			o->UpdateBlockStates(UPMASK);
+			if (o->blocku) return 1;
+		}
+	}
+	
+	if (inertia)
+		o->y += inertia;
+	
+	return 0;
+}
+
+// checks the swept apply_xinertia and apply_yinertia against the per-pixel
+// versions. the given object (which must not be the player) is dropped at
+// random spots all over the current stage, with and without slope following,
+// and moved by random amounts of up to 24 pixels each way, both ways. returns
+// how many of the moves left it with a different position, different block
+// flags, or a different return value. the object's own position, flags and
+// block state are put back afterwards. uses its own random numbers, so that
+// it's repeatable and doesn't disturb the game's.
+int sweep_check(Object *o, int trials)
+{
+int oldx = o->x, oldy = o->y;
+uint32_t oldflags = o->flags, oldnxflags = o->nxflags;
+uint8_t oldblock[4], startblock[4], expect_block[4];
+uint32_t seed = 0x2545f491;
+int i, failures = 0;
+
+	if (o == player || !map.xsize || !map.ysize)
+		return 0;
+	
+	memcpy(oldblock, o->block, sizeof(oldblock));
+	
+	for(i=0;i<trials;i++)
+	{
+		uint32_t r[4];
+		for(int j=0;j<4;j++)
+		{	// xorshift32
+			seed ^= (seed << 13); seed ^= (seed >> 17); seed ^= (seed << 5);
+			r[j] = seed;
+		}
+		
+		int x = (int)(r[0] % (uint32_t)(map.xsize * TILE_W * (1<<CSF)));
+		int y = (int)(r[1] % (uint32_t)(map.ysize * TILE_H * (1<<CSF)));
+		int inertia = (int)(r[2] % (48 << CSF)) - (24 << CSF);
+		bool vertical = (r[3] & 1);
+		
+		o->flags = (oldflags & ~FLAG_IGNORE_SOLID);
+		if (r[3] & 2) o->nxflags |= NXFLAG_FOLLOW_SLOPE;
+				 else o->nxflags &= ~NXFLAG_FOLLOW_SLOPE;
+		
+		o->x = x; o->y = y;
+		o->UpdateBlockStates(ALLDIRMASK);
+		memcpy(startblock, o->block, sizeof(startblock));
+		
+		bool expect_ret = vertical ? perpixel_yinertia(o, inertia) : perpixel_xinertia(o, inertia);
+		int expect_x = o->x, expect_y = o->y;
+		memcpy(expect_block, o->block, sizeof(expect_block));
+		
+		o->x = x; o->y = y;
+		memcpy(o->block, startblock, sizeof(startblock));
+		
+		bool ret = vertical ? o->apply_yinertia(inertia) : o->apply_xinertia(inertia);
+		
+		if (ret != expect_ret || o->x != expect_x || o->y != expect_y || \
+			memcmp(o->block, expect_block, sizeof(expect_block)))
+		{
+			if (++failures <= 8)
+			{
+				staterr("sweep_check: sprite %d from [%d,%d] moving %c by %d: " \
+						"got [%d,%d] ret %d, per-pixel gave [%d,%d] ret %d", \
+						o->sprite, x, y, vertical ? 'y' : 'x', inertia, \
+						o->x, o->y, ret, expect_x, expect_y, expect_ret);
+			}
+		}
+	}
+	
+	o->x = oldx; o->y = oldy;
+	o->flags = oldflags;
+	o->nxflags = oldnxflags;
+	memcpy(o->block, oldblock, sizeof(oldblock));
+	return failures;
+}
+#endif
+
 
 // handles a moving object with "FLAG_SOLID_BRICK" set
 // pushing the player as it moves.
@@ -681,6 +1013,9 @@ Object * const &o = this;
 	o->hp = 0;
 	o->flags &= ~FLAG_SHOOTABLE;
 	
+	// death handlers can move or change anything, so shots can't trust the grid anymore
+	HitGrid::Invalidate();
+	
 	// auto disappear the bossbar if we have just killed a boss
 	if (o == game.bossbar.object)
 		game.bossbar.defeated = true;
@@ -972,28 +1307,37 @@ Object * const &o = this;
 void c------------------------------() {}
 */
 
+// each routine goes through AICost while it's accounting
+#define CALL_AI_ROUTINE(NAME, WHICH)	\
+{	\
+	void (*routine)(Object *o) = objprop[this->type].ai_routines.NAME;	\
+	if (routine)	\
+	{	\
+		if (AICost::enabled)	\
+			AICost::Call(this, routine, WHICH);	\
+		else	\
+			(*routine)(this);	\
+	}	\
+}
+
 void Object::OnTick()
 {
-	if (objprop[this->type].ai_routines.ontick)
-		(*objprop[this->type].ai_routines.ontick)(this);
+	CALL_AI_ROUTINE(ontick, AIR_ONTICK);
 }
 
 void Object::OnAftermove()
 {
-	if (objprop[this->type].ai_routines.aftermove)
-		(*objprop[this->type].ai_routines.aftermove)(this);
+	CALL_AI_ROUTINE(aftermove, AIR_AFTERMOVE);
 }
 
 void Object::OnSpawn()
 {
-	if (objprop[this->type].ai_routines.onspawn)
-		(*objprop[this->type].ai_routines.onspawn)(this);
+	CALL_AI_ROUTINE(onspawn, AIR_ONSPAWN);
 }
 
 void Object::OnDeath()
 {
-	if (objprop[this->type].ai_routines.ondeath)
-		(*objprop[this->type].ai_routines.ondeath)(this);
+	CALL_AI_ROUTINE(ondeath, AIR_ONDEATH);
 }
 
 
@@ -7,119 +7,37 @@
 #define XP_MED_AMT				5
 #define XP_LARGE_AMT			20
 
-class Object
+class Object;
+
+// weak reference to an object. it reads back as NULL once the object it
+// pointed at has been destroyed, so destroying an object never has to go
+// looking for whoever is linked to it. this relies on object memory coming
+// from a SlabPool, which keeps it mapped after the object is freed.
+class ObjectLink
 {
 public:
-	virtual ~Object() { }		// REQUIRED for subclasses (e.g. Player)
-	
-	void SetType(int type);
-	void ChangeType(int type);
-	void BringToFront();
-	void PushBehind(Object *behind);
-	void PushBehind(int objtype);
-	
-	// --------------------------------------- hit detection w/ map
-	
-	uint32_t GetAttributes(const Point *pointlist, int npoints, int *tile = NULL);
-	
-	bool CheckAttribute(const Point *pointlist, int npoints, uint32_t attrmask, \
-						int *tile_x = NULL, int *tile_y = NULL);
-	
-	bool CheckSolidIntersect(Object *other, const Point *pointlist, int npoints);
-	
-	// --------------------------------------- overridden convenience versions of above
-	
-	bool CheckAttribute(SIFPointList *points, uint32_t attrmask, int *tile_x = NULL, int *tile_y = NULL)
-	{
-		return CheckAttribute(&points->point[0], points->count, attrmask, tile_x, tile_y);
-	}
-	
-	uint32_t GetAttributes(SIFPointList *points, int *tile = NULL)
-	{
-		return GetAttributes(&points->point[0], points->count, tile);
-	}
+	ObjectLink() : fObject(NULL), fSerial(0) { }
+	ObjectLink(Object *o) { Set(o); }
 	
-	bool CheckSolidIntersect(Object *other, SIFPointList *points)
-	{
-		return CheckSolidIntersect(other, &points->point[0], points->count);
-	}
+	ObjectLink &operator= (Object *o) { Set(o); return *this; }
 	
-	// ---------------------------------------
+	operator Object *() const		{ return Get(); }
+	Object *operator-> () const		{ return Get(); }
+	Object *Get() const;
 	
-	void UpdateBlockStates(uint8_t updatemask);
-	void SetBlockForSolidBrick(uint8_t updatemask);
-	int GetBlockingType();
-	
-	// ---------------------------------------
-	
-	bool apply_xinertia(int inertia);
-	bool apply_yinertia(int inertia);
-	void PushPlayerOutOfWay(int xinertia, int yinertia);
-	void SnapToGround();
-	
-	// ---------------------------------------
-	
-	void DealDamage(int dmg, Object *shot = NULL);
-	void Kill();
-	void SpawnPowerups();
-	void SpawnXP(int amt);
-	
-	// ---------------------------------------
-	
-	void RunAI();
-	void DealContactDamage();
-	int GetAttackDirection();
-	
-	void OnTick();
-	void OnAftermove();
-	void OnSpawn();
-	void OnDeath();
-	
-	// ---------------------------------------
-	
-	void animate_seq(int speed, const int *framelist, int nframes);
-	void CurlyTargetHere(int mintime = 80, int maxtime = 100);
-	void ResetClip();
-	void MoveAtDir(int dir, int speed);
-	
-	// ---------------------------------------
-	
-	void Delete();			// mark for deletion at end of frame
-	void Destroy();			// delete immediately
-	void DisconnectGamePointers();
-	
-	// ---------------------------------------
-	
-	int Width();
-	int Height();
-	
-	int BBoxWidth();
-	int BBoxHeight();
-	
-	int CenterX();
-	int CenterY();
-	
-	int Left();
-	int Right();
-	int Top();
-	int Bottom();
-	
-	int SolidLeft();
-	int SolidRight();
-	int SolidTop();
-	int SolidBottom();
-	
-	int ActionPointX();
-	int ActionPointY();
-	int ActionPoint2X();
-	int ActionPoint2Y();
-	int DrawPointX();
-	int DrawPointY();
-	
-	SIFSprite *Sprite();
-	
-	// ---------------------------------------
+private:
+	void Set(Object *o);
 	
+	Object *fObject;
+	uint32_t fSerial;
+};
+
+
+// the data members of an Object. they're kept apart from the class, which has
+// a vtable, so that they're trivially copyable and can be saved and restored
+// as a block; see Objects::SaveState.
+struct ObjectState
+{
 	int type;								// object's type
 	int sprite;								// sprite # to use with object
 	int frame;								// frame of sprite to display
@@ -193,7 +111,16 @@ public:
 	Object *prev, *next;
 	Object *lower, *higher;
 	
-	Object *linkedobject;
+	// lists of all objects with the same type, and with the same id2,
+	// also in order of creation. see Objects::SetIndexedType.
+	Object *prevtype, *nexttype;
+	Object *previd2, *nextid2;
+	
+	ObjectLink linkedobject;
+	
+	// unique for the life of the program, assigned at creation and zeroed
+	// on destruction. lets an ObjectLink tell when it's target is gone.
+	uint32_t serial;
 	
 	// AI variables used for specific AI functions
 	union
@@ -283,6 +210,123 @@ public:
 };
 
 
+class Object : public ObjectState
+{
+public:
+	virtual ~Object() { }		// REQUIRED for subclasses (e.g. Player)
+	
+	// objects are allocated from slab pools and come back zero-filled
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr, size_t size);
+	
+	void SetType(int type);
+	void ChangeType(int type);
+	void BringToFront();
+	void PushBehind(Object *behind);
+	void PushBehind(int objtype);
+	
+	// --------------------------------------- hit detection w/ map
+	
+	uint32_t GetAttributes(const Point *pointlist, int npoints, int *tile = NULL);
+	
+	bool CheckAttribute(const Point *pointlist, int npoints, uint32_t attrmask, \
+						int *tile_x = NULL, int *tile_y = NULL);
+	
+	bool CheckSolidIntersect(Object *other, const Point *pointlist, int npoints);
+	
+	// --------------------------------------- overridden convenience versions of above
+	
+	bool CheckAttribute(SIFPointList *points, uint32_t attrmask, int *tile_x = NULL, int *tile_y = NULL)
+	{
+		return CheckAttribute(&points->point[0], points->count, attrmask, tile_x, tile_y);
+	}
+	
+	uint32_t GetAttributes(SIFPointList *points, int *tile = NULL)
+	{
+		return GetAttributes(&points->point[0], points->count, tile);
+	}
+	
+	bool CheckSolidIntersect(Object *other, SIFPointList *points)
+	{
+		return CheckSolidIntersect(other, &points->point[0], points->count);
+	}
+	
+	// ---------------------------------------
+	
+	void UpdateBlockStates(uint8_t updatemask);
+	void SetBlockForSolidBrick(uint8_t updatemask);
+	int GetBlockingType();
+	
+	// ---------------------------------------
+	
+	bool apply_xinertia(int inertia);
+	bool apply_yinertia(int inertia);
+	void PushPlayerOutOfWay(int xinertia, int yinertia);
+	void SnapToGround();
+	
+	// ---------------------------------------
+	
+	void DealDamage(int dmg, Object *shot = NULL);
+	void Kill();
+	void SpawnPowerups();
+	void SpawnXP(int amt);
+	
+	// ---------------------------------------
+	
+	void RunAI();
+	void DealContactDamage();
+	int GetAttackDirection();
+	
+	void OnTick();
+	void OnAftermove();
+	void OnSpawn();
+	void OnDeath();
+	
+	// ---------------------------------------
+	
+	void animate_seq(int speed, const int *framelist, int nframes);
+	void CurlyTargetHere(int mintime = 80, int maxtime = 100);
+	void ResetClip();
+	void MoveAtDir(int dir, int speed);
+	
+	// ---------------------------------------
+	
+	void Delete();			// mark for deletion at end of frame
+	void Destroy();			// delete immediately
+	void DisconnectGamePointers();
+	
+	// ---------------------------------------
+	
+	int Width();
+	int Height();
+	
+	int BBoxWidth();
+	int BBoxHeight();
+	
+	int CenterX();
+	int CenterY();
+	
+	int Left();
+	int Right();
+	int Top();
+	int Bottom();
+	
+	int SolidLeft();
+	int SolidRight();
+	int SolidTop();
+	int SolidBottom();
+	
+	int ActionPointX();
+	int ActionPointY();
+	int ActionPoint2X();
+	int ActionPoint2Y();
+	int DrawPointX();
+	int DrawPointY();
+	
+	SIFSprite *Sprite();
+};
+
+
 inline int Object::Width()			{ return (sprites[this->sprite].w << CSF); }
 inline int Object::Height()			{ return (sprites[this->sprite].h << CSF); }
 
@@ -312,6 +356,17 @@ inline int Object::DrawPointY()		{ return (sprites[this->sprite].frame[this->fra
 
 inline SIFSprite *Object::Sprite()	{ return &sprites[this->sprite]; }
 
+inline void ObjectLink::Set(Object *o)
+{
+	fObject = o;
+	fSerial = o ? o->serial : 0;
+}
+
+inline Object *ObjectLink::Get() const
+{
+	return (fObject && fObject->serial == fSerial) ? fObject : NULL;
+}
+
 
 // game objects
 
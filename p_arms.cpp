@@ -3,7 +3,7 @@
 #include "p_arms.fdh"
 
 static Object *FireSimpleBullet(int otype, int btype, int xoff=0, int yoff=0);
-static int empty_timer = 0;
+static NX_THREAD int empty_timer = 0;
 
 struct BulletInfo
 {
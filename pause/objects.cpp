@@ -33,7 +33,7 @@ void Options::close_objects()
 	firstobj = lastobj = NULL;
 }
 
-void Options::run_and_draw_objects(void)
+void Options::run_objects(void)
 {
 void (*ai_routine[])(Object *) = {
 	ai_oc_controller,
@@ -41,7 +41,6 @@ void (*ai_routine[])(Object *) = {
 	ai_oc_ikachan
 };
 
-	// draw character
 	Object *o = firstobj;
 	while(o)
 	{
@@ -58,14 +57,21 @@ void (*ai_routine[])(Object *) = {
 		{
 			o->x += o->xinertia;
 			o->y += o->yinertia;
-			
-			draw_sprite(o->x >> CSF, o->y >> CSF, o->sprite, o->frame, o->dir);
 		}
 		
 		o = next;
 	}
 }
 
+void Options::draw_objects(void)
+{
+	for(Object *o = firstobj; o; o = o->next)
+	{
+		if (o->sprite != SPR_NULL)
+			draw_sprite(o->x >> CSF, o->y >> CSF, o->sprite, o->frame, o->dir);
+	}
+}
+
 Object *Options::create_object(int x, int y, int type)
 {
 static Object ZERO;
@@ -127,13 +133,13 @@ static void ai_oc_controller(Object *o)
 			/*if (o->timer < 175)
 			{
 				if ((o->timer % 6) == 1)
-					create_object(-16<<CSF, random(-16, Graphics::SCREEN_HEIGHT) << CSF, OC_CURRENT);
+					create_object(-16<<CSF, fxrandom(-16, Graphics::SCREEN_HEIGHT) << CSF, OC_CURRENT);
 			}*/
 			
 			if (o->timer <= 150)
 			{
 				if ((o->timer % 10) == 1)
-					create_object(-16<<CSF, random(-16, Graphics::SCREEN_HEIGHT) << CSF, OC_IKACHAN);
+					create_object(-16<<CSF, fxrandom(-16, Graphics::SCREEN_HEIGHT) << CSF, OC_IKACHAN);
 			}
 			
 			if (o->timer > 300)
@@ -225,7 +231,7 @@ static void ai_oc_ikachan(Object *o)
 		case 0:
 		{
 			o->state = 1;
-			o->timer = random(3, 20);
+			o->timer = fxrandom(3, 20);
 			o->sprite = SPR_IKACHAN;
 		}
 		case 1:		// he pushes ahead
@@ -233,7 +239,7 @@ static void ai_oc_ikachan(Object *o)
 			if (--o->timer <= 0)
 			{
 				o->state = 2;
-				o->timer = random(10, 50);
+				o->timer = fxrandom(10, 50);
 				o->frame = 1;
 				o->xinertia = 0x600;
 			}
@@ -245,9 +251,9 @@ static void ai_oc_ikachan(Object *o)
 			if (--o->timer <= 0)
 			{
 				o->state = 3;
-				o->timer = random(40, 50);
+				o->timer = fxrandom(40, 50);
 				o->frame = 2;
-				o->yinertia = random(-0x100, 0x100);
+				o->yinertia = fxrandom(-0x100, 0x100);
 			}
 		}
 		break;
@@ -274,7 +280,7 @@ static void ai_oc_ikachan(Object *o)
 static void ai_oc_current(Object *o)
 {
 	o->sprite = SPR_WATER_DROPLET;
-	o->frame = random(0, 4);
+	o->frame = fxrandom(0, 4);
 	
 	o->xinertia = 0x400;
 	
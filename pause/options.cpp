@@ -60,7 +60,6 @@ void c------------------------------() {}
 
 void options_tick()
 {
-int i;
 FocusHolder *fh;
 
 	if (justpushed(F3KEY))
@@ -69,8 +68,7 @@ FocusHolder *fh;
 		return;
 	}
 	
-	ClearScreen(BLACK);
-	Options::run_and_draw_objects();
+	Options::run_objects();
 	
 	fh = optionstack.ItemAt(optionstack.CountItems() - 1);
 	if (fh)
@@ -86,6 +84,25 @@ FocusHolder *fh;
 		}
 	}
 	
+	if (opt.xoffset > 0)
+	{
+		opt.dlg->offset(SLIDE_SPEED, 0);
+		opt.xoffset -= SLIDE_SPEED;
+	}
+}
+
+void options_draw()
+{
+int i;
+FocusHolder *fh;
+
+	// the tick may have just closed the options
+	if (game.paused != GP_OPTIONS)
+		return;
+	
+	ClearScreen(BLACK);
+	Options::draw_objects();
+	
 	for(i=0;;i++)
 	{
 		fh = optionstack.ItemAt(i);
@@ -95,12 +112,6 @@ FocusHolder *fh;
 	}
     
     _vkey_edit_draw();
-	
-	if (opt.xoffset > 0)
-	{
-		opt.dlg->offset(SLIDE_SPEED, 0);
-		opt.xoffset -= SLIDE_SPEED;
-	}
 }
 
 
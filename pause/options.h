@@ -26,7 +26,8 @@ namespace Options
 	
 	void init_objects();
 	void close_objects();
-	void run_and_draw_objects(void);
+	void run_objects(void);
+	void draw_objects(void);
 	Object *create_object(int x, int y, int type);
 
 };	// end namespace
@@ -34,6 +35,7 @@ namespace Options
 
 bool options_init(int param);
 void options_tick(void);
+void options_draw(void);
 void options_close(void);
 
 #endif
@@ -9,45 +9,40 @@ bool pause_init(int param)
 	return 0;
 }
 
-void pause_tick()
+// the tappable areas: resume and reset on the prompt, and "F3:Options"
+static void get_rects(RectI *resume, RectI *reset, RectI *options)
 {
-	ClearScreen(BLACK);
-	
 	int cx = (Graphics::SCREEN_WIDTH / 2) - (sprites[SPR_RESETPROMPT].w / 2);
 	int cy = (Graphics::SCREEN_HEIGHT / 2) - (sprites[SPR_RESETPROMPT].h / 2);
-	draw_sprite(cx, cy, SPR_RESETPROMPT);
+	*resume = RectI(cx + 60, cy, 82, sprites[SPR_RESETPROMPT].h);
+	*reset = RectI(cx + 60 + 82, cy, 70, sprites[SPR_RESETPROMPT].h);
 	
+	const char *str = "F3:Options";
+	cx = (Graphics::SCREEN_WIDTH / 2) - (GetFontWidth(str, 0) / 2) - 4;
+	cy = (Graphics::SCREEN_HEIGHT - 8) - GetFontHeight();
+	*options = RectI(cx, cy, GetFontWidth(str, 0), GetFontHeight());
+}
+
+void pause_tick()
+{
+RectI resume, reset, options;
+
 	// tap control
+	get_rects(&resume, &reset, &options);
+	
+	if (VJoy::ModeAware::wasTap(resume))
 	{
-		RectI r = RectI(cx + 60, cy, 82, sprites[SPR_RESETPROMPT].h);
-		debug_absbox(r.x, r.y, r.x + r.w, r.y + r.h, 255, 255, 255);
-		if (VJoy::ModeAware::wasTap(r))
-		{
-			game.pause(false);
-		}
-
-		r = RectI(cx + 60 + 82, cy, 70, sprites[SPR_RESETPROMPT].h);
-		debug_absbox(r.x, r.y, r.x + r.w, r.y + r.h, 255, 255, 255);
-		if (VJoy::ModeAware::wasTap(r))
-		{
-			game.reset();
-		}
+		game.pause(false);
 	}
 	
-	const char *str = "F3:Options";
-	cx = (Graphics::SCREEN_WIDTH / 2) - (GetFontWidth(str, 0) / 2) - 4;
-	cy = (Graphics::SCREEN_HEIGHT - 8) - GetFontHeight();
-	int f3wd = font_draw(cx, cy, "F3", 0);
-	font_draw(cx + f3wd, cy, ":Options", 0, &bluefont);
+	if (VJoy::ModeAware::wasTap(reset))
+	{
+		game.reset();
+	}
 	
-	// tap control
+	if (VJoy::ModeAware::wasTap(options))
 	{
-		RectI r = RectI(cx, cy, GetFontWidth(str, 0), GetFontHeight());
-		debug_absbox(r.x, r.y, r.x + r.w, r.y + r.h, 255, 255, 255);
-		if (VJoy::ModeAware::wasTap(r))
-		{
-			game.pause(GP_OPTIONS);
-		}
+		game.pause(GP_OPTIONS);
 	}
 	
 	// resume
@@ -78,6 +73,25 @@ void pause_tick()
 
 }
 
+void pause_draw()
+{
+RectI resume, reset, options;
+
+	ClearScreen(BLACK);
+	
+	int cx = (Graphics::SCREEN_WIDTH / 2) - (sprites[SPR_RESETPROMPT].w / 2);
+	int cy = (Graphics::SCREEN_HEIGHT / 2) - (sprites[SPR_RESETPROMPT].h / 2);
+	draw_sprite(cx, cy, SPR_RESETPROMPT);
+	
+	get_rects(&resume, &reset, &options);
+	debug_absbox(resume.x, resume.y, resume.x + resume.w, resume.y + resume.h, 255, 255, 255);
+	debug_absbox(reset.x, reset.y, reset.x + reset.w, reset.y + reset.h, 255, 255, 255);
+	
+	int f3wd = font_draw(options.x, options.y, "F3", 0);
+	font_draw(options.x + f3wd, options.y, ":Options", 0, &bluefont);
+	debug_absbox(options.x, options.y, options.x + options.w, options.y + options.h, 255, 255, 255);
+}
+
 
 
 
@@ -5,5 +5,6 @@
 
 bool pause_init(int retmode);
 void pause_tick(void);
+void pause_draw(void);
 
 #endif
@@ -31,7 +31,7 @@ FILE *fileopen(char const* fname, char const* mode, char const* filesys_path)
    //stat("fileopen %s %s %s", fname, mode, filesys_path);
 
    const size_t buf_size = 1024;
-   static char buffer[buf_size];
+   char buffer[buf_size];
    if (!construct_file_path(fname, filesys_path, buffer, buf_size))
 	   return NULL;
 
@@ -41,7 +41,7 @@ FILE *fileopen(char const* fname, char const* mode, char const* filesys_path)
 SDL_RWops* fileopen_SDL_RWops(char const* filename, char const* mode, char const* filesys_path)
 {
 	const size_t buf_size = 1024;
-	static char buffer[buf_size];
+	char buffer[buf_size];
 	if (!construct_file_path(filename, filesys_path, buffer, buf_size))
 		return NULL;
 
@@ -1,13 +1,10 @@
 
 #include "nx.h"
+#include "profiler.h"
 #include "player.fdh"
 
-Player *player = NULL;
 static void InitWeapon(int wpn, int l1, int l2, int l3, int maxammo=0);
 
-bool pinputs[INPUT_COUNT];
-bool lastpinputs[INPUT_COUNT];
-
 void PInitFirstTime()
 {
 	player->dir = RIGHT;
@@ -108,6 +105,8 @@ void c------------------------------() {}
 
 void HandlePlayer(void)
 {
+	PROFILE_SCOPE("HandlePlayer");
+	
 	// freeze player for the split-second between <TRA to a new map and the
 	// start of the on-entry script for that map. (Fixes: player could shoot during
 	// end sequence if he holds key down).
@@ -311,7 +310,7 @@ int i;
 		{
 			if (!game.frozen && !player->dead && GetCurrentScript() == -1)
 			{
-				if (fade.getstate() == FS_NO_FADE && game.switchstage.mapno == -1)
+				if (world->fFade.getstate() == FS_NO_FADE && game.switchstage.mapno == -1)
 				{
 					game.setmode(GM_MAP_SYSTEM, game.mode);
 				}
@@ -612,7 +611,7 @@ void PDoFalling(void)
 		return;
 	
 	if (game.curmap == STAGE_KINGS_TABLE && \
-		fade.getstate() == FS_FADING)
+		world->fFade.getstate() == FS_FADING)
 		return;
 	
 	// needed to be able to see the falling blocks during
@@ -1623,10 +1622,9 @@ int x, y;
 }
 
 // draws the player
-void DrawPlayer(void)
+// the player's part of RunScene
+void RunPlayerEffects(void)
 {
-int scr_x, scr_y;
-
 	if (player->hide || player->disabled)
 		return;
 	
@@ -1635,6 +1633,30 @@ int scr_x, scr_y;
 	player->DamageText->UpdatePos(player);
 	player->XPText->UpdatePos(player);
 	
+	// animate the air bubble shield
+	if (!player->hurt_flash_state && PHasBubbleShield())
+	{
+		if (++player->water_shield_timer > 1)
+		{
+			player->water_shield_frame ^= 1;
+			player->water_shield_timer = 0;
+		}
+	}
+}
+
+static bool PHasBubbleShield(void)
+{
+	return (((player->touchattr & TA_WATER) && (player->equipmask & EQUIP_AIRTANK)) || \
+			player->movementmode == MOVEMODE_ZEROG);
+}
+
+void DrawPlayer(void)
+{
+int scr_x, scr_y;
+
+	if (player->hide || player->disabled)
+		return;
+	
 	// get screen position to draw him at
 	scr_x = (player->x >> CSF) - (map.displayed_xscroll >> CSF);
 	scr_y = (player->y >> CSF) - (map.displayed_yscroll >> CSF);
@@ -1658,17 +1680,10 @@ int scr_x, scr_y;
 		draw_sprite(scr_x, scr_y, player->sprite, player->frame, player->dir);
 		
 		// draw the air bubble shield if we have it on
-		if (((player->touchattr & TA_WATER) && (player->equipmask & EQUIP_AIRTANK)) || \
-			player->movementmode == MOVEMODE_ZEROG)
+		if (PHasBubbleShield())
 		{
 			draw_sprite_at_dp(scr_x, scr_y, SPR_WATER_SHIELD, \
 							  player->water_shield_frame, player->dir);
-			
-			if (++player->water_shield_timer > 1)
-			{
-				player->water_shield_frame ^= 1;
-				player->water_shield_timer = 0;
-			}
 		}
 	}
 	
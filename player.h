@@ -6,11 +6,10 @@
 #include "ai/weapons/whimstar.h"
 #define MAX_INVENTORY		42
 
-class Player : public Object
+// the data members of the Player, on top of those of an Object. like
+// ObjectState, they're kept trivially copyable for save states.
+struct PlayerState
 {
-public:
-	virtual ~Player();
-	
 	// current physics constants (change when you go underwater, etc)
 	int fallspeed, walkspeed;
 	int fallaccel, jumpfallaccel;
@@ -97,9 +96,11 @@ public:
 	int nrepel_l, nrepel_r, nrepel_u, nrepel_d;
 };
 
-extern Player *player;
-extern bool pinputs[INPUT_COUNT];
-extern bool lastpinputs[INPUT_COUNT];
+class Player : public Object, public PlayerState
+{
+public:
+	virtual ~Player();
+};
 
 enum PMoveModes
 {
@@ -0,0 +1,657 @@
+
+#include "nx.h"
+#include "profiler.h"
+#include "common/SlabPool.h"
+
+#define PROF_MAX_NODES		128
+#define PROF_MAX_DEPTH		10
+#define PROF_MAX_ASYNC		16
+#define PROF_HISTORY		120		// frames shown in the overlay graph
+#define PROF_AVG_FRAMES		30		// how many frames the averages are smoothed over
+
+#define GRAPH_H				40		// height of the overlay graph
+#define GRAPH_US_PER_PX		500		// so it's 20ms high; the budget for one tick
+#define OVERLAY_MAX_LINES	14
+
+#define TRACE_MAX_THREADS	8
+#define TRACE_MAX_EVENTS	32768	// per thread
+
+struct ProfNode
+{
+	ProfZone *zone;
+	int parent, firstchild, nextsibling;
+	int depth;
+	char path[128];			// "run_tick/game_tick_normal/DrawScene", for the CSV
+	
+	double frame_us;		// time spent in it so far this frame
+	int frame_calls;
+	double avg_us;
+	float history[PROF_HISTORY];
+};
+
+struct TraceEvent
+{
+	const char *name;
+	uint64_t time;
+	int value;
+	char phase;				// 'B'egin, 'E'nd or 'C'ounter
+};
+
+// one per thread. a thread claims one the first time it records anything,
+// and from then on is the only one writing to it. count is only advanced
+// once the event has been filled in, so the main thread can read everything
+// below it at any time. the owner is also the only one to reset it: when it
+// sees that a new trace has begun since it last wrote, it empties the buffer
+// before recording, then catches its generation up.
+struct TraceBuffer
+{
+	SDL_atomic_t claimed;
+	SDL_atomic_t ready;
+	SDL_threadID thread;
+	const char *firstzone;	// for naming the thread
+	
+	TraceEvent *events;
+	SDL_atomic_t count;
+	SDL_atomic_t generation;	// of the trace which the events are from
+	int dropped;
+};
+
+bool Profiler::enabled = false;
+
+static ProfNode nodes[PROF_MAX_NODES];
+static int nnodes = 0;
+static int firstroot = -1;
+static int curnode = -1;		// innermost zone the main thread is in
+
+static int profframe = 0;
+static int histpos = 0;
+static double us_per_count = 0;
+static SDL_threadID mainthread;
+
+static bool overlay = false;
+static FILE *csvfp = NULL;
+
+static ProfZone *asynczones[PROF_MAX_ASYNC];
+static SDL_atomic_t nasync;
+
+static TraceBuffer tracebufs[TRACE_MAX_THREADS];
+static TraceEvent *traceevents = NULL;
+static FILE *tracefp = NULL;
+static int trace_frames_left = 0;	// set while a trace is wanted or running
+static volatile bool tracing = false;
+static uint64_t trace_start;
+static SDL_atomic_t trace_generation;	// bumped at the start of each trace
+
+static int enter_node(ProfZone *zone);
+static int find_child(int parent, ProfZone *zone);
+static void register_async(ProfZone *zone);
+static void begin_frame();
+static void end_frame();
+static void update_enabled();
+static TraceBuffer *trace_buffer(const char *zonename);
+static void trace_event(const char *name, char phase, uint64_t time, int value);
+static void begin_trace();
+static void trace_frame_done();
+static void write_trace();
+
+/*
+void c------------------------------() {}
+*/
+
+int Profiler::Enter(ProfZone *zone, uint64_t *start)
+{
+int node;
+
+	*start = SDL_GetPerformanceCounter();
+	node = enter_node(zone);
+	
+	if (tracing)
+	{
+		trace_event(zone->name, 'B', *start, 0);
+		if (node == PROF_OFF)
+			node = PROF_TRACE;
+	}
+	
+	return node;
+}
+
+void Profiler::Leave(ProfZone *zone, int node, uint64_t start)
+{
+uint64_t end = SDL_GetPerformanceCounter();
+double us = (double)(end - start) * us_per_count;
+
+	if (tracing)
+		trace_event(zone->name, 'E', end, 0);
+	
+	if (node == PROF_TRACE)
+		return;
+	
+	if (node == PROF_ASYNC)
+	{
+		SDL_AtomicAdd(&zone->async_us, (int)us);
+		SDL_AtomicAdd(&zone->async_calls, 1);
+		return;
+	}
+	
+	nodes[node].frame_us += us;
+	nodes[node].frame_calls++;
+	
+	curnode = nodes[node].parent;
+	if (curnode < 0)
+		end_frame();
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// works out where in the tree a zone being entered goes
+static int enter_node(ProfZone *zone)
+{
+	if (SDL_ThreadID() != mainthread)
+	{
+		register_async(zone);
+		return PROF_ASYNC;
+	}
+	
+	if (curnode < 0)
+	{
+		if (!zone->frame)
+			return PROF_OFF;
+		
+		begin_frame();
+	}
+	else if (nodes[curnode].depth >= PROF_MAX_DEPTH)
+	{
+		return PROF_OFF;
+	}
+	
+	int node = find_child(curnode, zone);
+	if (node < 0)
+		return PROF_OFF;
+	
+	curnode = node;
+	return node;
+}
+
+// returns the node for the given zone under the given parent
+// (-1 for the top level), creating it the first time it's seen.
+static int find_child(int parent, ProfZone *zone)
+{
+int *link;
+int i;
+
+	link = (parent < 0) ? &firstroot : &nodes[parent].firstchild;
+	for(i = *link; i >= 0; i = nodes[i].nextsibling)
+	{
+		if (nodes[i].zone == zone)
+			return i;
+		
+		link = &nodes[i].nextsibling;
+	}
+	
+	if (nnodes >= PROF_MAX_NODES)
+		return -1;
+	
+	ProfNode *n = &nodes[nnodes];
+	memset(n, 0, sizeof(ProfNode));
+	n->zone = zone;
+	n->parent = parent;
+	n->firstchild = n->nextsibling = -1;
+	
+	if (parent < 0)
+	{
+		maxcpy(n->path, zone->name, sizeof(n->path));
+	}
+	else
+	{
+		n->depth = nodes[parent].depth + 1;
+		snprintf(n->path, sizeof(n->path), "%s/%s", nodes[parent].path, zone->name);
+	}
+	
+	*link = nnodes;
+	return nnodes++;
+}
+
+// the first time a zone is entered off the main thread, it's added to the
+// list of zones which end_frame collects from. several threads could be doing
+// this at once; the CAS makes sure only one of them adds it.
+static void register_async(ProfZone *zone)
+{
+	if (SDL_AtomicGet(&zone->registered))
+		return;
+	
+	if (!SDL_AtomicCAS(&zone->registered, 0, 1))
+		return;
+	
+	int i = SDL_AtomicAdd(&nasync, 1);
+	if (i < PROF_MAX_ASYNC)
+		asynczones[i] = zone;
+}
+
+static void begin_frame()
+{
+	if (trace_frames_left > 0 && !tracing)
+		begin_trace();
+	
+	for(int i=0;i<nnodes;i++)
+	{
+		nodes[i].frame_us = 0;
+		nodes[i].frame_calls = 0;
+	}
+}
+
+static void end_frame()
+{
+int i, count;
+
+	// pick up what the other threads did since the last frame
+	count = SDL_AtomicGet(&nasync);
+	if (count > PROF_MAX_ASYNC) count = PROF_MAX_ASYNC;
+	
+	for(i=0;i<count;i++)
+	{
+		ProfZone *zone = asynczones[i];
+		if (!zone) continue;
+		
+		int node = find_child(-1, zone);
+		if (node < 0) continue;
+		
+		nodes[node].frame_us = SDL_AtomicSet(&zone->async_us, 0);
+		nodes[node].frame_calls = SDL_AtomicSet(&zone->async_calls, 0);
+	}
+	
+	for(i=0;i<nnodes;i++)
+	{
+		ProfNode *n = &nodes[i];
+		
+		n->avg_us += (n->frame_us - n->avg_us) / PROF_AVG_FRAMES;
+		n->history[histpos] = n->frame_us;
+		
+		if (csvfp && n->frame_calls)
+		{
+			fprintf(csvfp, "%d,%s,%d,%d,%.1f\n", profframe, n->path, \
+					n->depth, n->frame_calls, n->frame_us);
+		}
+	}
+	
+	histpos = (histpos + 1) % PROF_HISTORY;
+	profframe++;
+	
+	if (tracing)
+		trace_frame_done();
+	
+	update_enabled();
+}
+
+// only switches off between frames, so that the nesting stays intact
+static void update_enabled()
+{
+	bool want = (overlay || csvfp || trace_frames_left > 0);
+	
+	if (want && !Profiler::enabled)
+	{
+		if (us_per_count == 0)
+			us_per_count = (1000000.0 / (double)SDL_GetPerformanceFrequency());
+		
+		mainthread = SDL_ThreadID();
+	}
+	
+	if (curnode < 0 || want)
+		Profiler::enabled = want;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void Profiler::SetOverlay(bool enable)
+{
+	overlay = enable;
+	update_enabled();
+}
+
+bool Profiler::OverlayVisible()
+{
+	return overlay;
+}
+
+// per-frame times of every zone, in long format so that zones
+// which come and go don't shift the columns around.
+bool Profiler::StartCSV(const char *fname)
+{
+	StopCSV();
+	
+	csvfp = fileopenRW(fname, "wb");
+	if (!csvfp)
+	{
+		staterr("Profiler::StartCSV: failed to open '%s' for writing", fname);
+		return 1;
+	}
+	
+	fprintf(csvfp, "frame,zone,depth,calls,us\n");
+	stat("Profiler: writing frame times to '%s'", fname);
+	
+	update_enabled();
+	return 0;
+}
+
+void Profiler::StopCSV()
+{
+	if (csvfp)
+	{
+		fclose(csvfp);
+		csvfp = NULL;
+		update_enabled();
+	}
+}
+
+bool Profiler::IsWritingCSV()
+{
+	return (csvfp != NULL);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// records a timeline of the given number of frames, starting with the next
+// one. the file is opened now, so as to not find out at the end that it
+// can't be written.
+bool Profiler::StartTrace(const char *fname, int frames)
+{
+int i;
+
+	if (tracefp)
+	{
+		staterr("Profiler::StartTrace: a trace is already being recorded");
+		return 1;
+	}
+	
+	tracefp = fileopenRW(fname, "wb");
+	if (!tracefp)
+	{
+		staterr("Profiler::StartTrace: failed to open '%s' for writing", fname);
+		return 1;
+	}
+	
+	// the buffers are never freed, as other threads could
+	// still be writing to them after a trace ends.
+	if (!traceevents)
+	{
+		traceevents = (TraceEvent *)malloc(sizeof(TraceEvent) * TRACE_MAX_EVENTS * TRACE_MAX_THREADS);
+		for(i=0;i<TRACE_MAX_THREADS;i++)
+			tracebufs[i].events = &traceevents[i * TRACE_MAX_EVENTS];
+	}
+	
+	if (frames <= 0)
+		frames = TRACE_DEFAULT_FRAMES;
+	
+	trace_frames_left = frames;
+	stat("Profiler: tracing %d frames to '%s'", frames, fname);
+	
+	update_enabled();
+	return 0;
+}
+
+// ends a trace early, at the end of the current frame if there is one
+void Profiler::StopTrace()
+{
+	if (!tracefp)
+		return;
+	
+	if (!tracing)
+	{
+		fclose(tracefp);
+		tracefp = NULL;
+		trace_frames_left = 0;
+	}
+	else if (curnode >= 0)
+	{
+		trace_frames_left = 1;
+	}
+	else
+	{
+		write_trace();
+	}
+	
+	update_enabled();
+}
+
+bool Profiler::IsTracing()
+{
+	return (tracefp != NULL);
+}
+
+void Profiler::Counter(const char *name, int value)
+{
+	if (tracing)
+		trace_event(name, 'C', SDL_GetPerformanceCounter(), value);
+}
+
+// finds the calling thread's buffer, claiming a free one if it hasn't got one
+static TraceBuffer *trace_buffer(const char *zonename)
+{
+SDL_threadID self = SDL_ThreadID();
+int i;
+
+	for(i=0;i<TRACE_MAX_THREADS;i++)
+	{
+		TraceBuffer *b = &tracebufs[i];
+		if (SDL_AtomicGet(&b->ready) && b->thread == self)
+			return b;
+	}
+	
+	for(i=0;i<TRACE_MAX_THREADS;i++)
+	{
+		TraceBuffer *b = &tracebufs[i];
+		if (SDL_AtomicCAS(&b->claimed, 0, 1))
+		{
+			b->thread = self;
+			b->firstzone = zonename;
+			SDL_AtomicSet(&b->ready, 1);
+			return b;
+		}
+	}
+	
+	return NULL;
+}
+
+static void trace_event(const char *name, char phase, uint64_t time, int value)
+{
+	TraceBuffer *b = trace_buffer(name);
+	if (!b) return;
+	
+	int generation = SDL_AtomicGet(&trace_generation);
+	if (SDL_AtomicGet(&b->generation) != generation)
+	{
+		SDL_AtomicSet(&b->count, 0);
+		b->dropped = 0;
+		SDL_AtomicSet(&b->generation, generation);
+	}
+	
+	int i = SDL_AtomicGet(&b->count);
+	if (i >= TRACE_MAX_EVENTS)
+	{
+		b->dropped++;
+		return;
+	}
+	
+	TraceEvent *e = &b->events[i];
+	e->name = name;
+	e->time = time;
+	e->value = value;
+	e->phase = phase;
+	
+	SDL_AtomicSet(&b->count, i + 1);
+}
+
+// the buffers are left for their threads to empty; see TraceBuffer
+static void begin_trace()
+{
+	SDL_AtomicAdd(&trace_generation, 1);
+	
+	trace_start = SDL_GetPerformanceCounter();
+	tracing = true;
+}
+
+static void trace_frame_done()
+{
+	uint64_t now = SDL_GetPerformanceCounter();
+	
+	for(SlabPool *pool = SlabPool::First(); pool; pool = pool->Next())
+		trace_event(pool->Name(), 'C', now, pool->CountLive());
+	
+	trace_event("onscreen objects", 'C', now, nOnscreenObjects);
+	
+	if (--trace_frames_left <= 0)
+		write_trace();
+}
+
+static void write_trace()
+{
+int i, j, count;
+int total = 0, dropped = 0;
+
+	tracing = false;
+	trace_frames_left = 0;
+	
+	fprintf(tracefp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(tracefp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"NXEngine\"}}");
+	
+	for(i=0;i<TRACE_MAX_THREADS;i++)
+	{
+		TraceBuffer *b = &tracebufs[i];
+		if (!SDL_AtomicGet(&b->ready))
+			continue;
+		
+		// a thread which hasn't recorded anything in this trace still
+		// holds events from the last one
+		if (SDL_AtomicGet(&b->generation) != SDL_AtomicGet(&trace_generation))
+			continue;
+		
+		count = SDL_AtomicGet(&b->count);
+		if (!count)
+			continue;
+		
+		fprintf(tracefp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s%s\"}}", \
+				i + 1, (b->thread == mainthread) ? "main" : b->firstzone, \
+				(b->thread == mainthread) ? "" : " thread");
+		
+		for(j=0;j<count;j++)
+		{
+			TraceEvent *e = &b->events[j];
+			double ts = (double)(int64_t)(e->time - trace_start) * us_per_count;
+			
+			if (e->phase == 'C')
+			{
+				fprintf(tracefp, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%d}}", \
+						e->name, ts, i + 1, e->value);
+			}
+			else
+			{
+				fprintf(tracefp, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d}", \
+						e->name, e->phase, ts, i + 1);
+			}
+		}
+		
+		total += count;
+		dropped += b->dropped;
+	}
+	
+	fprintf(tracefp, "\n]}\n");
+	fclose(tracefp);
+	tracefp = NULL;
+	
+	stat("Profiler: wrote %d trace events", total);
+	if (dropped)
+		staterr("Profiler: %d trace events were dropped; buffers full", dropped);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static const NXColor graph_colors[] =
+{
+	NXColor(0xe0, 0x40, 0x40),
+	NXColor(0x40, 0xc0, 0x40),
+	NXColor(0x40, 0x80, 0xff),
+	NXColor(0xe0, 0xc0, 0x20),
+	NXColor(0xc0, 0x40, 0xe0),
+	NXColor(0x40, 0xe0, 0xe0)
+};
+#define NUM_GRAPH_COLORS	(sizeof(graph_colors) / sizeof(graph_colors[0]))
+
+// rolling graph of the frame time for the last PROF_HISTORY frames, each bar
+// split up by the zones directly under the frame, and below it the average
+// time of each zone down the tree.
+void Profiler::DrawOverlay()
+{
+static const int x = 4, y = 4;
+int i, root, child, c, line;
+char buf[80];
+
+	if (!overlay || firstroot < 0)
+		return;
+	
+	// the frame zone is the first root; async zones come after it
+	root = firstroot;
+	
+	Graphics::FillRect(x, y, x + PROF_HISTORY - 1, y + GRAPH_H - 1, 0, 0, 0);
+	
+	for(i=0;i<PROF_HISTORY;i++)
+	{
+		int h = (histpos + i) % PROF_HISTORY;
+		int bottom = y + GRAPH_H - 1;
+		
+		for(child = nodes[root].firstchild, c = 0; child >= 0; child = nodes[child].nextsibling, c++)
+		{
+			int px = (int)(nodes[child].history[h] / GRAPH_US_PER_PX);
+			if (px <= 0) continue;
+			
+			int top = bottom - px;
+			if (top < y) top = y;
+			
+			NXColor col = graph_colors[c % NUM_GRAPH_COLORS];
+			Graphics::FillRect(x + i, top, x + i, bottom, col.r, col.g, col.b);
+			
+			bottom = top - 1;
+			if (bottom < y) break;
+		}
+		
+		// whatever the frame zone did itself
+		int px = (int)(nodes[root].history[h] / GRAPH_US_PER_PX) - ((y + GRAPH_H - 1) - bottom);
+		if (px > 0 && bottom >= y)
+		{
+			int top = bottom - px;
+			if (top < y) top = y;
+			Graphics::FillRect(x + i, top, x + i, bottom, 0x80, 0x80, 0x80);
+		}
+	}
+	
+	// walk the tree depth-first
+	line = 0;
+	i = firstroot;
+	while(i >= 0 && line < OVERLAY_MAX_LINES)
+	{
+		ProfNode *n = &nodes[i];
+		
+		snprintf(buf, sizeof(buf), "%*s%s %.2f", n->depth * 2, "", n->zone->name, n->avg_us / 1000.0);
+		font_draw_shaded(x, y + GRAPH_H + 2 + (line * GetFontHeight()), buf, 0, \
+						(n->depth == 1) ? &whitefont : &greenfont);
+		line++;
+		
+		if (n->firstchild >= 0)
+		{
+			i = n->firstchild;
+			continue;
+		}
+		
+		while(i >= 0 && nodes[i].nextsibling < 0)
+			i = nodes[i].parent;
+		
+		if (i >= 0)
+			i = nodes[i].nextsibling;
+	}
+}
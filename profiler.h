@@ -0,0 +1,96 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <SDL.h>
+#include <stdint.h>
+
+// hierarchical frame profiler. PROFILE_SCOPE marks the rest of the enclosing
+// block as a zone; zones entered inside other zones are recorded as their
+// children, so the same function shows up separately under each caller.
+// PROFILE_FRAME marks the outermost zone, which is what makes up one frame;
+// zones on the main thread outside of it are ignored. zones entered on other
+// threads (the music generator) aren't nested, and are summed up and shown
+// at the top level once per frame.
+//
+// while the profiler is off each zone costs a test of Profiler::enabled
+// on the way in and out.
+//
+// the same zones can also be recorded as a timeline, for a set number of
+// frames, and written out in the Chrome trace-event format (load it in
+// chrome://tracing or Perfetto). there every zone on every thread is kept,
+// including ones outside of a frame such as stage loads. each thread writes
+// to a buffer of its own, so recording doesn't take any locks.
+struct ProfZone
+{
+	const char *name;
+	bool frame;
+	
+	// for zones entered off the main thread
+	SDL_atomic_t registered;
+	SDL_atomic_t async_us;
+	SDL_atomic_t async_calls;
+};
+
+#define PROF_OFF		-1
+#define PROF_ASYNC		-2
+#define PROF_TRACE		-3		// only being traced
+
+#define TRACE_DEFAULT_FRAMES	500
+
+namespace Profiler
+{
+	extern bool enabled;
+	
+	int Enter(ProfZone *zone, uint64_t *start);
+	void Leave(ProfZone *zone, int node, uint64_t start);
+	
+	void SetOverlay(bool enable);
+	bool OverlayVisible();
+	void DrawOverlay();
+	
+	bool StartCSV(const char *fname);
+	void StopCSV();
+	bool IsWritingCSV();
+	
+	bool StartTrace(const char *fname, int frames);
+	void StopTrace();
+	bool IsTracing();
+	void Counter(const char *name, int value);
+};
+
+class ProfScope
+{
+public:
+	ProfScope(ProfZone *zone)
+	{
+		fZone = zone;
+		fNode = Profiler::enabled ? Profiler::Enter(zone, &fStart) : PROF_OFF;
+	}
+	
+	~ProfScope()
+	{
+		if (fNode != PROF_OFF)
+			Profiler::Leave(fZone, fNode, fStart);
+	}
+	
+private:
+	ProfZone *fZone;
+	int fNode;
+	uint64_t fStart;
+};
+
+#define PROF_CAT2(A, B)			A##B
+#define PROF_CAT(A, B)			PROF_CAT2(A, B)
+
+#define PROFILE_ZONE(NAME, FRAME)	\
+	static ProfZone PROF_CAT(__pzone, __LINE__) = { NAME, FRAME }; \
+	ProfScope PROF_CAT(__pscope, __LINE__)(&PROF_CAT(__pzone, __LINE__))
+
+#define PROFILE_SCOPE(NAME)		PROFILE_ZONE(NAME, false)
+#define PROFILE_FRAME(NAME)		PROFILE_ZONE(NAME, true)
+
+// a value to graph over time in the trace
+#define PROFILE_COUNTER(NAME, VALUE)	\
+	do { if (Profiler::enabled) Profiler::Counter(NAME, VALUE); } while(0)
+
+#endif
@@ -1,19 +1,30 @@
 
 #include <time.h>
+#include <vector>
 #include "nx.h"
 #include "replay.h"
 #include "profile.h"
+#include "replaystream.h"
 #include "replay.fdh"
 using namespace Replay;
 
-#define REPLAY_MAGICK		0xC322
-static ReplayRecording rec;
-static ReplayPlaying play;
+// the replay being recorded or played belongs to the World
+#define rec						(world->fReplay.rec)
+#define play					(world->fReplay.play)
+#define writer					(world->fReplay.writer)
+#define reader					(world->fReplay.reader)
+#define replay_settings			(world->fReplay.settings)
+#define next_ffwdto				(world->fReplay.next_ffwdto)
+#define next_stopat				(world->fReplay.next_stopat)
+#define next_accel				(world->fReplay.next_accel)
+#define curtickhash				(world->fReplay.tickhash)
+#define keyframes				(world->fReplay.keyframes)
+#define cur_keyframe_interval	(world->fReplay.cur_keyframe_interval)
+#define seek_keyframe			(world->fReplay.seek_keyframe)
 
-static int next_ffwdto = 0;
-static int next_stopat = 0;
-static bool next_accel = false;
-extern int flipacceltime;
+static int hash_interval = DEFAULT_HASH_INTERVAL;
+static int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;
+extern NX_THREAD int flipacceltime;
 
 // begin recording a replay into the given file,
 // creating the save-profile section from the current game state.
@@ -23,7 +34,7 @@ FILE *fp;
 Profile profile;
 
 	end_record();
-	memset(&rec, 0, sizeof(rec));
+	rec = ReplayRecording();
 	
 	stat("begin_record('%s')", fname);
 	
@@ -41,7 +52,7 @@ Profile profile;
 	
 	fseek(fp, PROFILE_LENGTH, SEEK_SET);	// seek to end of profile data
 	
-	rec.hdr.magick = REPLAY_MAGICK;
+	rec.hdr.magick = REPLAY_MAGICK_V2;
 	rec.hdr.randseed = getrand();
 	rec.hdr.locked = false;
 	rec.hdr.total_frames = 0;
@@ -53,11 +64,10 @@ Profile profile;
 	
 	rec.fp = fp;
 	seedrand(rec.hdr.randseed);
+	reset_tick_hash();
+	set_fxrand_shared(false);
 	
-	fputl('MARK', fp);
-	rec.fb.SetFile(fp);
-	rec.fb.SetBufferSize(256);
-	rec.fb.Dump();
+	writer.Begin(fp);
 	return 0;
 }
 
@@ -67,13 +77,9 @@ bool Replay::end_record()
 		return 1;
 	
 	// flush final RLE run
-	write_record(rec.lastkeys, rec.runlength, &rec.fb);
+	writer.WriteRun(rec.lastkeys, rec.runlength);
 	rec.runlength = 0;
-	rec.fb.Flush();
-	rec.fb.SetFile(NULL);
-	
-	fputc('!', rec.fp);
-	fputl('STOP', rec.fp);
+	writer.End();
 	
 	// go back and save the header again so we have total_frames correct.
 	fseek(rec.fp, PROFILE_LENGTH, SEEK_SET);
@@ -81,7 +87,7 @@ bool Replay::end_record()
 	fclose(rec.fp);
 	
 	stat("end_record(): wrote %d frames", rec.hdr.total_frames);
-	memset(&rec, 0, sizeof(rec));
+	rec = ReplayRecording();
 	return 0;
 }
 
@@ -92,32 +98,24 @@ void c------------------------------() {}
 // load the save-game contained with the given replay and begin playback.
 bool Replay::begin_playback(const char *fname)
 {
-FILE *fp;
 Profile profile;
 
 	end_playback();
-	memset(&play, 0, sizeof(play));
+	play = ReplayPlaying();
 	
 	stat("begin_playback('%s')", fname);
 	
 	if (profile_load(fname, &profile))
 		return 1;
 	
-	fp = fileopenCache(fname, "rb");
-	if (!fp)
+	// checks the magick and reads up to the first record
+	if (reader.Open(fname))
 	{
 		staterr("begin_playback: failed to open file %s", fname);
 		return 1;
 	}
 	
-	fseek(fp, PROFILE_LENGTH, SEEK_SET);	// seek to end of profile data
-	fread(&play.hdr, sizeof(ReplayHeader), 1, fp);
-	
-	if (play.hdr.magick != REPLAY_MAGICK)
-	{
-		staterr("begin_playback: magick mismatch on file '%s' (%x shouldbe %x)", fname, play.hdr.magick, REPLAY_MAGICK);
-		return 1;
-	}
+	memcpy(&play.hdr, reader.Header(), sizeof(ReplayHeader));
 	
 	// undo settings we don't want to apply during the replay
 	memcpy(&replay_settings, &play.hdr.settings, sizeof(Settings));
@@ -127,12 +125,14 @@ Profile profile;
 	
 	game_load(&profile);
 	seedrand(play.hdr.randseed);
+	seedfxrand(~play.hdr.randseed);		// so the cosmetic effects come out the same each time too
+	reset_tick_hash();
 	
-	if (fgetl(fp) != 'MARK')
-	{
-		console.Print("Replay fail MARK");
-		return 1;
-	}
+	// replays from before the cosmetic RNG was split off need it shared
+	// again to play back the same, since it used to take from the simulation's.
+	set_fxrand_shared(reader.Version() < REPLAY_STREAM_SPLITRNG);
+	if (get_fxrand_shared())
+		stat("begin_playback: v%d replay; sharing the cosmetic RNG", reader.Version());
 	
 	// debug stuff for replaying at startup from main.cpp
 	play.ffwdto = next_ffwdto;
@@ -144,7 +144,9 @@ Profile profile;
 	play.ffwd_accel = next_accel;
 	next_accel = 0;
 	
-	play.fp = fp;
+	clear_keyframes();
+	
+	play.playing = true;
 //	dump_replay();
 	return 0;
 }
@@ -153,8 +155,13 @@ bool Replay::end_playback()
 {
 	if (!IsPlaying()) return 1;
 	
-	fclose(play.fp);
-	play.fp = NULL;
+	reader.Close();
+	play.playing = false;
+	clear_keyframes();
+	set_fxrand_shared(false);
+	
+	if (play.checkpoints && !play.desynced)
+		stat("end_playback(): all %d checkpoints matched", play.checkpoints);
 	
 	memset(inputs, 0, sizeof(inputs));
 	play.termtimer = 110;
@@ -176,6 +183,7 @@ void Replay::run()
 	if (IsPlaying())
 	{
 		settings = &replay_settings;
+		run_keyframes();
 		run_playback();
 	}
 	else
@@ -194,11 +202,24 @@ void Replay::run_record()
 	rec.hdr.total_frames++;
 	uint32_t keys = EncodeBits(inputs, INPUT_COUNT);
 	
+	// the current run is cut short at a checkpoint, so that the checkpoint
+	// is the next thing playback reads when it reaches the same frame.
+	if (hash_interval > 0 && (rec.hdr.total_frames % hash_interval) == 0)
+	{
+		if (rec.runlength != 0)
+		{
+			writer.WriteRun(rec.lastkeys, rec.runlength);
+			rec.runlength = 0;
+		}
+		
+		write_checkpoint(rec.hdr.total_frames);
+	}
+	
 	if (keys != rec.lastkeys)
 	{
 		if (rec.runlength != 0)
 		{
-			write_record(rec.lastkeys, rec.runlength, &rec.fb);
+			writer.WriteRun(rec.lastkeys, rec.runlength);
 			rec.runlength = 0;
 		}
 		
@@ -224,11 +245,16 @@ static void Replay::run_playback()
 		if (play.ffwd_accel)
 			flipacceltime = 2;	// global variable from main; disables screen->Flip()
 	}
+	else if (play.seekstart)
+	{
+		stat("seek to frame %d took %d ms", play.ffwdto, SDL_GetTicks() - play.seekstart);
+		play.seekstart = 0;
+	}
 	
 	// RLE decoding
 	if (play.runlength == 0)
 	{
-		if (read_record(&play.keys, &play.runlength, play.fp))
+		if (read_record(&play.keys, &play.runlength))
 		{
 			end_playback();
 			play.keys = 0;
@@ -272,49 +298,419 @@ static void Replay::run_playback()
 void c------------------------------() {}
 */
 
-static void write_record(uint32_t keys, uint32_t runlength, FileBuffer *fb)
+static bool read_record(uint32_t *keys, uint32_t *runlength)
 {
-	fb->Write8('[');
-	fb->Write32(keys);
-	fb->Write8(':');
-	fb->Write32(runlength);
-	fb->Write8(']');
+ReplayRecord record;
+
+	for(;;)
+	{
+		switch(reader.Next(&record))
+		{
+			case RR_RUN:
+				*keys = record.keys;
+				*runlength = record.runlength;
+			return REC_OK;
+			
+			// world-state checkpoints come just before the keys for their frame
+			case RR_CHECKPOINT:
+				if (read_checkpoint(&record))
+					return REC_ERR;
+			break;
+			
+			case RR_END:
+			return REC_END;
+			
+			default:
+				console.Print("replay read error at offset %d", reader.Tell());
+			return REC_ERR;
+		}
+	}
 }
 
-static bool read_record(uint32_t *keys, uint32_t *runlength, FILE *fp)
+/*
+void c------------------------------() {}
+*/
+
+// keyframes are taken every so often during playback, and carry out
+// any pending seek. called at the start of each playback tick.
+static void Replay::run_keyframes()
 {
-	char ch = fgetc(fp);
-	if (ch == '!') return REC_END;
+	if (seek_keyframe)
+	{
+		restore_keyframe(seek_keyframe);
+		seek_keyframe = NULL;
+		return;
+	}
+	
+	if (cur_keyframe_interval <= 0 || (play.elapsed_frames % cur_keyframe_interval) != 0)
+		return;
+	
+	if (!keyframes.empty() && keyframes.back()->frame >= play.elapsed_frames)
+		return;
+	
+	if (!SaveState::CanCapture())
+		return;
 	
-	if (feof(fp))
+	ReplayKeyframe *kf = new ReplayKeyframe;
+	kf->frame = play.elapsed_frames;
+	kf->offset = reader.Tell();
+	kf->keys = play.keys;
+	kf->runlength = play.runlength;
+	kf->elapsed_records = play.elapsed_records;
+	kf->checkpoints = play.checkpoints;
+	kf->lastgood = play.lastgood;
+	kf->desynced = play.desynced;
+	kf->tickhash = curtickhash;
+	
+	if (kf->state.Capture())
 	{
-		console.Print("unexpected end of file");
-		return REC_ERR;
+		delete kf;
+		return;
 	}
 	
-	if (ch != '[')
+	keyframes.push_back(kf);
+	
+	// keep memory bounded on long replays by thinning out the keyframes
+	// we have and taking them half as often from here on.
+	if (keyframes.size() > MAX_KEYFRAMES)
 	{
-		console.Print("replay field fail [");
-		return REC_ERR;
+		int i, j = 0;
+		for(i=0;i<(int)keyframes.size();i++)
+		{
+			if (i & 1)
+				delete keyframes[i];
+			else
+				keyframes[j++] = keyframes[i];
+		}
+		
+		keyframes.resize(j);
+		cur_keyframe_interval *= 2;
 	}
+}
+
+static void restore_keyframe(ReplayKeyframe *kf)
+{
+	stat("restore_keyframe: restoring frame %d", kf->frame);
+	
+	if (kf->state.Restore())
+	{
+		staterr("restore_keyframe: failed to restore keyframe at frame %d", kf->frame);
+		return;
+	}
+	
+	reader.SetPos(kf->offset, kf->keys);
+	play.elapsed_frames = kf->frame;
+	play.keys = kf->keys;
+	play.runlength = kf->runlength;
+	play.elapsed_records = kf->elapsed_records;
+	play.checkpoints = kf->checkpoints;
+	play.lastgood = kf->lastgood;
+	play.desynced = kf->desynced;
+	curtickhash = kf->tickhash;
+}
+
+static void clear_keyframes()
+{
+	for(int i=0;i<(int)keyframes.size();i++)
+		delete keyframes[i];
+	
+	keyframes.clear();
+	seek_keyframe = NULL;
+	cur_keyframe_interval = keyframe_interval;
+}
+
+// jump playback to the given frame. the nearest keyframe at or before it is
+// restored at the start of the next tick and the rest of the way is covered
+// by fast-forwarding. going backwards needs a keyframe from earlier in
+// playback; there's always one at frame 0.
+//
+// keyframes are only taken as playback passes them, so a seek past the
+// furthest frame played so far has to simulate every frame from there on,
+// however many that is. if given, from_out is set to the frame the fast-
+// forward starts from and unbounded_out to whether the seek is one of those.
+bool Replay::Seek(int frame, int *from_out, bool *unbounded_out)
+{
+ReplayKeyframe *best = NULL;
+int from = play.elapsed_frames;
+
+	if (!IsPlaying())
+		return 1;
 	
-	*keys = fgetl(fp);
+	if (frame < 0) frame = 0;
 	
-	if (fgetc(fp) != ':')
+	for(int i=0;i<(int)keyframes.size();i++)
 	{
-		console.Print("replay field fail :");
-		return REC_ERR;
+		if (keyframes[i]->frame <= frame)
+			best = keyframes[i];
 	}
 	
-	*runlength = fgetl(fp);
+	if (best && (frame < play.elapsed_frames || best->frame > play.elapsed_frames))
+	{
+		seek_keyframe = best;
+		from = best->frame;
+	}
+	else if (frame < play.elapsed_frames)
+	{
+		staterr("Replay::Seek: no keyframe before frame %d", frame);
+		return 1;
+	}
+	
+	play.ffwdto = frame;
+	play.ffwd_accel = true;
+	play.seekstart = SDL_GetTicks();
 	
-	if (fgetc(fp) != ']')
+	if (from_out) *from_out = from;
+	if (unbounded_out)
 	{
-		console.Print("replay field fail ]");
-		return REC_ERR;
+		int furthest = play.elapsed_frames;
+		if (!keyframes.empty() && keyframes.back()->frame > furthest)
+			furthest = keyframes.back()->frame;
+		
+		*unbounded_out = (frame > furthest);
 	}
 	
-	return REC_OK;
+	return 0;
+}
+
+// sets how often keyframes are taken during playback, for playbacks started
+// from now on; 0 disables them, which also disables seeking backwards.
+void Replay::SetKeyframeInterval(int frames)
+{
+	keyframe_interval = (frames > 0) ? frames : 0;
+}
+
+int Replay::GetKeyframeInterval()
+{
+	return keyframe_interval;
+}
+
+int Replay::CountKeyframes(int *bytes_out)
+{
+	if (bytes_out)
+	{
+		*bytes_out = 0;
+		for(int i=0;i<(int)keyframes.size();i++)
+			*bytes_out += keyframes[i]->state.Size();
+	}
+	
+	return keyframes.size();
+}
+
+/*
+void c------------------------------() {}
+*/
+
+#define HASH_BASIS		0x811C9DC5
+#define HASH_STEP(H, V)	{ H ^= (uint32_t)(V); H *= 0x01000193; }
+
+// hash of the parts of an object that a desync would show up in first
+static uint32_t hash_object(Object *o)
+{
+uint32_t h = HASH_BASIS;
+
+	HASH_STEP(h, o->type);
+	HASH_STEP(h, o->x);
+	HASH_STEP(h, o->y);
+	HASH_STEP(h, o->xinertia);
+	HASH_STEP(h, o->yinertia);
+	HASH_STEP(h, o->dir);
+	HASH_STEP(h, o->state);
+	HASH_STEP(h, o->hp);
+	HASH_STEP(h, o->timer);
+	HASH_STEP(h, o->flags);
+	
+	return h;
+}
+
+// hash of the state that doesn't belong to any one object
+static uint32_t hash_globals()
+{
+uint32_t h = HASH_BASIS;
+int i;
+
+	HASH_STEP(h, getrandseed());
+	HASH_STEP(h, game.curmap);
+	
+	for(i=0;i<NUM_GAMEFLAGS;i++)
+	{
+		if (game.flags[i])
+			HASH_STEP(h, i);
+	}
+	
+	if (player)
+	{
+		HASH_STEP(h, player->equipmask);
+		HASH_STEP(h, player->curWeapon);
+		HASH_STEP(h, player->maxHealth);
+		HASH_STEP(h, player->ninventory);
+	}
+	
+	return h;
+}
+
+// per-object hashes are stored folded to 16 bits to keep checkpoints small
+static inline uint16_t fold16(uint32_t h)
+{
+	return (uint16_t)(h ^ (h >> 16));
+}
+
+// hashes the world as it stands at the end of a tick. called once per tick by
+// game_tick_normal, right after the deleted objects are culled. checkpoints,
+// both when they're written and when they're checked, use what this left
+// rather than going over the world again. anything else (the inventory, the
+// map system, cutscene screens) leaves the last one in place, and does the
+// same on playback.
+void Replay::UpdateTickHash()
+{
+Object *o;
+
+	curtickhash.globals = hash_globals();
+	curtickhash.world = curtickhash.globals;
+	curtickhash.objects.clear();
+	
+	FOREACH_OBJECT(o)
+	{
+		uint32_t entry = ((uint32_t)o->type << 16) | fold16(hash_object(o));
+		curtickhash.objects.push_back(entry);
+		HASH_STEP(curtickhash.world, entry);
+	}
+}
+
+// recording and playback start from a blank tick hash, so that a checkpoint
+// reached before the first game tick doesn't depend on what ran before.
+static void reset_tick_hash()
+{
+	curtickhash.globals = HASH_BASIS;
+	curtickhash.world = HASH_BASIS;
+	curtickhash.objects.clear();
+}
+
+// returns the hash of the complete simulation state as of the end of the last
+// tick. two runs which are in sync will always produce the same value on the
+// same tick.
+uint32_t Replay::WorldHash()
+{
+	return curtickhash.world;
+}
+
+// the objects are stored in list order, so playback can say which
+// object was the first to differ and not just which tick.
+static void write_checkpoint(int tick)
+{
+int i, count = curtickhash.objects.size();
+
+	writer.BeginCheckpoint(tick, curtickhash.globals, count);
+	
+	for(i=0;i<count;i++)
+		writer.CheckpointObject(curtickhash.objects[i] >> 16, curtickhash.objects[i] & 0xffff);
+}
+
+// reads a checkpoint and compares it against the tick hash. only the first
+// mismatch is reported; after that everything is expected to differ.
+static bool read_checkpoint(ReplayRecord *record)
+{
+Object *o, *diff_obj = NULL;
+int diff_index = -1, diff_type = 0;
+int tick, count, i;
+int livecount = curtickhash.objects.size();
+uint32_t globals;
+
+	tick = record->tick;
+	globals = record->globals;
+	count = record->count;
+	
+	o = firstobject;
+	for(i=0;i<count;i++)
+	{
+		int type;
+		uint16_t hash;
+		
+		if (reader.NextObject(&type, &hash))
+		{
+			console.Print("unexpected end of file");
+			return 1;
+		}
+		
+		if (diff_index == -1 && (i >= livecount || \
+			curtickhash.objects[i] != (((uint32_t)type << 16) | hash)))
+		{
+			diff_index = i;
+			diff_type = type;
+			diff_obj = o;
+		}
+		
+		if (o) o = o->next;
+	}
+	
+	play.checkpoints++;
+	if (play.desynced)
+		return 0;
+	
+	if (tick != play.elapsed_frames)
+	{
+		staterr("replay: checkpoint for tick %d read at tick %d", tick, play.elapsed_frames);
+		console.Print("replay desync: checkpoint out of place");
+		play.desynced = true;
+		return 0;
+	}
+	
+	// there are more live objects than there were when recording
+	if (diff_index == -1 && livecount > count)
+	{
+		diff_index = count;
+		diff_obj = o;
+	}
+	
+	bool globals_ok = (globals == curtickhash.globals);
+	if (globals_ok && diff_index == -1)
+	{
+		play.lastgood = tick;
+		return 0;
+	}
+	
+	play.desynced = true;
+	staterr("replay: desync at tick %d (last good checkpoint was tick %d)", tick, play.lastgood);
+	console.Print("replay desync at tick %d", tick);
+	
+	if (!globals_ok)
+		staterr("replay: game flags, RNG or player state differ");
+	
+	if (diff_index != -1)
+	{
+		const char *recorded = (diff_index < count) ? DescribeObjectType(diff_type) : "<none>";
+		const char *live = (diff_index < livecount) ? \
+			DescribeObjectType(curtickhash.objects[diff_index] >> 16) : "<none>";
+		
+		staterr("replay: first differing object is #%d: recorded %s, now %s", diff_index, recorded, live);
+		if (diff_obj)
+		{
+			staterr("replay:   now at [%d,%d] inertia [%d,%d] state %d hp %d", \
+				diff_obj->x >> CSF, diff_obj->y >> CSF, diff_obj->xinertia, diff_obj->yinertia, \
+				diff_obj->state, diff_obj->hp);
+		}
+		
+		console.Print("first differing object: #%d %s", diff_index, recorded);
+	}
+	
+	return 0;
+}
+
+// sets how often recordings store a world-state checkpoint; 0 disables them.
+// playback picks them up wherever they are, so this has no effect on it.
+void Replay::SetHashInterval(int frames)
+{
+	hash_interval = (frames > 0) ? frames : 0;
+}
+
+int Replay::GetHashInterval()
+{
+	return hash_interval;
+}
+
+// true if the current (or last) playback didn't match it's checkpoints
+bool Replay::HasDesynced()
+{
+	return play.desynced;
 }
 
 /*
@@ -468,7 +864,7 @@ void Replay::GetSlotInfo(int slotno, ReplaySlotInfo *slot)
 	GetReplayName(slotno, slot->filename);
 	
 	if (LoadHeader(slot->filename, &slot->hdr) || \
-		slot->hdr.magick != REPLAY_MAGICK)
+		(slot->hdr.magick != REPLAY_MAGICK_V1 && slot->hdr.magick != REPLAY_MAGICK_V2))
 	{
 		slot->status = RS_UNUSED;
 		slot->filename[0] = 0;
@@ -527,6 +923,121 @@ FILE *fp;
 void c------------------------------() {}
 */
 
+// rewrites a replay of any version into the current format. the game
+// doesn't need to be running; the records are copied across as-is.
+bool Replay::Convert(const char *infile, const char *outfile)
+{
+ReplayReader in;
+ReplayWriter out;
+ReplayRecord record;
+ReplayHeader hdr;
+Profile profile;
+FILE *fp;
+int kind, type, i;
+uint16_t hash;
+
+	stat("Replay::Convert('%s' -> '%s')", infile, outfile);
+	
+	if (profile_load(infile, &profile)) return 1;
+	if (in.Open(infile)) return 1;
+	
+	if (profile_save(outfile, &profile)) return 1;
+	fp = fileopenCache(outfile, "r+");
+	if (!fp)
+	{
+		staterr("Replay::Convert: failed to open file %s", outfile);
+		return 1;
+	}
+	
+	memcpy(&hdr, in.Header(), sizeof(ReplayHeader));
+	hdr.magick = REPLAY_MAGICK_V2;
+	
+	fseek(fp, PROFILE_LENGTH, SEEK_SET);
+	fwrite(&hdr, sizeof(ReplayHeader), 1, fp);
+	
+	// keep older replays marked as sharing the cosmetic RNG
+	out.Begin(fp, (in.Version() < REPLAY_STREAM_SPLITRNG) ? 2 : REPLAY_STREAM_VERSION);
+	
+	while((kind = in.Next(&record)) != RR_END)
+	{
+		if (kind == RR_ERROR)
+		{
+			staterr("Replay::Convert: '%s' is damaged; the rest of it is lost", infile);
+			break;
+		}
+		
+		if (kind == RR_RUN)
+		{
+			out.WriteRun(record.keys, record.runlength);
+			continue;
+		}
+		
+		out.BeginCheckpoint(record.tick, record.globals, record.count);
+		for(i=0;i<record.count;i++)
+		{
+			if (in.NextObject(&type, &hash))
+				break;
+			
+			out.CheckpointObject(type, hash);
+		}
+		
+		if (i < record.count)
+		{
+			staterr("Replay::Convert: '%s' ends inside a checkpoint", infile);
+			break;
+		}
+	}
+	
+	out.End();
+	fclose(fp);
+	
+	stat("Replay::Convert: %d -> %d bytes", in.Length(), (int)out.Tell());
+	return (kind != RR_END);
+}
+
+// reads through a whole replay file without playing it
+bool Replay::Scan(const char *fname, ReplayFileInfo *info)
+{
+ReplayReader in;
+ReplayRecord record;
+int kind, type;
+uint16_t hash;
+
+	memset(info, 0, sizeof(ReplayFileInfo));
+	if (in.Open(fname))
+		return 1;
+	
+	info->version = in.Version();
+	info->size = in.Length();
+	info->mapped = in.IsMapped();
+	info->index_entries = in.CountIndex();
+	
+	while((kind = in.Next(&record)) != RR_END)
+	{
+		if (kind == RR_ERROR)
+			return 1;
+		
+		if (kind == RR_RUN)
+		{
+			info->frames += record.runlength;
+			info->records++;
+		}
+		else
+		{
+			for(int i=0;i<record.count;i++)
+				in.NextObject(&type, &hash);
+			
+			info->checkpoints++;
+		}
+	}
+	
+	return 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
 // converts a framecount value into a textual total time.
 void Replay::FramesToTime(int framecount, char *buffer)
 {
@@ -562,7 +1073,7 @@ bool Replay::IsRecording()
 
 bool Replay::IsPlaying()
 {
-	return (play.fp != NULL);
+	return play.playing;
 }
 
 void Replay::close()
@@ -636,7 +1147,7 @@ void c------------------------------() {}
 static void dump_replay()
 {
 	stat("=== Header ===");
-	stat("magick: %04x (%s)", play.hdr.magick, (play.hdr.magick == REPLAY_MAGICK) ? "correct" : "not correct");
+	stat("magick: %04x (%s)", play.hdr.magick, (play.hdr.magick == REPLAY_MAGICK_V2) ? "v2" : "v1");
 	stat("randseed: %08x", play.hdr.randseed);
 	stat("locked: %d", play.hdr.locked);
 	stat("total_frames: %d (%d secs)", play.hdr.total_frames, play.hdr.total_frames / 50);
@@ -674,40 +1185,43 @@ static void dump_replay()
 		stat("  %08x  %08x", play.hdr.settings.input_mappings[i], input_get_mapping(i));
 	}*/
 	
-	fseek(play.fp, ftell(play.fp) - 0x2b, SEEK_SET);	// 0x6a9
-	stat("First Read %08x", fgetl(play.fp));
-	stat("Starting read at offset %04x", ftell(play.fp));
-	//exit(1);
+	ReplayRecord record;
+	int total_frames = 0;
+	int nrecord = 0;
+	int type;
+	uint16_t hash;
 	
-	//exit(1);
-	//int offset = 1;
-	//fseek(play.fp, ftell(play.fp)+offset, SEEK_SET);
+	stat("Starting read at offset %04x (version %d)", reader.Tell(), reader.Version());
 	
-	int total_frames = 0;
-	int record = 0;
-	uint32_t lastkeys = 0xffffffff;
-	while(!feof(play.fp))
-	{
-		uint32_t keys = fgetl(play.fp);
-		uint32_t runlength = fgetl(play.fp);
-		if (runlength == 0xffffffff || feof(play.fp)) break;
-		total_frames += runlength;
-		
-		stat("%04d  len %08x:  keys %08x     offset %08x", record++, runlength, keys, ftell(play.fp)-8);
+	for(;;)
+	{
+		uint32_t offset = reader.Tell();
+		int kind = reader.Next(&record);
 		
-		if (keys == lastkeys)
+		if (kind == RR_RUN)
 		{
-			staterr(" -- impossible key repeat");
-			if (runlength < 0x200000) break;
+			stat("%04d  len %08x:  keys %08x     offset %08x", nrecord++, record.runlength, record.keys, offset);
+			total_frames += record.runlength;
+			
+			if (record.runlength >= 0x200000)
+			{
+				staterr(" -- bogus runlength %08x", record.runlength);
+				break;
+			}
 		}
-		
-		if (runlength >= 0x200000)
+		else if (kind == RR_CHECKPOINT)
 		{
-			staterr(" -- bogus runlength %08x", runlength);
+			stat("      checkpoint tick %d, %d objects     offset %08x", record.tick, record.count, offset);
+			for(int i=0;i<record.count;i++)
+				reader.NextObject(&type, &hash);
+		}
+		else
+		{
+			if (kind == RR_ERROR)
+				staterr(" -- read error at offset %08x", offset);
+			
 			break;
 		}
-		
-		lastkeys = keys;
 	}
 	
 	//total_frames--;
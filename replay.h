@@ -2,12 +2,20 @@
 #ifndef _REPLAY_H
 #define _REPLAY_H
 
-#include "common/FileBuffer.h"
+#include <vector>
+#include "common/basics.h"
+#include "savestate.h"
+
 #define MAX_REPLAYS				8	// how many automatic replays to save
 
 #define REC_OK		0
 #define REC_ERR		1
 #define REC_END		2
+
+#define DEFAULT_HASH_INTERVAL	60	// frames between world-state checkpoints
+
+#define DEFAULT_KEYFRAME_INTERVAL	300	// frames between keyframes during playback
+#define MAX_KEYFRAMES				256	// past this, every other keyframe is dropped
 struct ReplayHeader
 {
 	uint16_t magick;
@@ -22,7 +30,6 @@ struct ReplayHeader
 struct ReplayRecording
 {
 	ReplayHeader hdr;
-	FileBuffer fb;
 	
 	uint32_t lastkeys;
 	uint32_t runlength;
@@ -37,12 +44,68 @@ struct ReplayPlaying
 	uint32_t runlength;
 	int elapsed_frames;
 	int elapsed_records;
-	FILE *fp;
+	bool playing;
 	
 	int ffwdto, ffwd_accel;
 	int stopat;
 	
 	int termtimer;		// blinks "TERMINATED" after replay ends
+	
+	int checkpoints;	// number of world-state checkpoints verified
+	int lastgood;		// tick of the last checkpoint that matched
+	bool desynced;		// set once the first mismatching checkpoint is reported
+	
+	uint32_t seekstart;	// time a seek began, while fast-forwarding to ffwdto
+};
+
+// the world-state hash as of the end of a tick, worked out once per tick and
+// kept for the checkpoints. each object gets its type in the top 16 bits and
+// its hash folded to 16 bits in the bottom, in list order.
+struct ReplayTickHash
+{
+	uint32_t globals;
+	uint32_t world;		// globals and every object together
+	std::vector<uint32_t> objects;
+};
+
+// a save state taken during playback, along with where playback was in the
+// replay at the time, so that seeking can start from it instead of frame 0.
+struct ReplayKeyframe
+{
+	int frame;			// elapsed_frames when it was taken
+	uint32_t offset;	// read position in the replay
+	uint32_t keys;
+	uint32_t runlength;
+	int elapsed_records;
+	
+	int checkpoints, lastgood;
+	bool desynced;
+	
+	ReplayTickHash tickhash;
+	SaveState state;
+};
+
+#include "replaystream.h"
+
+// everything about the replay being recorded or played back.
+// it belongs to the World (see world.h).
+struct ReplayState
+{
+	ReplayRecording rec;
+	ReplayPlaying play;
+	ReplayWriter writer;
+	ReplayReader reader;
+	Settings settings;		// in effect while playing back
+	
+	int next_ffwdto;
+	int next_stopat;
+	bool next_accel;
+	
+	ReplayTickHash tickhash;		// as of the end of the last game tick
+	
+	std::vector<ReplayKeyframe *> keyframes;
+	int cur_keyframe_interval;
+	ReplayKeyframe *seek_keyframe;	// to be restored at the start of the next tick
 };
 
 enum RS_Status
@@ -59,6 +122,19 @@ struct ReplaySlotInfo
 	ReplayHeader hdr;			// header from slot
 };
 
+// what Replay::Scan found in a replay file
+struct ReplayFileInfo
+{
+	int version;
+	int size;
+	bool mapped;
+	
+	int frames;			// counted from the records, not taken from the header
+	int records;
+	int checkpoints;
+	int index_entries;
+};
+
 
 namespace Replay
 {
@@ -81,6 +157,20 @@ namespace Replay
 	void set_ffwd(int frame, bool accel=true);
 	void set_stopat(int frame);
 	
+	bool Seek(int frame, int *from_out = NULL, bool *unbounded_out = NULL);
+	void SetKeyframeInterval(int frames);
+	int GetKeyframeInterval();
+	int CountKeyframes(int *bytes_out = NULL);
+	
+	void UpdateTickHash();
+	uint32_t WorldHash();
+	void SetHashInterval(int frames);
+	int GetHashInterval();
+	bool HasDesynced();
+	
+	
+	bool Convert(const char *infile, const char *outfile);
+	bool Scan(const char *fname, ReplayFileInfo *info);
 	
 	bool LoadHeader(const char *fname, ReplayHeader *hdr);
 	bool SaveHeader(const char *fname, ReplayHeader *hdr);
@@ -94,6 +184,7 @@ namespace Replay
 	
 	static void run_record();
 	static void run_playback();
+	static void run_keyframes();
 	
 	static int GetAvailableSlot(void);
 };
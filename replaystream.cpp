@@ -0,0 +1,336 @@
+
+#include "nx.h"
+#include "profile.h"
+#include "replaystream.h"
+#include "common/bufio.h"
+
+#define WRITER_FLUSH_SIZE		4096
+
+ReplayWriter::ReplayWriter()
+{
+	fFP = NULL;
+}
+
+// starts a stream at the current position of fp,
+// which should be just after the ReplayHeader.
+bool ReplayWriter::Begin(FILE *fp, int version)
+{
+	fFP = fp;
+	fBase = ftell(fp);
+	fWritten = 0;
+	fPrevKeys = 0;
+	fFrames = 0;
+	fNextIndex = 0;
+	fIndex.clear();
+	fBuffer.Clear();
+	
+	// index position and count are filled in by End()
+	write_U32(&fBuffer, REPLAY_STREAM_MAGICK);
+	write_U8(&fBuffer, version);
+	write_U32(&fBuffer, 0);
+	write_U32(&fBuffer, 0);
+	write_U32(&fBuffer, REPLAY_INDEX_INTERVAL);
+	
+	return 0;
+}
+
+void ReplayWriter::WriteRun(uint32_t keys, uint32_t runlength)
+{
+	if (runlength == 0)
+		return;
+	
+	if (fFrames >= fNextIndex)
+	{
+		ReplayIndexEntry entry;
+		entry.frame = fFrames;
+		entry.offset = Tell();
+		entry.keys = fPrevKeys;
+		
+		fIndex.push_back(entry);
+		fNextIndex = fFrames + REPLAY_INDEX_INTERVAL;
+	}
+	
+	if (keys == fPrevKeys)
+	{
+		write_UVarint(&fBuffer, (runlength << 2) | RK_RUN);
+	}
+	else
+	{
+		write_UVarint(&fBuffer, (runlength << 2) | RK_KEYS);
+		write_UVarint(&fBuffer, keys ^ fPrevKeys);
+		fPrevKeys = keys;
+	}
+	
+	fFrames += runlength;
+	Flush(WRITER_FLUSH_SIZE);
+}
+
+// to be followed by exactly count calls to CheckpointObject
+void ReplayWriter::BeginCheckpoint(int tick, uint32_t globals, int count)
+{
+	write_UVarint(&fBuffer, (tick << 2) | RK_CHECK);
+	write_U32(&fBuffer, globals);
+	write_UVarint(&fBuffer, count);
+}
+
+void ReplayWriter::CheckpointObject(int type, uint16_t hash)
+{
+	write_UVarint(&fBuffer, type);
+	write_U16(&fBuffer, hash);
+	Flush(WRITER_FLUSH_SIZE);
+}
+
+// finishes off the stream with the end marker and the index. the file is
+// left open, positioned at the end of the stream.
+bool ReplayWriter::End()
+{
+	if (!fFP)
+		return 1;
+	
+	write_UVarint(&fBuffer, RK_END);
+	
+	uint32_t index_offset = Tell();
+	for(int i=0;i<(int)fIndex.size();i++)
+	{
+		write_U32(&fBuffer, fIndex[i].frame);
+		write_U32(&fBuffer, fIndex[i].offset);
+		write_U32(&fBuffer, fIndex[i].keys);
+	}
+	
+	Flush(0);
+	
+	// go back and fill in the index location
+	long end = ftell(fFP);
+	fseek(fFP, fBase + 5, SEEK_SET);
+	fputl(index_offset, fFP);
+	fputl(fIndex.size(), fFP);
+	fseek(fFP, end, SEEK_SET);
+	
+	fFP = NULL;
+	fIndex.clear();
+	return 0;
+}
+
+void ReplayWriter::Flush(int threshold)
+{
+	if (fBuffer.Length() > threshold)
+	{
+		fwrite(fBuffer.Data(), fBuffer.Length(), 1, fFP);
+		fWritten += fBuffer.Length();
+		fBuffer.Clear();
+	}
+}
+
+/*
+void c------------------------------() {}
+*/
+
+ReplayReader::ReplayReader()
+{
+	fVersion = 0;
+	fIn = fEnd = NULL;
+	fIndex = NULL;
+	fIndexCount = 0;
+}
+
+// opens a replay file of either version, leaving the reader
+// positioned at the first record.
+bool ReplayReader::Open(const char *fname)
+{
+FILE *fp;
+const uint8_t *data;
+
+	Close();
+	
+	fp = fileopenCache(fname, "rb");
+	if (!fp)
+	{
+		staterr("ReplayReader::Open: failed to open file %s", fname);
+		return 1;
+	}
+	
+	bool result = fFile.Open(fp);
+	fclose(fp);
+	if (result) return 1;
+	
+	// the profile and header are always there, whichever version it is
+	if (fFile.Length() < PROFILE_LENGTH + (int)sizeof(ReplayHeader) + 4)
+	{
+		staterr("ReplayReader::Open: '%s' is too short to be a replay", fname);
+		Close();
+		return 1;
+	}
+	
+	data = fFile.Data() + PROFILE_LENGTH;
+	memcpy(&fHeader, data, sizeof(ReplayHeader));
+	data += sizeof(ReplayHeader);
+	
+	fIn = data;
+	fEnd = fFile.Data() + (fFile.Length() - 1);
+	fPrevKeys = 0;
+	
+	if (fHeader.magick == REPLAY_MAGICK_V1)
+	{
+		fVersion = 1;
+		
+		if (read_U32(&fIn, fEnd) != 'MARK')
+		{
+			staterr("ReplayReader::Open: '%s': missing MARK", fname);
+			Close();
+			return 1;
+		}
+	}
+	else if (fHeader.magick == REPLAY_MAGICK_V2)
+	{
+		if (read_U32(&fIn, fEnd) != REPLAY_STREAM_MAGICK)
+		{
+			staterr("ReplayReader::Open: '%s': bad stream magick", fname);
+			Close();
+			return 1;
+		}
+		
+		fVersion = read_U8(&fIn, fEnd);
+		uint32_t index_offset = read_U32(&fIn, fEnd);
+		fIndexCount = read_U32(&fIn, fEnd);
+		read_U32(&fIn, fEnd);		// index interval; the entries carry their frames
+		
+		if (fVersion < 2 || fVersion > REPLAY_STREAM_VERSION)
+		{
+			staterr("ReplayReader::Open: '%s': unsupported stream version %d", fname, fVersion);
+			Close();
+			return 1;
+		}
+		
+		// a file that was never finished has no index, but
+		// the records which did make it out are still good.
+		if (index_offset == 0 || index_offset > (uint32_t)fFile.Length() || \
+			index_offset + (fIndexCount * 12) > (uint32_t)fFile.Length())
+		{
+			stat("ReplayReader::Open: '%s' has no index", fname);
+			fIndexCount = 0;
+		}
+		else
+		{
+			fIndex = fFile.Data() + index_offset;
+			fEnd = fIndex - 1;
+		}
+	}
+	else
+	{
+		staterr("ReplayReader::Open: magick mismatch on file '%s' (%x)", fname, fHeader.magick);
+		Close();
+		return 1;
+	}
+	
+	return 0;
+}
+
+void ReplayReader::Close()
+{
+	fFile.Close();
+	fVersion = 0;
+	fIn = fEnd = NULL;
+	fIndex = NULL;
+	fIndexCount = 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// reads the next record. after RR_CHECKPOINT, NextObject must be called
+// rec->count times before Next is called again.
+int ReplayReader::Next(ReplayRecord *rec)
+{
+	if (fIn > fEnd)
+	{
+		staterr("ReplayReader::Next: unexpected end of file");
+		return RR_ERROR;
+	}
+	
+	if (fVersion == 1)
+	{
+		switch(read_U8(&fIn, fEnd))
+		{
+			case '[':
+			{
+				rec->keys = read_U32(&fIn, fEnd);
+				if (read_U8(&fIn, fEnd) != ':')
+				{
+					staterr("ReplayReader::Next: replay field fail :");
+					return RR_ERROR;
+				}
+				
+				rec->runlength = read_U32(&fIn, fEnd);
+				if (read_U8(&fIn, fEnd) != ']')
+				{
+					staterr("ReplayReader::Next: replay field fail ]");
+					return RR_ERROR;
+				}
+			}
+			return RR_RUN;
+			
+			case '#':
+			{
+				rec->tick = read_U32(&fIn, fEnd);
+				rec->globals = read_U32(&fIn, fEnd);
+				rec->count = read_U32(&fIn, fEnd);
+			}
+			return RR_CHECKPOINT;
+			
+			case '!': return RR_END;
+			
+			default:
+				staterr("ReplayReader::Next: replay field fail [ at offset %d", Tell() - 1);
+			return RR_ERROR;
+		}
+	}
+	
+	uint32_t value = read_UVarint(&fIn, fEnd);
+	switch(value & 3)
+	{
+		case RK_RUN:
+			rec->keys = fPrevKeys;
+			rec->runlength = (value >> 2);
+		return RR_RUN;
+		
+		case RK_KEYS:
+			fPrevKeys ^= read_UVarint(&fIn, fEnd);
+			rec->keys = fPrevKeys;
+			rec->runlength = (value >> 2);
+		return RR_RUN;
+		
+		case RK_CHECK:
+			rec->tick = (value >> 2);
+			rec->globals = read_U32(&fIn, fEnd);
+			rec->count = read_UVarint(&fIn, fEnd);
+		return RR_CHECKPOINT;
+	}
+	
+	return RR_END;
+}
+
+bool ReplayReader::NextObject(int *type, uint16_t *hash)
+{
+	if (fIn > fEnd)
+	{
+		staterr("ReplayReader::NextObject: unexpected end of file");
+		return 1;
+	}
+	
+	if (fVersion == 1)
+		*type = read_U16(&fIn, fEnd);
+	else
+		*type = read_UVarint(&fIn, fEnd);
+	
+	*hash = read_U16(&fIn, fEnd);
+	return 0;
+}
+
+// puts the read position back to somewhere it was before. prevkeys is the
+// keys of the last run read before that point, for v2 delta-decoding.
+void ReplayReader::SetPos(uint32_t offset, uint32_t prevkeys)
+{
+	fIn = fFile.Data() + offset;
+	fPrevKeys = prevkeys;
+}
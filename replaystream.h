@@ -0,0 +1,143 @@
+
+#ifndef _REPLAYSTREAM_H
+#define _REPLAYSTREAM_H
+
+#include <vector>
+#include "common/MappedFile.h"
+
+/*
+	A replay file is a profile (PROFILE_LENGTH bytes) followed by a raw
+	ReplayHeader, whose magick says which format the input stream after it is in.
+	
+	version 1 (REPLAY_MAGICK_V1):
+		'MARK'
+		'[' keys32 ':' runlength32 ']'				a run of frames with the same keys
+		'#' tick32 globals32 count32 { type16 hash16 } * count		checkpoint
+		'!' 'STOP'
+	
+	version 2 (REPLAY_MAGICK_V2):
+		'RPL2' version8 index_offset32 index_count32 index_interval32
+		records, each starting with a varint (value << 2) | kind:
+			RK_RUN		runlength in value; keys the same as the last run
+			RK_KEYS		runlength in value, then varint keys XOR the last run's keys
+			RK_CHECK	tick in value, then globals32 varint(count) { varint(type) hash16 } * count
+			RK_END		value is 0
+		index: { frame32 offset32 keys32 } * index_count
+	
+	version 3 is laid out the same as version 2. it marks replays recorded with
+	cosmetic effects drawing from their own random numbers (see fxrandom());
+	earlier versions are played back with them sharing the simulation's.
+	
+	Offsets in the index are from the start of the file. A typical run takes
+	2-3 bytes in v2 against 11 in v1, and checkpoints about half the space.
+*/
+
+#define REPLAY_MAGICK_V1		0xC322
+#define REPLAY_MAGICK_V2		0xC323
+
+#define REPLAY_STREAM_MAGICK	'RPL2'
+#define REPLAY_STREAM_VERSION	3
+#define REPLAY_STREAM_SPLITRNG	3			// first version with a separate cosmetic RNG
+#define REPLAY_INDEX_INTERVAL	3600		// frames between index entries (1 min @ 60fps)
+
+enum RecordKind
+{
+	RK_RUN,
+	RK_KEYS,
+	RK_CHECK,
+	RK_END
+};
+
+// what ReplayReader::Next found
+enum
+{
+	RR_RUN,
+	RR_CHECKPOINT,
+	RR_END,
+	RR_ERROR
+};
+
+struct ReplayIndexEntry
+{
+	uint32_t frame;		// frames which come before this run
+	uint32_t offset;	// file offset of the run
+	uint32_t keys;		// keys of the run before it, for delta-decoding from here
+};
+
+struct ReplayRecord
+{
+	uint32_t keys;			// RR_RUN
+	uint32_t runlength;
+	
+	int tick;				// RR_CHECKPOINT; the objects are read
+	uint32_t globals;		// with NextObject().
+	int count;
+};
+
+// writes a version 2 or 3 input stream, buffering it in memory and writing it out
+// in large blocks. the index is held until End() and written after the records.
+class ReplayWriter
+{
+public:
+	ReplayWriter();
+	
+	bool Begin(FILE *fp, int version = REPLAY_STREAM_VERSION);
+	void WriteRun(uint32_t keys, uint32_t runlength);
+	void BeginCheckpoint(int tick, uint32_t globals, int count);
+	void CheckpointObject(int type, uint16_t hash);
+	bool End();
+	
+	bool IsOpen()		{ return (fFP != NULL); }
+	uint32_t Tell()		{ return fBase + fWritten + fBuffer.Length(); }
+	
+private:
+	void Flush(int threshold);
+	
+	FILE *fFP;
+	DBuffer fBuffer;
+	uint32_t fBase;			// file offset of the stream header
+	uint32_t fWritten;		// bytes flushed to fFP so far
+	
+	uint32_t fPrevKeys;
+	uint32_t fFrames;
+	uint32_t fNextIndex;
+	std::vector<ReplayIndexEntry> fIndex;
+};
+
+// reads either version of a replay file out of a MappedFile.
+class ReplayReader
+{
+public:
+	ReplayReader();
+	
+	bool Open(const char *fname);
+	void Close();
+	bool IsOpen()					{ return fFile.IsOpen(); }
+	
+	int Next(ReplayRecord *rec);
+	bool NextObject(int *type, uint16_t *hash);
+	
+	uint32_t Tell()					{ return (fIn - fFile.Data()); }
+	void SetPos(uint32_t offset, uint32_t prevkeys);
+	
+	ReplayHeader *Header()			{ return &fHeader; }
+	int Version()					{ return fVersion; }
+	int Length()					{ return fFile.Length(); }
+	bool IsMapped()					{ return fFile.IsMapped(); }
+	
+	int CountIndex()				{ return fIndexCount; }
+	
+private:
+	MappedFile fFile;
+	ReplayHeader fHeader;
+	int fVersion;
+	
+	const uint8_t *fIn;
+	const uint8_t *fEnd;		// last byte of the records (inclusive, as for bufio)
+	uint32_t fPrevKeys;
+	
+	const uint8_t *fIndex;
+	int fIndexCount;
+};
+
+#endif
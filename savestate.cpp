@@ -0,0 +1,237 @@
+
+#include "nx.h"
+#include "savestate.h"
+#include "hitgrid.h"
+
+bool load_stage(int stage_no);
+void music(int songno);
+int music_cursong();
+
+#define SAVESTATE_MAGICK		'SST1'
+
+SaveState::SaveState()
+{
+	fStage = -1;
+	fValid = false;
+}
+
+// save states can only be taken in the middle of normal gameplay; not while
+// paused, in the inventory or map, or during a stage transition.
+bool SaveState::CanCapture()
+{
+	return (game.mode == GM_NORMAL && !game.paused && \
+			game.switchstage.mapno < 0 && player);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+bool SaveState::Capture()
+{
+uint32_t magick = SAVESTATE_MAGICK;
+uint32_t seed = getrandseed();
+uint32_t fxseed = getfxrandseed();
+int song = music_cursong();
+
+	if (!CanCapture())
+		return 1;
+
+	// states are retaken over and over by the rewind ring;
+	// allocate what was needed last time in one go.
+	int lastsize = fData.Length();
+	fData.Clear();
+	fData.EnsureAlloc(lastsize);
+	fStage = game.curmap;
+
+	SS_PUT(&fData, magick);
+	SS_PUT(&fData, game);
+	game.stageboss.SaveState(&fData);
+
+	Objects::SaveState(&fData);
+	FloatText::SaveState(&fData);
+	Carets::SaveState(&fData);
+
+	SS_PUT(&fData, player);
+	SS_PUT(&fData, nOnscreenObjects);
+	SS_PUTDATA(&fData, onscreen_objects, nOnscreenObjects * sizeof(Object *));
+
+	map_save_state(&fData);
+	tsc_save_state(&fData);
+
+	SS_PUT(&fData, textbox);
+	world->fFade.SaveState(&fData);
+	world->fFlashScreen.SaveState(&fData);
+	world->fStarflash.SaveState(&fData);
+
+	SS_PUT(&fData, seed);
+	SS_PUT(&fData, fxseed);
+	SS_PUT(&fData, inputs);
+	SS_PUT(&fData, lastinputs);
+	SS_PUT(&fData, song);
+
+	fValid = true;
+	return 0;
+}
+
+bool SaveState::Restore()
+{
+const uint8_t *in = fData.Data();
+uint32_t magick, seed, fxseed;
+int song;
+
+	if (!fValid)
+		return 1;
+
+	SS_GET(&in, magick);
+	ASSERT(magick == SAVESTATE_MAGICK);
+
+	if (game.paused)
+		game.pause(0);
+
+	if (game.mode != GM_NORMAL)
+		game.setmode(GM_NORMAL);
+
+	if (game.curmap != fStage)
+	{
+		stat("SaveState::Restore: loading stage %d", fStage);
+		if (load_stage(fStage))
+			return 1;
+	}
+
+	// the game struct is taken whole except for the things
+	// which belong to the session rather than the simulation.
+	Game live;
+	memcpy(&live, &game, sizeof(Game));
+	SS_GET(&in, game);
+
+	game.running = live.running;
+	game.mode = live.mode;
+	game.paused = live.paused;
+	game.fullscreen = live.fullscreen;
+	game.ffwdtime = live.ffwdtime;
+	memcpy(&game.debug, &live.debug, sizeof(game.debug));
+	memcpy(&game.stageboss, &live.stageboss, sizeof(game.stageboss));
+	game.stageboss.LoadState(&in);
+
+	Objects::LoadState(&in);
+	FloatText::LoadState(&in);
+	Carets::LoadState(&in);
+
+	SS_GET(&in, player);
+	SS_GET(&in, nOnscreenObjects);
+	SS_GETDATA(&in, onscreen_objects, nOnscreenObjects * sizeof(Object *));
+
+	if (map_load_state(&in))
+		return 1;
+
+	tsc_load_state(&in);
+
+	SS_GET(&in, textbox);
+	world->fFade.LoadState(&in);
+	world->fFlashScreen.LoadState(&in);
+	world->fStarflash.LoadState(&in);
+
+	SS_GET(&in, seed);
+	SS_GET(&in, fxseed);
+	SS_GET(&in, inputs);
+	SS_GET(&in, lastinputs);
+	SS_GET(&in, song);
+
+	seedrand(seed);
+	seedfxrand(fxseed);
+	music(song);
+
+	HitGrid::Invalidate();
+	return 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+#define ring			(world->fRewind.states)
+#define ring_head		(world->fRewind.head)
+#define ring_count		(world->fRewind.count)
+#define ring_timer		(world->fRewind.timer)
+
+static int ring_interval = REWIND_INTERVAL;
+
+// called at the start of every unpaused tick
+void Rewind::Tick()
+{
+	// playback has keyframes and Replay::Seek for this
+	if (ring_interval <= 0 || Replay::IsPlaying())
+		return;
+
+	if (++ring_timer < ring_interval)
+		return;
+
+	if (ring[ring_head].Capture())
+		return;
+
+	ring_timer = 0;
+	ring_head = (ring_head + 1) % REWIND_SLOTS;
+	if (ring_count < REWIND_SLOTS)
+		ring_count++;
+}
+
+// goes back to the state taken the given number of captures ago (1 = the
+// most recent one). the states after it are dropped, so stepping back
+// again carries on further into the past.
+bool Rewind::StepBack(int steps)
+{
+	if (steps < 1) steps = 1;
+	if (steps > ring_count)
+	{
+		staterr("Rewind::StepBack: only %d states held", ring_count);
+		return 1;
+	}
+
+	int slot = (ring_head - steps + REWIND_SLOTS) % REWIND_SLOTS;
+
+	// whatever got recorded after this point no longer leads here
+	if (Replay::IsRecording())
+	{
+		stat("Rewind::StepBack: ending replay recording");
+		Replay::end_record();
+	}
+
+	if (ring[slot].Restore())
+		return 1;
+
+	// the restored state is kept, so it can be returned to again
+	ring_head = (slot + 1) % REWIND_SLOTS;
+	ring_count -= (steps - 1);
+	ring_timer = 0;
+	return 0;
+}
+
+void Rewind::Clear()
+{
+	ring_head = ring_count = ring_timer = 0;
+}
+
+int Rewind::CountStates(int *bytes_out)
+{
+	if (bytes_out)
+	{
+		*bytes_out = 0;
+		for(int i=0;i<REWIND_SLOTS;i++)
+			*bytes_out += ring[i].Size();
+	}
+
+	return ring_count;
+}
+
+// 0 turns the ring off
+void Rewind::SetInterval(int frames)
+{
+	ring_interval = (frames > 0) ? frames : 0;
+	Clear();
+}
+
+int Rewind::GetInterval()
+{
+	return ring_interval;
+}
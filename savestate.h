@@ -0,0 +1,72 @@
+#ifndef _SAVESTATE_H
+#define _SAVESTATE_H
+
+#include "common/DBuffer.h"
+
+// a copy of the complete simulation state between two ticks, which the game
+// can later be put back to: objects, player, floattext, carets, stage boss,
+// map tiles, game flags, script and textbox state, screen effects and the
+// RNG. it is kept entirely in memory.
+//
+// objects and floattext are copied back in at the same addresses in their
+// slab pools, pointers and all, so pointers between them stay good without
+// any fixing up. the flip side is that a save state is only meaningful to the
+// process which took it, and can't be written out to disk. static variables
+// inside individual AI routines are not captured.
+//
+// only trivially copyable data goes through SS_PUT and SS_GET. classes with
+// a vtable save their members one by one, or keep them in a plain struct
+// which is copied as a block (see ObjectState).
+class SaveState
+{
+public:
+	SaveState();
+
+	bool Capture();
+	bool Restore();
+
+	bool IsValid()		{ return fValid; }
+	int Stage()			{ return fStage; }
+	int Size()			{ return fData.Length(); }
+
+	static bool CanCapture();
+
+private:
+	DBuffer fData;
+	int fStage;
+	bool fValid;
+};
+
+// a ring of save states taken every few frames of normal play,
+// for stepping the game backwards.
+#define REWIND_SLOTS			64
+#define REWIND_INTERVAL			10
+
+// the ring itself, which belongs to the World (see world.h)
+struct RewindRing
+{
+	SaveState states[REWIND_SLOTS];
+	int head;		// slot the next state goes in
+	int count;		// number of states held
+	int timer;
+};
+
+namespace Rewind
+{
+	void Tick();
+	bool StepBack(int steps);
+	void Clear();
+	
+	int CountStates(int *bytes_out = NULL);
+	void SetInterval(int frames);
+	int GetInterval();
+};
+
+// for modules writing their part of a save state and reading it back out.
+// IN is a pointer to the read position, which is advanced past the data.
+#define SS_PUT(OUT, VAR)			(OUT)->AppendData((const uint8_t *)&(VAR), sizeof(VAR))
+#define SS_PUTDATA(OUT, PTR, LEN)	(OUT)->AppendData((const uint8_t *)(PTR), (LEN))
+#define SS_GET(IN, VAR)				{ memcpy(&(VAR), *(IN), sizeof(VAR)); *(IN) += sizeof(VAR); }
+#define SS_GETDATA(IN, PTR, LEN)	{ memcpy((PTR), *(IN), (LEN)); *(IN) += (LEN); }
+
+#endif
@@ -0,0 +1,287 @@
+
+#include <math.h>
+#include "nx.h"
+#include "scheduler.h"
+
+static SchedPolicy policy = SCHED_CATCHUP;
+static int spin_us = SCHED_SPIN_US;
+static const char *outfile = NULL;
+
+static uint64_t freq = 0;
+static uint64_t spin_counts;
+static double us_per_count;
+
+static uint64_t base;			// time of tick 0 on the grid
+static uint64_t tickno;			// the next tick to run
+static uint64_t laststart;		// when the last tick started, 0 after a Reset
+
+static SchedHistogram jitter = { "jitter", 50 };
+static SchedHistogram interval = { "interval", 250 };
+static int dropped = 0;
+
+static void init_clock();
+static inline uint64_t tick_deadline(uint64_t n);
+
+/*
+void c------------------------------() {}
+*/
+
+void SchedHistogram::Add(double us)
+{
+	int b = (int)(us / bucket_us);
+	if (b < 0) b = 0;
+	if (b >= SCHED_BUCKETS) b = (SCHED_BUCKETS - 1);
+
+	buckets[b]++;
+	count++;
+	sum += us;
+	sumsq += (us * us);
+	if (us > max) max = us;
+}
+
+void SchedHistogram::Clear()
+{
+	memset(buckets, 0, sizeof(buckets));
+	count = 0;
+	sum = sumsq = max = 0;
+}
+
+double SchedHistogram::Mean() const
+{
+	return count ? (sum / count) : 0;
+}
+
+double SchedHistogram::StdDev() const
+{
+	if (count < 2) return 0;
+
+	double mean = Mean();
+	double var = (sumsq / count) - (mean * mean);
+	return (var > 0) ? sqrt(var) : 0;
+}
+
+// upper edge of the bucket the given percentile falls in
+int SchedHistogram::Percentile(int pct) const
+{
+	int want = (int)(((int64_t)count * pct + 99) / 100);
+	int seen = 0;
+
+	for(int i=0;i<SCHED_BUCKETS;i++)
+	{
+		seen += buckets[i];
+		if (seen >= want && seen > 0)
+			return (i + 1) * bucket_us;
+	}
+
+	return 0;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+static void init_clock()
+{
+	freq = SDL_GetPerformanceFrequency();
+	us_per_count = (1000000.0 / (double)freq);
+	spin_counts = (freq * spin_us) / 1000000;
+}
+
+// worked out from the start of the grid each time, instead of adding up
+// a period which isn't a whole number of counts.
+static inline uint64_t tick_deadline(uint64_t n)
+{
+	return base + (n * freq) / GAME_FPS;
+}
+
+// starts a new grid with the next tick due right away. used when starting
+// up, after stage loads and whenever the loop has been running unpaced.
+void Scheduler::Reset()
+{
+	if (!freq)
+		init_clock();
+
+	base = SDL_GetPerformanceCounter();
+	tickno = 0;
+	laststart = 0;
+}
+
+// returns once it's time for the next tick
+void Scheduler::WaitForTick()
+{
+uint64_t now, deadline;
+int64_t remain;
+
+	if (!freq)
+		Reset();
+
+	now = SDL_GetPerformanceCounter();
+	deadline = tick_deadline(tickno);
+
+	// more than a whole tick behind. anything past what the policy allows to
+	// be caught up on is skipped over, staying on the same grid.
+	if (now > deadline)
+	{
+		uint64_t missed = ((now - deadline) * GAME_FPS) / freq;
+		uint64_t allowed = (policy == SCHED_CATCHUP) ? SCHED_MAX_CATCHUP : 0;
+
+		if (missed > allowed)
+		{
+			tickno += (missed - allowed);
+			dropped += (int)(missed - allowed);
+			deadline = tick_deadline(tickno);
+		}
+	}
+
+	for(;;)
+	{
+		remain = (int64_t)(deadline - now);
+		if (remain <= 0)
+			break;
+
+		if (remain > (int64_t)spin_counts)
+		{
+			int ms = (int)(((uint64_t)remain - spin_counts) * 1000 / freq);
+			if (ms > 0)
+				SDL_Delay(ms);
+		}
+
+		now = SDL_GetPerformanceCounter();
+	}
+
+	jitter.Add((double)(now - deadline) * us_per_count);
+	if (laststart)
+		interval.Add((double)(now - laststart) * us_per_count);
+
+	laststart = now;
+	tickno++;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void Scheduler::SetPolicy(SchedPolicy newpolicy)
+{
+	policy = newpolicy;
+}
+
+SchedPolicy Scheduler::GetPolicy()
+{
+	return policy;
+}
+
+const char *Scheduler::PolicyName(SchedPolicy p)
+{
+	return (p == SCHED_DROP) ? "drop" : "catchup";
+}
+
+bool Scheduler::ParsePolicy(const char *name, SchedPolicy *policy_out)
+{
+	if (!strcasecmp(name, "catchup"))
+		*policy_out = SCHED_CATCHUP;
+	else if (!strcasecmp(name, "drop"))
+		*policy_out = SCHED_DROP;
+	else
+		return 1;
+
+	return 0;
+}
+
+void Scheduler::SetSpin(int us)
+{
+	spin_us = (us > 0) ? us : 0;
+	if (freq)
+		spin_counts = (freq * spin_us) / 1000000;
+}
+
+int Scheduler::GetSpin()
+{
+	return spin_us;
+}
+
+/*
+void c------------------------------() {}
+*/
+
+const SchedHistogram *Scheduler::Jitter()
+{
+	return &jitter;
+}
+
+const SchedHistogram *Scheduler::Interval()
+{
+	return &interval;
+}
+
+int Scheduler::CountDropped()
+{
+	return dropped;
+}
+
+void Scheduler::ResetStats()
+{
+	jitter.Clear();
+	interval.Clear();
+	dropped = 0;
+	laststart = 0;
+}
+
+// where Finish writes the histograms
+void Scheduler::SetOutput(const char *fname)
+{
+	outfile = fname;
+}
+
+// logs a summary, and writes the histograms out in long
+// format if an output file was given.
+bool Scheduler::Finish()
+{
+const SchedHistogram *hists[] = { &jitter, &interval };
+int h, i;
+
+	if (!jitter.count)
+		return 0;
+
+	for(h=0;h<2;h++)
+	{
+		const SchedHistogram *hist = hists[h];
+		stat("scheduler: %s: mean %.0f us, stddev %.0f us, p50 %d us, p99 %d us, max %.0f us", \
+			hist->name, hist->Mean(), hist->StdDev(), hist->Percentile(50), \
+			hist->Percentile(99), hist->max);
+	}
+
+	stat("scheduler: %d ticks, %d dropped (%s)", jitter.count, dropped, PolicyName(policy));
+
+	if (!outfile)
+		return 0;
+
+	FILE *fp = fileopenRW(outfile, "wb");
+	if (!fp)
+	{
+		staterr("Scheduler::Finish: failed to open '%s' for writing", outfile);
+		return 1;
+	}
+
+	fprintf(fp, "histogram,lo_us,hi_us,count\n");
+	for(h=0;h<2;h++)
+	{
+		const SchedHistogram *hist = hists[h];
+
+		for(i=0;i<SCHED_BUCKETS;i++)
+		{
+			if (!hist->buckets[i])
+				continue;
+
+			if (i == SCHED_BUCKETS - 1)
+				fprintf(fp, "%s,%d,,%d\n", hist->name, i * hist->bucket_us, hist->buckets[i]);
+			else
+				fprintf(fp, "%s,%d,%d,%d\n", hist->name, i * hist->bucket_us, \
+						(i + 1) * hist->bucket_us, hist->buckets[i]);
+		}
+	}
+
+	fclose(fp);
+	stat("scheduler: wrote histograms to '%s'", outfile);
+	return 0;
+}
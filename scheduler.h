@@ -0,0 +1,66 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <stdint.h>
+
+// what to do when ticks fall behind their deadlines
+enum SchedPolicy
+{
+	SCHED_CATCHUP,		// run the missed ticks back-to-back, up to a limit
+	SCHED_DROP			// skip them, and carry on from the next deadline
+};
+
+#define SCHED_MAX_CATCHUP		5		// ticks run back-to-back before the rest are dropped
+#define SCHED_SPIN_US			2000	// how close to a deadline to stop sleeping and spin
+#define SCHED_BUCKETS			128
+
+// fixed-size histogram of times in microseconds. the last bucket
+// takes everything which doesn't fit in the others.
+struct SchedHistogram
+{
+	const char *name;
+	int bucket_us;
+
+	int buckets[SCHED_BUCKETS];
+	int count;
+	double sum, sumsq, max;
+
+	void Add(double us);
+	void Clear();
+
+	double Mean() const;
+	double StdDev() const;
+	int Percentile(int pct) const;
+};
+
+// paces the game loop at GAME_FPS. deadlines are laid out on a fixed grid
+// from the time of the last Reset, on the high-resolution counter, so
+// rounding never adds up into drift. the thread sleeps until shortly before
+// each deadline, which is as far as the OS can be trusted to wake it on time,
+// and spins for the rest.
+//
+// keeps histograms of how late each tick started relative to its deadline
+// and of the time between the starts of consecutive ticks.
+namespace Scheduler
+{
+	void Reset();
+	void WaitForTick();
+
+	void SetPolicy(SchedPolicy policy);
+	SchedPolicy GetPolicy();
+	const char *PolicyName(SchedPolicy policy);
+	bool ParsePolicy(const char *name, SchedPolicy *policy_out);
+
+	void SetSpin(int us);
+	int GetSpin();
+
+	const SchedHistogram *Jitter();
+	const SchedHistogram *Interval();
+	int CountDropped();
+	void ResetStats();
+
+	void SetOutput(const char *fname);
+	bool Finish();
+};
+
+#endif
@@ -3,10 +3,6 @@
 #include "screeneffect.h"
 #include "screeneffect.fdh"
 
-SE_FlashScreen flashscreen;
-SE_Starflash starflash;
-SE_Fade fade;
-
 /*
 void c------------------------------() {}
 */
@@ -22,7 +18,7 @@ void SE_FlashScreen::Start(void)
 	enabled = true;
 }
 
-void SE_FlashScreen::Draw(void)
+void SE_FlashScreen::Run(void)
 {
 	if (++timer >= 2)
 	{
@@ -35,7 +31,10 @@ void SE_FlashScreen::Draw(void)
 				enabled = false;
 		}
 	}
-	
+}
+
+void SE_FlashScreen::Draw(void)
+{
 	if (flashstate)
 		ClearScreen(0xff, 0xff, 0xff);
 }
@@ -57,12 +56,19 @@ void SE_Starflash::Start(int x, int y)
 	size = speed = 0;
 }
 
-void SE_Starflash::Draw(void)
+void SE_Starflash::Run(void)
 {
 SE_Starflash * const &star = this;
-int scr_x1, scr_y1, scr_x2, scr_y2;
-int rel_x, rel_y;
 
+	// once it got big enough last tick, switch to making it smaller.
+	// (checked here rather than at the end, so that the tick it gets
+	// there on still shows both bars.)
+	if (star->state == 0 && star->size > (1280<<CSF))
+	{
+		star->size = (Graphics::SCREEN_HEIGHT << CSF);
+		star->state = 1;
+	}
+	
 	if (state == 0)
 	{	// flash getting bigger
 		star->speed += (1 << CSF);
@@ -73,12 +79,16 @@ int rel_x, rel_y;
 		star->size -= (star->size >> 3);
 		
 		if (star->size < 255)
-		{
 			enabled = false;
-			return;
-		}
 	}
-	
+}
+
+void SE_Starflash::Draw(void)
+{
+SE_Starflash * const &star = this;
+int scr_x1, scr_y1, scr_x2, scr_y2;
+int rel_x, rel_y;
+
 	// draw the flash
 	rel_x = (star->centerx - map.displayed_xscroll);
 	rel_y = (star->centery - map.displayed_yscroll);
@@ -91,16 +101,9 @@ int rel_x, rel_y;
 	if (star->state == 0)
 	{
 		// draw a vertical bar
-		scr_x1 = (rel_x - starflash.size) >> CSF;
-		scr_x2 = (rel_x + starflash.size) >> CSF;
+		scr_x1 = (rel_x - star->size) >> CSF;
+		scr_x2 = (rel_x + star->size) >> CSF;
 		FillRect(scr_x1, 0, scr_x2, Graphics::SCREEN_HEIGHT, 255, 255, 255);
-		
-		// once it's big enough, switch to making it smaller
-		if (star->size > (1280<<CSF))
-		{
-			star->size = (Graphics::SCREEN_HEIGHT << CSF);
-			star->state = 1;
-		}
 	}
 }
 
@@ -116,7 +119,7 @@ void c------------------------------() {}
 
 SE_Fade::SE_Fade()
 {
-	state = FS_NO_FADE;
+	state = drawstate = FS_NO_FADE;
 	enabled = false;
 }
 
@@ -149,6 +152,32 @@ void SE_Fade::Start(int fadedir, int sweepdir, int spr)
 }
 
 
+// the fade is part of the simulation, as scripts wait on it
+void SE_Fade::Run(void)
+{
+	drawstate = state;
+	drawframe = fade.curframe;
+	
+	if (state != FS_FADING)
+		return;
+	
+	if (fade.fadedir == FADE_OUT)
+	{
+		fade.curframe++;
+		if (fade.curframe > FADE_LAST_FRAME)
+			state = FS_FADED_OUT;
+	}
+	else
+	{	// fading in--terminate fade when done
+		fade.curframe--;
+		if (fade.curframe < -20)
+		{
+			state = FS_NO_FADE;
+			enabled = false;
+		}
+	}
+}
+
 void SE_Fade::Draw(void)
 {
 int x, y;
@@ -175,11 +204,11 @@ int x, y;
 		}		\
 	}
 	
-	if (state == FS_NO_FADE)
+	if (drawstate == FS_NO_FADE)
 	{
 		return;
 	}
-	else if (state == FS_FADED_OUT)
+	else if (drawstate == FS_FADED_OUT)
 	{
 		ClearScreen(DK_BLUE);
 		return;
@@ -188,7 +217,7 @@ int x, y;
     Graphics::DrawBatchBegin(0);
     Sprites::draw_in_batch(true);
 	
-	int frame = fade.curframe;
+	int frame = drawframe;
 	switch(fade.sweepdir)
 	{
 		case FADE_RIGHT:for(x=0;x<Graphics::SCREEN_WIDTH;x+=16)	   	{ DRAW_VCOLUMN; frame++; }	break;
@@ -198,7 +227,7 @@ int x, y;
 		
 		case FADE_CENTER:
 		{
-			int startframe = fade.curframe;
+			int startframe = drawframe;
 			int centerx = (Graphics::SCREEN_WIDTH/2)-8;
 			int centery = (Graphics::SCREEN_HEIGHT/2)-8;
 			
@@ -229,22 +258,6 @@ int x, y;
     
     Graphics::DrawBatchEnd();
     Sprites::draw_in_batch(false);
-	
-	if (fade.fadedir == FADE_OUT)
-	{
-		fade.curframe++;
-		if (fade.curframe > FADE_LAST_FRAME)
-			state = FS_FADED_OUT;
-	}
-	else
-	{	// fading in--terminate fade when done
-		fade.curframe--;
-		if (fade.curframe < -20)
-		{
-			state = FS_NO_FADE;
-			enabled = false;
-		}
-	}
 }
 
 void SE_Fade::set_full(int dir)
@@ -274,17 +287,93 @@ int SE_Fade::getstate(void)
 void c------------------------------() {}
 */
 
+// each effect saves its members one by one; see savestate.h
+void ScreenEffect::SaveState(DBuffer *out)
+{
+	SS_PUT(out, enabled);
+	SS_PUT(out, state);
+	SS_PUT(out, timer);
+}
+
+void ScreenEffect::LoadState(const uint8_t **in)
+{
+	SS_GET(in, enabled);
+	SS_GET(in, state);
+	SS_GET(in, timer);
+}
+
+void SE_FlashScreen::SaveState(DBuffer *out)
+{
+	ScreenEffect::SaveState(out);
+	SS_PUT(out, flashes_left);
+	SS_PUT(out, flashstate);
+}
+
+void SE_FlashScreen::LoadState(const uint8_t **in)
+{
+	ScreenEffect::LoadState(in);
+	SS_GET(in, flashes_left);
+	SS_GET(in, flashstate);
+}
+
+void SE_Starflash::SaveState(DBuffer *out)
+{
+	ScreenEffect::SaveState(out);
+	SS_PUT(out, centerx);
+	SS_PUT(out, centery);
+	SS_PUT(out, size);
+	SS_PUT(out, speed);
+}
+
+void SE_Starflash::LoadState(const uint8_t **in)
+{
+	ScreenEffect::LoadState(in);
+	SS_GET(in, centerx);
+	SS_GET(in, centery);
+	SS_GET(in, size);
+	SS_GET(in, speed);
+}
+
+void SE_Fade::SaveState(DBuffer *out)
+{
+	ScreenEffect::SaveState(out);
+	SS_PUT(out, fade);
+	SS_PUT(out, drawstate);
+	SS_PUT(out, drawframe);
+}
+
+void SE_Fade::LoadState(const uint8_t **in)
+{
+	ScreenEffect::LoadState(in);
+	SS_GET(in, fade);
+	SS_GET(in, drawstate);
+	SS_GET(in, drawframe);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+void ScreenEffects::Run(void)
+{
+	if (world->fStarflash.enabled)
+		world->fStarflash.Run();
+	
+	if (world->fFlashScreen.enabled)
+		world->fFlashScreen.Run();
+}
+
 void ScreenEffects::Draw(void)
 {
-	if (starflash.enabled)
-		starflash.Draw();
+	if (world->fStarflash.enabled)
+		world->fStarflash.Draw();
 	
-	if (flashscreen.enabled)
-		flashscreen.Draw();
+	if (world->fFlashScreen.enabled)
+		world->fFlashScreen.Draw();
 }
 
 void ScreenEffects::Stop()
 {
-	starflash.enabled = false;
-	flashscreen.enabled = false;
+	world->fStarflash.enabled = false;
+	world->fFlashScreen.enabled = false;
 }
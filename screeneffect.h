@@ -4,13 +4,19 @@
 
 
 // screeneffects are a simple draw overlay used w/ things such as flashes and such.
+// Run moves them along once per tick, and Draw only draws them.
 class ScreenEffect
 {
 public:
 	ScreenEffect() { enabled = false; }
 	virtual ~ScreenEffect() { }
+	virtual void Run() = 0;
 	virtual void Draw() = 0;
 	
+	// for save states
+	virtual void SaveState(DBuffer *out);
+	virtual void LoadState(const uint8_t **in);
+	
 	bool enabled;
 	
 protected:
@@ -24,8 +30,12 @@ protected:
 struct SE_FlashScreen : public ScreenEffect
 {
 	void Start();
+	void Run();
 	void Draw();
 	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
+	
 	int flashes_left;
 	bool flashstate;
 };
@@ -36,8 +46,12 @@ struct SE_FlashScreen : public ScreenEffect
 struct SE_Starflash : public ScreenEffect
 {
 	void Start(int x, int y);
+	void Run();
 	void Draw();
 	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
+	
 	int centerx, centery;
 	int size, speed;
 };
@@ -49,9 +63,13 @@ struct SE_Fade : public ScreenEffect
 	SE_Fade();
 	
 	void Start(int fadedir, int dir, int spr=SPR_FADE_DIAMOND);
+	void Run(void);
 	void Draw(void);
 	void set_full(int dir);
 	int getstate(void);
+	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
 
 	struct
 	{
@@ -60,6 +78,10 @@ struct SE_Fade : public ScreenEffect
 		int curframe;
 		int sprite;
 	} fade;
+	
+	// what Draw shows; the state as of the start of the last Run
+	int drawstate;
+	int drawframe;
 };
 
 #define FADE_IN			0
@@ -79,14 +101,10 @@ struct SE_Fade : public ScreenEffect
 
 namespace ScreenEffects
 {
+	void Run(void);
 	void Draw(void);
 	void Stop();
 };
 
-
-extern SE_FlashScreen flashscreen;
-extern SE_Starflash starflash;
-extern SE_Fade fade;
-
 #endif
 
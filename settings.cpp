@@ -13,8 +13,7 @@ const char *setfilename = "settings.dat";
 const uint16_t SETTINGS_VERSION = 0x1608;		// serves as both a version and magic
 
 Settings normal_settings;
-Settings replay_settings;
-Settings *settings = &normal_settings;
+NX_THREAD Settings *settings = &normal_settings;
 
 
 bool settings_load(Settings *setfile)
@@ -68,9 +68,8 @@ struct Settings
 bool settings_load(Settings *settings=NULL);
 bool settings_save(Settings *settings=NULL);
 
-extern Settings *settings;
+extern NX_THREAD Settings *settings;
 extern Settings normal_settings;
-extern Settings replay_settings;
 
 
 #endif
@@ -73,10 +73,12 @@ uint8_t t;
 	mx = (x / TILE_W);
 	my = (y / TILE_H);
 	
-	if (mx < 0 || my < 0 || mx >= map.xsize || my >= map.ysize)
+	// most tiles aren't slopes, so the slope bit-plane turns most calls away
+	// here (including anything off the map).
+	if (!map_attrplane(AP_SLOPE, mx, my))
 		return 0;
 	
-	t = map.tiles[mx][my];
+	t = map_tilerow(my)[mx];
 	
 	if (tileattr[t] & TA_SLOPE)
 	{
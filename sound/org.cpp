@@ -20,6 +20,7 @@
 
 #include "../platform/platform.h"
 #include "../common/endian.h"
+#include "../profiler.h"
 
 //#define QUIET
 #define DRUM_PXT
@@ -661,6 +662,8 @@ bool org_start(int startbeat)
 // pause/stop playback of the current song
 void org_stop(void)
 {
+	if (!org_inited) return;
+	
 	bool was_playing = false;
 	{
 #ifdef CONFIG_ORG_MUSIC_THREADED
@@ -679,6 +682,8 @@ void org_stop(void)
 
 bool org_is_playing(void)
 {
+	if (!org_inited) return false;
+	
 #ifdef CONFIG_ORG_MUSIC_THREADED
 	LockGuard guard(gen_music_lock);
 #endif
@@ -702,6 +707,7 @@ bool org_is_playing(void)
 void org_fade(void)
 {
 	stat("org_fade");
+	if (!org_inited) return;
 
 #ifdef CONFIG_ORG_MUSIC_THREADED
 	LockGuard guard(gen_music_lock);
@@ -712,6 +718,8 @@ void org_fade(void)
 
 void org_set_volume(int newvolume)
 {
+	if (!org_inited) return;
+	
 	bool volume_changed = false;
 	{
 #ifdef CONFIG_ORG_MUSIC_THREADED
@@ -1061,6 +1069,8 @@ int i;
 
 void org_run(void)
 {
+	if (!org_inited) return;
+	
 #ifdef CONFIG_ORG_MUSIC_THREADED
 
 	{
@@ -1094,6 +1104,8 @@ int m;
 int beats_left;
 int out_position;
 
+	PROFILE_SCOPE("org generate_music");
+	
 	//stat("generate_music: cb=%d buffer_beats=%d", current_buffer, buffer_beats);
 	
 	// save beat # of the first beat in buffer for calculating current beat for TrackFuncs
@@ -1311,6 +1323,7 @@ int gen_music_thread_fn(void*)
 			generate_music();
 
 			++buffers_full;
+			PROFILE_COUNTER("org buffers full", buffers_full);
 			assert(buffers_full <= FINAL_BUFFER_COUNT);
 		}
 
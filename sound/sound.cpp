@@ -14,8 +14,8 @@
 #define MUSIC_OFF		0
 #define MUSIC_ON		1
 #define MUSIC_BOSS_ONLY	2
-static int lastsong = 0;		// this holds the previous song, for <RMU
-static int cursong = 0;
+static NX_THREAD int lastsong = 0;		// this holds the previous song, for <RMU
+static NX_THREAD int cursong = 0;
 
 // there are more than this around 9b; those are drums and are loaded by the org module
 #define NUM_SOUNDS		0x75
@@ -41,6 +41,14 @@ static const char *org_wavetable = "wavetable.dat";
 
 bool sound_init(void)
 {
+	// null backend: no audio device is opened and sound effects are dropped.
+	// music() still tracks the current song so the game state stays the same.
+	if (headless)
+	{
+		stat("sound_init: headless, audio disabled");
+		return 0;
+	}
+	
 	if (SSInit()) return 1;
 	if (pxt_init()) return 1;
 	if (pxt_LoadSoundFX(pxt_dir, sndcache, NUM_SOUNDS)) return 1;
@@ -56,6 +64,8 @@ bool sound_init(void)
 
 void sound_close(void)
 {
+	if (headless) return;
+	
 	pxt_freeSoundFX();
 	SSClose();
 }
@@ -66,7 +76,7 @@ void c------------------------------() {}
 
 void sound(int snd)
 {
-	if (!settings->sound_enabled)
+	if (!settings->sound_enabled || headless)
 		return;
 	
 	pxt_Stop(snd);
@@ -75,7 +85,7 @@ void sound(int snd)
 
 void sound_loop(int snd)
 {
-	if (!settings->sound_enabled)
+	if (!settings->sound_enabled || headless)
 		return;
 	
 	pxt_Play(-1, snd, -1);
@@ -83,11 +93,13 @@ void sound_loop(int snd)
 
 void sound_stop(int snd)
 {
+	if (headless) return;
 	pxt_Stop(snd);
 }
 
 bool sound_is_playing(int snd)
 {
+	if (headless) return false;
 	return pxt_IsPlaying(snd);
 }
 
@@ -184,7 +196,7 @@ static void start_track(int songno)
 {
 char fname[MAXPATHLEN];
 
-	if (songno == 0)
+	if (songno == 0 || headless)
 	{
 		org_stop();
 		return;
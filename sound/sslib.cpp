@@ -10,6 +10,7 @@
 #include "../common/basics.h"
 
 #include "sslib.h"
+#include "../profiler.h"
 #include "sslib.fdh"
 
 SSChannel channel[SS_NUM_CHANNELS];
@@ -330,6 +331,8 @@ int bytestogo;
 int c;
 int i;
 
+	PROFILE_SCOPE("mixaudio");
+	
 #if SDL_VERSION_ATLEAST(1, 3, 0)
 	/* Need to initialize the stream in SDL 1.3+ */
 	memset(stream, spec.silence, len);
@@ -41,29 +41,45 @@ bool StageBossManager::SetType(int newtype)
 	fBossType = newtype;
 	fBoss = NULL;
 	
-	switch(newtype)
+	if (newtype == BOSS_NONE)
+		return 0;
+	
+	fBoss = create_boss(newtype);
+	if (!fBoss)
 	{
-		case BOSS_NONE: break;
-		
-		case BOSS_OMEGA: fBoss = new OmegaBoss; break;
-		case BOSS_BALFROG: fBoss = new BalfrogBoss; break;
-		case BOSS_MONSTER_X: fBoss = new XBoss; break;
-		case BOSS_CORE: fBoss = new CoreBoss; break;
-		case BOSS_IRONH: fBoss = new IronheadBoss; break;
-		case BOSS_SISTERS: fBoss = new SistersBoss; break;
-		case BOSS_UNDEAD_CORE: fBoss = new UDCoreBoss; break;
-		case BOSS_HEAVY_PRESS: fBoss = new HeavyPress; break;
-		case BOSS_BALLOS: fBoss = new BallosBoss; break;
-		
-		default:
-			staterr("StageBossManager::SetType: unhandled boss type %d", newtype);
-			fBossType = BOSS_NONE;
-			return 1;
+		staterr("StageBossManager::SetType: unhandled boss type %d", newtype);
+		fBossType = BOSS_NONE;
+		return 1;
 	}
 	
 	return 0;
 }
 
+// creates a new instance of the given boss type
+static StageBoss *create_boss(int type)
+{
+StageBoss *boss;
+
+	#define BOSS(T, CLASS)	case T: boss = new CLASS; break;
+	switch(type)
+	{
+		BOSS(BOSS_OMEGA, OmegaBoss);
+		BOSS(BOSS_BALFROG, BalfrogBoss);
+		BOSS(BOSS_MONSTER_X, XBoss);
+		BOSS(BOSS_CORE, CoreBoss);
+		BOSS(BOSS_IRONH, IronheadBoss);
+		BOSS(BOSS_SISTERS, SistersBoss);
+		BOSS(BOSS_UNDEAD_CORE, UDCoreBoss);
+		BOSS(BOSS_HEAVY_PRESS, HeavyPress);
+		BOSS(BOSS_BALLOS, BallosBoss);
+		
+		default: return NULL;
+	}
+	#undef BOSS
+	
+	return boss;
+}
+
 int StageBossManager::Type()
 {
 	return fBossType;
@@ -97,6 +113,36 @@ void StageBossManager::RunAftermove()
 void c------------------------------() {}
 */
 
+// on restore a fresh instance of the right class is created, and the boss
+// reads its members back into it. neither OnMapExit nor OnMapEntry is called.
+void StageBossManager::SaveState(DBuffer *out)
+{
+	SS_PUT(out, fBossType);
+	if (fBoss)
+		fBoss->SaveState(out);
+	
+	SS_PUT(out, object);
+}
+
+void StageBossManager::LoadState(const uint8_t **in)
+{
+	delete fBoss;
+	fBoss = NULL;
+	
+	SS_GET(in, fBossType);
+	if (fBossType != BOSS_NONE)
+	{
+		fBoss = create_boss(fBossType);
+		fBoss->LoadState(in);
+	}
+	
+	SS_GET(in, object);
+}
+
+/*
+void c------------------------------() {}
+*/
+
 void StageBossManager::SetState(int newstate)
 {
 	if (fBoss)
@@ -44,6 +44,10 @@ public:
 	virtual void RunAftermove() { }
 	
 	virtual void SetState(int newstate);
+	
+	// for save states; each boss saves its own members, one by one
+	virtual void SaveState(DBuffer *out) { }
+	virtual void LoadState(const uint8_t **in) { }
 };
 
 
@@ -64,6 +68,9 @@ public:
 	
 	void SetState(int newstate);
 	
+	void SaveState(DBuffer *out);
+	void LoadState(const uint8_t **in);
+	
 	// pointer to the "main object" of a stage boss
 	// (the one to show the boss bar for)
 	// this is set by the derived class, and is cleared in OnMapExit
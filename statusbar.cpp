@@ -36,8 +36,8 @@
 
 //int displayed_health = 0;
 //int healthdectimer = 0;
-StatusBar statusbar;
-static PercentBar PHealthBar;
+NX_THREAD StatusBar statusbar;
+static NX_THREAD PercentBar PHealthBar;
 
 // the "slide" effect when changing weapons
 struct stWeaponSlide
@@ -48,7 +48,8 @@ struct stWeaponSlide
 	char timer;
 	int move_dir;
 	int firstWeapon;				// weapon to show as current weapon
-} slide;
+};
+NX_THREAD stWeaponSlide slide;
 #define SLIDE_LV_OFFSET			16
 #define SLIDE_TIMER_START		5
 
@@ -72,9 +73,6 @@ bool maxed_out;
 	//debug("%08x", game.bossbar.object);
 	//debug("%s", game.bossbar.defeated ? "true" : "false");
 	
-	// handle animations etc
-	RunStatusBar();
-	
 	// draw boss bar
 	if (game.bossbar.object && !game.bossbar.defeated)
 	{
@@ -86,16 +84,11 @@ bool maxed_out;
 		draw_sprite(BOSS_X, BOSS_Y+8, SPR_TEXTBOX, 2, 0);
 		draw_sprite(BOSS_X+8, BOSS_Y+4, SPR_BOSSHPICON, 0, 0);
 		
-		// e.g. bosses w/ multiple forms (Ballos)
-		if (game.bossbar.object->hp > game.bossbar.starting_hp)
-			game.bossbar.starting_hp = game.bossbar.object->hp;
-		
-		RunPercentBar(&game.bossbar.bar, game.bossbar.object->hp);
 		DrawPercentBar(&game.bossbar.bar, BOSS_X+40, BOSS_Y+5, game.bossbar.object->hp, game.bossbar.starting_hp, BOSSBAR_W);
 	}
 	
 	if (game.frozen || player->inputs_locked) return;
-	if (fade.getstate() != FS_NO_FADE) return;
+	if (world->fFade.getstate() != FS_NO_FADE) return;
 	
 	if (player->hp)
 	{
@@ -136,18 +129,8 @@ bool maxed_out;
 				DrawPercentage(XPBAR_X+slide.lv_offset, XPBAR_Y, SPR_XPBAR, FRAME_XP_FILL, curxp, maxxp, sprites[SPR_XPBAR].w);
 			
 			// draw the white flashing if we just got more XP
-			// the time-left and flash-state are in separate variables--
-			// otherwise the Spur will not flash XP bar
-			if (statusbar.xpflashcount)
-			{
-				if (++statusbar.xpflashstate & 2)
-				{
-					draw_sprite(XPBAR_X+slide.lv_offset, XPBAR_Y, SPR_XPBAR, FRAME_XP_FLASH, 0);
-				}
-				
-				statusbar.xpflashcount--;
-			}
-			else statusbar.xpflashstate = 0;
+			if (statusbar.xpflashstate & 2)
+				draw_sprite(XPBAR_X+slide.lv_offset, XPBAR_Y, SPR_XPBAR, FRAME_XP_FLASH, 0);
 			
 			// draw "MAX"
 			if (maxed_out)
@@ -232,8 +215,19 @@ void DrawWeaponLevel(int x, int y, int wpn)
 }
 
 
-static void RunStatusBar(void)
+// handles the animations etc. only moves along the parts which are being
+// shown, same as when this was done while drawing.
+void RunStatusBar(void)
 {
+	if (game.bossbar.object && !game.bossbar.defeated)
+	{
+		// e.g. bosses w/ multiple forms (Ballos)
+		if (game.bossbar.object->hp > game.bossbar.starting_hp)
+			game.bossbar.starting_hp = game.bossbar.object->hp;
+		
+		RunPercentBar(&game.bossbar.bar, game.bossbar.object->hp);
+	}
+	
 	// handle slowly decreasing the health when player is hurt
 	// note how it only decrements while it's actually visible--i thought that was a nice touch
 	if (!player->hurt_flash_state)
@@ -242,7 +236,20 @@ static void RunStatusBar(void)
 	}
 	
 	if (game.frozen || player->inputs_locked) return;
-	if (fade.getstate() != FS_NO_FADE) return;
+	if (world->fFade.getstate() != FS_NO_FADE) return;
+	
+	// the white flashing when more XP was just picked up.
+	// the time-left and flash-state are in separate variables--
+	// otherwise the Spur will not flash XP bar
+	if (player->hp && !player->hurt_flash_state)
+	{
+		if (statusbar.xpflashcount)
+		{
+			statusbar.xpflashstate++;
+			statusbar.xpflashcount--;
+		}
+		else statusbar.xpflashstate = 0;
+	}
 	
 	// sliding effect when changing weapons
 	if (slide.lv_offset)
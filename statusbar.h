@@ -14,7 +14,7 @@ struct StatusBar
 	int xpflashstate;
 };
 
-extern StatusBar statusbar;
+extern NX_THREAD StatusBar statusbar;
 void niku_draw(int value, bool force_white=false);
 
 void stat_PrevWeapon(bool quiet=false);
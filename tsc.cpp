@@ -5,6 +5,7 @@
 #include "common/DBuffer.h"
 #include "vararray.h"
 #include "tsc.h"
+#include "profiler.h"
 #include "tsc.fdh"
 #include "vjoy.h"
 
@@ -13,26 +14,11 @@
 // which textbox options are enabled by the "<TUR" script command.
 #define TUR_PARAMS		(TB_LINE_AT_ONCE | TB_VARIABLE_WIDTH_CHARS | TB_CURSOR_NEVER_SHOWN)
 
-static ScriptInstance curscript;
-static int lastammoinc = 0;
+// the running script and the loaded pages belong to the World
+#define curscript		(world->fCurScript)
+#define script_pages	(world->fScriptPages)
 
-struct ScriptPage
-{
-	// a variable-length array of pointers to compiled script code
-	// for each script in the page; their indexes in this array
-	// correspond to their script numbers.
-	VarArray<DBuffer *> scripts;
-	
-	void Clear()
-	{
-		for(int i=0;i<scripts.nitems;i++)
-			delete scripts.get(i);	// it's safe to delete NULL, so no check here
-		
-		scripts.MakeEmpty();
-	}
-};
-
-ScriptPage script_pages[NUM_SCRIPT_PAGES];
+static NX_THREAD int lastammoinc = 0;
 
 /*
 void c------------------------------() {}
@@ -99,10 +85,16 @@ void c------------------------------() {}
 */
 
 bool tsc_init(void)
+{
+	GenLTC();
+	return 0;
+}
+
+// load the scripts every stage can use into the current world; see world_init
+bool tsc_load_common(void)
 {
 char fname[MAXPATHLEN];
 
-	GenLTC();
 	curscript.running = false;
 	for(int i=0;i<NUM_SCRIPT_PAGES;i++)
 	
@@ -298,7 +290,7 @@ static char nextchar(const char **buf, const char *buf_end)
 
 static int ReadNumber(const char **buf, const char *buf_end)
 {
-static char num[5] = { 0 };
+static NX_THREAD char num[5] = { 0 };
 int i = 0;
 	
 	while(i < 4)
@@ -366,6 +358,23 @@ ScriptInstance *GetCurrentScriptInstance()
 	return NULL;
 }
 
+// the running script is saved by number; it's program pointer is looked up
+// again on restore, as the map's scripts may have been reloaded since.
+void tsc_save_state(DBuffer *out)
+{
+	SS_PUT(out, curscript);
+	SS_PUT(out, lastammoinc);
+}
+
+void tsc_load_state(const uint8_t **in)
+{
+	SS_GET(in, curscript);
+	SS_GET(in, lastammoinc);
+	
+	if (curscript.program)
+		curscript.program = FindScriptData(curscript.scriptno, curscript.pageno, NULL);
+}
+
 /*
 void c------------------------------() {}
 */
@@ -504,6 +513,8 @@ char *mnemonic;
 char *str;
 int cmdip;
 
+	PROFILE_SCOPE("ExecScript");
+	
 	#define JUMP_IF(cond) \
 	{	\
 		if (cond)	\
@@ -513,7 +524,7 @@ int cmdip;
 	}
 	
 	// pause script while FAI/FAO still working
-	if (fade.getstate() == FS_FADING) return;
+	if (world->fFade.getstate() == FS_FADING) return;
 	if (game.mode == GM_ISLAND) return;
 	
 	// waiting for an answer from a Yes/No prompt?
@@ -633,9 +644,9 @@ int cmdip;
 		{
 			case OP_END: StopScript(s); return;
 			
-			case OP_FAI: fade.Start(FADE_IN, parm[0], SPR_FADE_DIAMOND); return;
-			case OP_FAO: fade.Start(FADE_OUT, parm[0], SPR_FADE_DIAMOND); return;
-			case OP_FLA: flashscreen.Start(); break;
+			case OP_FAI: world->fFade.Start(FADE_IN, parm[0], SPR_FADE_DIAMOND); return;
+			case OP_FAO: world->fFade.Start(FADE_OUT, parm[0], SPR_FADE_DIAMOND); return;
+			case OP_FLA: world->fFlashScreen.Start(); break;
 			
 			case OP_SOU: sound(parm[0]); break;
 			case OP_CMU: music(parm[0]); break;
@@ -890,13 +901,13 @@ int cmdip;
 			case OP_WAI: s->delaytimer = parm[0]; return;
 			case OP_WAS: s->wait_standing = true; return;	// wait until player has blockd
 			
-			case OP_SMP: map.tiles[parm[0]][parm[1]]--; break;
+			case OP_SMP: map_settile(parm[0], parm[1], map_tile(parm[0], parm[1]) - 1); break;
 			
 			case OP_CMP:	// change map tile at x:y to z and create smoke
 			{
 				int x = parm[0];
 				int y = parm[1];
-				map.tiles[x][y] = parm[2];
+				map_settile(x, y, parm[2]);
 				
 				// get smoke coords
 				x = ((x * TILE_W) + (TILE_W / 2)) << CSF;
@@ -1240,9 +1251,9 @@ void NPCDo(int id2, int p1, int p2, void (*action_function)(Object *o, int p1, i
 	Object *hits[MAX_OBJECTS], *o;
 	int numhits = 0;
 	
-	FOREACH_OBJECT(o)
+	FOREACH_OBJECT_WITH_ID2(o, id2)
 	{
-		if (o->id2 == id2 && o != player)
+		if (o != player)
 		{
 			if (numhits < MAX_OBJECTS)
 				hits[numhits++] = o;
@@ -2,6 +2,9 @@
 #ifndef _TSC_H
 #define _TSC_H
 
+#include "common/DBuffer.h"
+#include "vararray.h"
+
 // TSC running script instance; there is only ever one running at once
 // but I generalized it as if there might be more just for good style.
 struct ScriptInstance
@@ -36,10 +39,29 @@ enum ScriptPages
 	NUM_SCRIPT_PAGES
 };
 
+struct ScriptPage
+{
+	// a variable-length array of pointers to compiled script code
+	// for each script in the page; their indexes in this array
+	// correspond to their script numbers.
+	VarArray<DBuffer *> scripts;
+	
+	void Clear()
+	{
+		for(int i=0;i<scripts.nitems;i++)
+			delete scripts.get(i);	// it's safe to delete NULL, so no check here
+		
+		scripts.MakeEmpty();
+	}
+};
+
 ScriptInstance *StartScript(int scriptno, int pageno=SP_MAP);
 void StopScript(ScriptInstance *s);
 bool JumpScript(int newscriptno, int pageno=-1);
 
+void tsc_save_state(DBuffer *out);
+void tsc_load_state(const uint8_t **in);
+
 
 // globally-accessible scripts in head.tsc
 #define SCRIPT_NULL				0
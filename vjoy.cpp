@@ -874,9 +874,11 @@ namespace ModeAware
             pads[getGamemode()]->draw();
     }
 
+    // headless there are no fingers, and the worlds of Batch's worker
+    // threads mustn't touch the pads; none of these do anything then.
     bool wasTap(RectI rect)
     {
-        if (VjoyMode::ETOUCH == vjoy_mode.getMode())
+        if (headless || VjoyMode::ETOUCH == vjoy_mode.getMode())
             return false;
         
         return gestureObserver.wasTap(RectF::fromRectI(rect));
@@ -884,7 +886,7 @@ namespace ModeAware
     
     bool wasTap()
     {
-        if (VjoyMode::ETOUCH == vjoy_mode.getMode())
+        if (headless || VjoyMode::ETOUCH == vjoy_mode.getMode())
             return false;
         
         return gestureObserver.wasTap();
@@ -892,6 +894,9 @@ namespace ModeAware
     
     void gameModeChanged(int newMode)
     {
+        if (headless)
+            return;
+        
         ppads = pads;
         pads[newMode]->on_enter();
         
@@ -935,6 +940,9 @@ namespace ModeAware
     
     void specScreenChanged(SpecScreens newScreen, bool enter)
     {
+        if (headless)
+            return;
+        
         ignoreAllCurrentFingers();
         
         {
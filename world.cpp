@@ -0,0 +1,70 @@
+
+#include <stdlib.h>
+
+#include "nx.h"
+#include "world.fdh"
+
+// the world of the main thread, and the one every other thread starts out in
+static World mainworld;
+
+NX_THREAD World *world = &mainworld;
+NX_THREAD RandState *randstate = &mainworld.fRand;
+
+World::World()
+	: fObjectPool("Object", sizeof(Object), 256),
+	  fPlayerPool("Player", sizeof(Player), 1),
+	  fFloatTextPool("FloatText", sizeof(FloatText), 256)
+{
+	fNextSerial = 1;
+}
+
+// a World is big, and nearly all of it has to start out zeroed
+void *World::operator new(size_t size)
+{
+	void *mem = calloc(1, size);
+	ASSERT(mem);
+	
+	return mem;
+}
+
+void World::operator delete(void *ptr)
+{
+	free(ptr);
+}
+
+/*
+void c------------------------------() {}
+*/
+
+// make w the current world of the calling thread
+void world_enter(World *w)
+{
+	world = w;
+	randstate = &w->fRand;
+}
+
+// readies the current world to be given its first stage. everything shared
+// between worlds has to be loaded first (see Game::init).
+bool world_init(void)
+{
+	if (tsc_load_common()) return 1;
+	if (textbox.Init()) return 1;
+	if (Carets::init()) return 1;
+	
+	// create the player object--note that the player is NOT destroyed on map change
+	if (game.createplayer()) return 1;
+	
+	return 0;
+}
+
+// frees everything the current world holds. the World itself
+// is left for whoever created it to delete.
+void world_close(void)
+{
+	Replay::close();
+	game.close();
+	Carets::close();
+	
+	tsc_close();
+	textbox.Deinit();
+}
@@ -0,0 +1,137 @@
+
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include "common/SlabPool.h"
+#include "hitgrid.h"
+
+// one complete simulation: everything the tick functions change while a game
+// is played. every thread has a current world, and the names below stand for
+// its members, so the code written against the old globals works on
+// whichever world the thread has entered. the main thread starts out in the
+// main world; see Batch for running several at once, one per thread.
+//
+// data which is loaded once and only read afterwards (stages, sprites,
+// objprop, tilekey) is shared by all worlds. so are the console, sound and
+// graphics, which are only used by the main thread. state kept privately by a
+// module (AI statics, inventory, the credits...) is NX_THREAD instead, which
+// comes to the same thing as there is only ever one world per thread.
+//
+// worlds must be created and destroyed on the main thread, as the pools
+// register themselves in a list which isn't locked.
+struct World
+{
+	World();
+	
+	static void *operator new(size_t size);
+	static void operator delete(void *ptr);
+	
+	RandState fRand;
+	
+	// objects
+	Object *fFirstObject, *fLastObject;
+	Object *fLowestObject, *fHighestObject;
+	Object *fFirstOfType[OBJ_LAST], *fLastOfType[OBJ_LAST];
+	Object *fFirstWithID2[65536], *fLastWithID2[65536];
+	uint32_t fNextSerial;
+	SlabPool fObjectPool, fPlayerPool;
+	
+	Player *fPlayer;
+	bool fPInputs[INPUT_COUNT];
+	bool fLastPInputs[INPUT_COUNT];
+	
+	FloatText *fFirstFloatText, *fLastFloatText;
+	SlabPool fFloatTextPool;
+	
+	Caret *fFirstCaret, *fLastCaret;
+	
+	// stage
+	stMap fMap;
+	Object *fID2Lookup[65536];
+	uint8_t fTileCode[MAX_TILES];
+	uint32_t fTileAttr[MAX_TILES];
+	
+	Game fGame;
+	TextBox fTextBox;
+	Object *fOnscreenObjects[MAX_OBJECTS];
+	int fNOnscreenObjects;
+	
+	// these have no short names, as SE_Fade has a member called fade
+	SE_FlashScreen fFlashScreen;
+	SE_Starflash fStarflash;
+	SE_Fade fFade;
+	
+	ScriptInstance fCurScript;
+	ScriptPage fScriptPages[NUM_SCRIPT_PAGES];
+	
+	HitGridState fHitGrid;
+	ReplayState fReplay;
+	RewindRing fRewind;
+};
+
+extern NX_THREAD World *world;
+
+void world_enter(World *w);
+bool world_init(void);
+void world_close(void);
+
+#define firstobject			(world->fFirstObject)
+#define lastobject			(world->fLastObject)
+#define lowestobject		(world->fLowestObject)
+#define highestobject		(world->fHighestObject)
+
+#define player				(world->fPlayer)
+#define pinputs				(world->fPInputs)
+#define lastpinputs			(world->fLastPInputs)
+
+#define map					(world->fMap)
+#define ID2Lookup			(world->fID2Lookup)
+#define tilecode			(world->fTileCode)
+#define tileattr			(world->fTileAttr)
+
+#define game				(world->fGame)
+#define textbox				(world->fTextBox)
+#define onscreen_objects	(world->fOnscreenObjects)
+#define nOnscreenObjects	(world->fNOnscreenObjects)
+
+/*
+void c------------------------------() {}
+*/
+
+// these belong to map.h, but need the World to find the map
+
+// returns the tile at x,y, or 0 if x,y is outside the map
+inline int map_tile(int x, int y)
+{
+	if ((unsigned)x >= (unsigned)map.xsize || (unsigned)y >= (unsigned)map.ysize)
+		return 0;
+	
+	return map.tiles[(y * map.xsize) + x];
+}
+
+// returns the start of row y of the map, for walking along it.
+// there is no bounds checking; y must be inside the map.
+inline uint8_t *map_tilerow(int y)
+{
+	return &map.tiles[y * map.xsize];
+}
+
+// returns the collision attributes of the tile at x,y, or 0 if x,y is outside the map
+inline uint32_t map_attr(int x, int y)
+{
+	if ((unsigned)x >= (unsigned)map.xsize || (unsigned)y >= (unsigned)map.ysize)
+		return 0;
+	
+	return map.attr[(y * map.xsize) + x];
+}
+
+// returns true if the tile at x,y is set in the given bit-plane
+inline bool map_attrplane(int plane, int x, int y)
+{
+	if ((unsigned)x >= (unsigned)map.xsize || (unsigned)y >= (unsigned)map.ysize)
+		return false;
+	
+	return (map.planes[plane][(y * map.planepitch) + (x >> 5)] >> (x & 31)) & 1;
+}
+
+#endif